@@ -0,0 +1,135 @@
+//===--- Dusk.h - C interface for embedding dusk ------------------*- C -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+//
+// Stable C interface of libdusk, which lets a host program compile dusk source
+// at run time and call its functions directly.
+//
+// A module is compiled from a source buffer into native code of the host and
+// linked in memory. Functions of the module are then called through plain
+// function pointers, without any marshalling of arguments:
+//
+//   Dusk type     C type
+//   ---------     ------
+//   Int           DuskInt
+//   Int[N]        DuskInt *, the array is passed by reference
+//   Void          void
+//
+// e.g. `func add(a: Int, b: Int) -> Int` is called as
+// `DuskInt (*)(DuskInt, DuskInt)`. Functions of the host are made available
+// to the source as `extern` functions of the same name.
+//
+// Objects of a context must not be used from multiple threads at once,
+// separate contexts may be used concurrently.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_C_DUSK_H
+#define DUSK_C_DUSK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Version of the interface, incremented on every incompatible change.
+#define DUSK_C_API_VERSION 1
+
+/// Configuration shared by compiled modules.
+typedef struct DuskOpaqueContext *DuskContextRef;
+
+/// Compiled and linked module, which owns code of its functions.
+typedef struct DuskOpaqueModule *DuskModuleRef;
+
+/// Integer type of dusk.
+typedef int64_t DuskInt;
+
+/// Generic function pointer, which must be cast to the function's real type
+/// before it is called.
+typedef void (*DuskFunction)(void);
+
+/// Optimization level of the generated code.
+typedef enum {
+  DuskOptLevelO0,
+  DuskOptLevelO1,
+  DuskOptLevelO2,
+  DuskOptLevelO3,
+  DuskOptLevelOs
+} DuskOptLevel;
+
+/// Returns version of the interface implemented by the linked library.
+unsigned DuskGetAPIVersion(void);
+
+/// Creates a context generating unoptimized code for a generic host CPU,
+/// without a cache.
+DuskContextRef DuskContextCreate(void);
+
+/// Destroys context \c C. Modules compiled by the context stay valid.
+void DuskContextDispose(DuskContextRef C);
+
+/// Sets optimization level of modules compiled by \c C.
+void DuskSetOptLevel(DuskContextRef C, DuskOptLevel L);
+
+/// Sets the CPU the code is generated for, \c "native" selects the host CPU
+/// with all of its features.
+void DuskSetTargetCPU(DuskContextRef C, const char *CPU);
+
+/// \brief Enables caching of compiled modules in directory \c Path, limited
+/// to \c SizeLimit bytes, or to a default limit if \c SizeLimit is \c 0.
+///
+/// Modules are cached under a hash of their source and the configuration of
+/// \c C, therefore compiling the same source again, even by another process,
+/// only type checks and links the cached code. The directory may be shared
+/// with \c duskc.
+void DuskSetCache(DuskContextRef C, const char *Path, uint64_t SizeLimit);
+
+/// Adds a directory searched for interfaces of modules imported by compiled
+/// sources.
+void DuskAddImportPath(DuskContextRef C, const char *Path);
+
+/// \brief Makes host function \c Fn available as an \c extern function
+/// \c Name to modules compiled afterwards.
+///
+/// The signature of \c Fn must match the \c extern declaration.
+void DuskAddFunction(DuskContextRef C, const char *Name, DuskFunction Fn);
+
+/// \brief Compiles and links \c Size bytes of dusk source \c Source.
+///
+/// \c Name identifies the source in diagnostics, modules imported by
+/// the source are looked up relative to it.
+///
+/// \return The compiled module, or \c NULL if the source contains errors or
+///   refers to an undefined \c extern function. The reason is available by
+///   \c DuskGetErrorMessage.
+DuskModuleRef DuskCompileModule(DuskContextRef C, const char *Name,
+                                const char *Source, size_t Size);
+
+/// Returns diagnostics of the last failed compilation of context \c C, or
+/// an empty string.
+const char *DuskGetErrorMessage(DuskContextRef C);
+
+/// \brief Returns function \c Name defined by module \c M, or \c NULL if
+/// the module does not define such function.
+///
+/// The pointer is valid until the module is disposed.
+DuskFunction DuskGetFunction(DuskModuleRef M, const char *Name);
+
+/// Releases code of module \c M, no function of the module may be running.
+void DuskModuleDispose(DuskModuleRef M);
+
+/// Returns function \c Name of module \c M cast to function pointer type
+/// \c Type, e.g. \c DUSK_FUNCTION(M, "add", DuskInt (*)(DuskInt, DuskInt)).
+#define DUSK_FUNCTION(M, Name, Type) ((Type)DuskGetFunction((M), (Name)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DUSK_C_DUSK_H */
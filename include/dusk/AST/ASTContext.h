@@ -12,13 +12,18 @@
 
 #include "dusk/Basic/LLVM.h"
 #include "dusk/AST/ASTNode.h"
+#include "dusk/AST/Identifier.h"
 #include "dusk/AST/Pattern.h"
 #include "dusk/AST/Type.h"
 #include "dusk/AST/TypeRepr.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Allocator.h"
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <vector>
-#include <functional>
 
 namespace dusk {
 class Decl;
@@ -30,16 +35,60 @@ class Pattern;
 class Type;
 class VoidType;
 class IntType;
+class ArrayType;
+class InOutType;
+class FunctionType;
+class PatternType;
 class TypeRepr;
 
 /// This class owns all of the nodes, which are part of the AST.
 class ASTContext {
-  std::vector<std::function<void(void)>> Cleanups;
+  /// Arena holding all of the AST nodes, types, patterns and type
+  /// representations.
+  llvm::BumpPtrAllocator Allocator;
 
-  bool IsError = false;
+  /// Arena currently serving allocations of AST nodes.
+  llvm::BumpPtrAllocator *NodeAllocator;
+
+  /// Arenas of threads allocating AST nodes while concurrent access is
+  /// enabled, one per thread and per \c setConcurrent call.
+  std::vector<std::unique_ptr<llvm::BumpPtrAllocator>> ThreadAllocators;
+
+  /// Guards \c ThreadAllocators.
+  std::mutex ThreadAllocatorsLock;
+
+  /// Identifies the current period of concurrent access, so that threads
+  /// do not reuse arenas of an earlier one.
+  unsigned long ConcurrentGeneration = 0;
+
+  /// Number of allocations served by the context.
+  std::atomic<size_t> NumAllocations;
+
+  /// Table of all interned identifiers.
+  llvm::StringMap<char, llvm::BumpPtrAllocator &> IdentifierTable;
+
+  std::atomic<bool> IsError;
+
+  /// Guards the identifier table, uniqued types and the permanent arena
+  /// they are allocated in, while concurrent access is enabled.
+  std::recursive_mutex TablesLock;
+
+  bool IsConcurrent = false;
 
   ModuleDecl *RootModule;
 
+  /// Returns a lock on the identifier and type tables, which is only held
+  /// if concurrent access is enabled.
+  std::unique_lock<std::recursive_mutex> lockTables() {
+    if (IsConcurrent)
+      return std::unique_lock<std::recursive_mutex>(TablesLock);
+    return std::unique_lock<std::recursive_mutex>();
+  }
+
+  /// Returns arena of the calling thread for the current period of
+  /// concurrent access.
+  llvm::BumpPtrAllocator &getThreadAllocator();
+
 public:
   ASTContext();
   ~ASTContext();
@@ -56,24 +105,98 @@ public:
 
   /// Sets AST error state to \c true.
   ///
-  /// \node This action is ireversible.
+  /// \node This action is ireversible for a compilation.
   void setError() { IsError = true; }
 
-  /// Allocates a given number of bytes.
+  /// \brief Clears the error state.
   ///
-  /// All memory allocated by a \c ASTCotext instance will be freed during
-  /// the destruction of the instance.
-  void *Allocate(size_t Bytes);
+  /// Only for tools, which keep the context alive and parse and check parts
+  /// of the AST again after they were edited.
+  void clearError() { IsError = false; }
+
+  /// \brief Enables or disables concurrent access to the context.
+  ///
+  /// While enabled, memory allocation, identifier interning and type uniquing
+  /// may be called from multiple threads. Each thread allocates AST nodes
+  /// from an arena of its own, which lives as long as the context, only
+  /// identifiers and types are shared. It must not be toggled while other
+  /// threads access the context, nor while an arena is set by \c setArena.
+  void setConcurrent(bool C);
+
+  /// Allocates a given number of bytes aligned to \c Alignment.
+  ///
+  /// All memory allocated by a \c ASTCotext instance will be freed at once
+  /// during the destruction of the instance. Destructors of the allocated
+  /// objects are never run.
+  void *Allocate(size_t Bytes, unsigned Alignment = alignof(void *));
+
+  /// Allocates memory, which lives as long as the context regardless of
+  /// the current arena. Used for uniqued types.
+  void *AllocatePermanent(size_t Bytes, unsigned Alignment = alignof(void *));
+
+  /// \brief Serves allocations of AST nodes from \c Arena, or from the
+  /// context itself if \c Arena is \c nullptr.
+  ///
+  /// Allows nodes with a shorter lifetime than the context, e.g. body of
+  /// a single function, to be released at once by resetting the arena.
+  /// The client is responsible for not referencing any of the released
+  /// nodes afterwards. Types and identifiers are never allocated in
+  /// the arena.
+  void setArena(llvm::BumpPtrAllocator *Arena) {
+    NodeAllocator = Arena ? Arena : &Allocator;
+  }
+
+  /// Allocates uninitialized memory for \c NumElts objects of type \c T.
+  template <typename T> T *Allocate(size_t NumElts) {
+    return static_cast<T *>(Allocate(sizeof(T) * NumElts, alignof(T)));
+  }
+
+  /// Returns number of allocations served by the context.
+  size_t getNumAllocations() const { return NumAllocations; }
+
+  /// Returns total number of bytes the context has reserved from the system,
+  /// including the arena currently set by \c setArena.
+  size_t getTotalMemory() const;
+
+  /// Returns number of bytes actually handed out by the context, including
+  /// the arena currently set by \c setArena.
+  size_t getBytesAllocated() const;
+
+  /// Returns the uniqued identifier of given spelling.
+  ///
+  /// An empty string is mapped to an empty identifier.
+  Identifier getIdentifier(StringRef Str);
 
 private:
   // MARK: - Type singletons
   IntType *TheIntType;
   VoidType *TheVoidType;
 
+  // MARK: - Uniqued types
+  llvm::FoldingSet<ArrayType> ArrayTypes;
+  llvm::FoldingSet<InOutType> InOutTypes;
+  llvm::FoldingSet<FunctionType> FunctionTypes;
+  llvm::FoldingSet<PatternType> PatternTypes;
+
 public:
   IntType *getIntType() const;
   VoidType *getVoidType() const;
 
+  /// Returns the canonical array type of \c Size elements of \c BaseTy.
+  ArrayType *getArrayType(Type *BaseTy, size_t Size);
+
+  /// Returns the canonical inout type wrapping \c BaseTy.
+  InOutType *getInOutType(Type *BaseTy);
+
+  /// Returns the canonical function type of given arguments and return types.
+  FunctionType *getFunctionType(Type *ArgsTy, Type *RetTy);
+
+  /// Returns the canonical pattern type of given item types.
+  ///
+  /// \note Items are copied into the context, so the argument does not have
+  /// to outlive the call.
+  PatternType *getPatternType(ArrayRef<Type *> Items);
+
 private:
   ASTContext(const ASTContext &) = delete;
   ASTContext &operator=(const ASTContext &) = delete;
@@ -12,6 +12,7 @@
 
 #include "dusk/AST/ASTContext.h"
 #include "dusk/AST/ASTNode.h"
+#include "dusk/AST/Identifier.h"
 #include "dusk/AST/TypeRepr.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
@@ -25,6 +26,7 @@ class VarDecl;
 //class LetDecl;
 class ParamDecl;
 class FuncDecl;
+class ImportDecl;
 class Expr;
 class Stmt;
 class Pattern;
@@ -46,7 +48,7 @@ class Decl : public ASTNode {
   DeclKind Kind;
 
   /// Declaration name
-  StringRef Name;
+  Identifier Name;
 
   /// Location of declaration
   SMLoc NameLoc;
@@ -57,9 +59,12 @@ class Decl : public ASTNode {
   /// Type representation, if present
   TypeRepr *TyRepr;
 
+  /// \c true if the declaration was loaded from a module interface.
+  bool IsImported;
+
 public:
-  Decl(DeclKind K, StringRef N, SMLoc NL);
-  Decl(DeclKind K, StringRef N, SMLoc NL, TypeRepr *TyRepr);
+  Decl(DeclKind K, Identifier N, SMLoc NL);
+  Decl(DeclKind K, Identifier N, SMLoc NL, TypeRepr *TyRepr);
 
   /// Returns declaration kind.
   DeclKind getKind() const { return Kind; }
@@ -71,7 +76,13 @@ public:
   bool isValDecl() const;
 
   /// Returns declaration identifier as string.
-  StringRef getName() const { return Name; }
+  StringRef getName() const { return Name.str(); }
+
+  /// Returns uniqued declaration identifier.
+  Identifier getIdentifier() const { return Name; }
+
+  /// Returns location of the declaration name.
+  SMLoc getNameLoc() const { return NameLoc; }
 
   /// Returns declaration type
   Type *getType() const { return Ty; }
@@ -86,6 +97,12 @@ public:
   /// Returns type representation.
   TypeRepr *getTypeRepr() const { return TyRepr; }
 
+  /// Returns \c true if the declaration was loaded from a module interface,
+  /// i.e. it is defined by another module and has no source location.
+  bool isImported() const { return IsImported; }
+
+  void setImported(bool I = true) { IsImported = I; }
+
   SMRange getSourceRange() const override;
 
   bool walk(ASTWalker &Walker);
@@ -119,8 +136,8 @@ private:
   Specifier Spec;
 
 public:
-  ValDecl(DeclKind K, Specifier S, StringRef N, SMLoc NL, Expr *V);
-  ValDecl(DeclKind K, Specifier S, StringRef N, SMLoc NL, Expr *V,
+  ValDecl(DeclKind K, Specifier S, Identifier N, SMLoc NL, Expr *V);
+  ValDecl(DeclKind K, Specifier S, Identifier N, SMLoc NL, Expr *V,
           TypeRepr *TR);
 
   SMLoc getValLoc() const { return ValLoc; }
@@ -142,8 +159,8 @@ class VarDecl : public ValDecl {
   SMLoc VarLoc;
 
 public:
-  VarDecl(Specifier S, StringRef N, SMLoc NL, SMLoc VarL, Expr *V);
-  VarDecl(Specifier S, StringRef N, SMLoc NL, SMLoc VarL, Expr *V,
+  VarDecl(Specifier S, Identifier N, SMLoc NL, SMLoc VarL, Expr *V);
+  VarDecl(Specifier S, Identifier N, SMLoc NL, SMLoc VarL, Expr *V,
           TypeRepr *TR);
 
   SMLoc getVarLoc() const { return VarLoc; }
@@ -153,8 +170,8 @@ public:
 /// Declaration of function parameter
 class ParamDecl : public ValDecl {
 public:
-  ParamDecl(Specifier S, StringRef N, SMLoc NL);
-  ParamDecl(Specifier S, StringRef N, SMLoc NL, TypeRepr *TR);
+  ParamDecl(Specifier S, Identifier N, SMLoc NL);
+  ParamDecl(Specifier S, Identifier N, SMLoc NL, TypeRepr *TR);
 };
 
 /// Function declaration
@@ -166,8 +183,8 @@ class FuncDecl : public Decl {
   VarPattern *Params;
 
 public:
-  FuncDecl(StringRef N, SMLoc NL, SMLoc FuncL, VarPattern *A);
-  FuncDecl(StringRef N, SMLoc NL, SMLoc FuncL, VarPattern *A, TypeRepr *TR);
+  FuncDecl(Identifier N, SMLoc NL, SMLoc FuncL, VarPattern *A);
+  FuncDecl(Identifier N, SMLoc NL, SMLoc FuncL, VarPattern *A, TypeRepr *TR);
 
   SMLoc getFuncLoc() const { return FuncLoc; }
   VarPattern *getArgs() const { return Params; }
@@ -175,6 +192,21 @@ public:
   virtual SMRange getSourceRange() const override;
 };
 
+/// Import of a precompiled module
+///
+/// Makes public declarations of the module visible in the importing module.
+class ImportDecl : public Decl {
+  /// Location of \c import keyword
+  SMLoc ImportLoc;
+
+public:
+  ImportDecl(Identifier N, SMLoc NL, SMLoc ImportL);
+
+  SMLoc getImportLoc() const { return ImportLoc; }
+
+  virtual SMRange getSourceRange() const override;
+};
+
 /// A signle module
 ///
 /// Represents a result of parsing a file.
@@ -182,7 +214,7 @@ class ModuleDecl : public Decl {
   std::vector<ASTNode *> Contents;
 
 public:
-  ModuleDecl(StringRef N, std::vector<ASTNode *> &&C);
+  ModuleDecl(Identifier N, std::vector<ASTNode *> &&C);
 
   ArrayRef<ASTNode *> getContents() const { return Contents; }
   MutableArrayRef<ASTNode *> getContents() { return Contents; }
@@ -11,6 +11,7 @@
 #define DUSK_DIAGNOSTICS_H
 
 #include "dusk/AST/DiagnosticsParse.h"
+#include "dusk/Basic/SourceManager.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/Optional.h"
@@ -40,6 +41,22 @@ public:
   virtual void consume(SMDiagnostic &Diagnostic) = 0;
 };
 
+/// \brief Consumer, which stores diagnostics to be emitted later.
+///
+/// Allows diagnostics produced out of order, e.g. by multiple threads, to be
+/// reported in a deterministic order.
+class DiagnosticBuffer : public DiagnosticConsumer {
+  std::vector<SMDiagnostic> Diags;
+
+public:
+  void consume(SMDiagnostic &Diagnostic) override {
+    Diags.push_back(Diagnostic);
+  }
+
+  /// Forwards all buffered diagnostics to \c Engine and clears the buffer.
+  void flush(DiagnosticEngine &Engine);
+};
+
 /// Represents a single diagnostic.
 ///
 /// This is a container object holding all necessary information to create
@@ -125,7 +142,7 @@ public:
 /// the diagnostic consumers which consume standart \c SMDiagnostic
 /// objects.
 class DiagnosticEngine {
-  llvm::SourceMgr &SourceManager;
+  dusk::SourceManager &SourceManager;
 
   /// Consumers of diagnostics
   std::vector<DiagnosticConsumer *> Consumers;
@@ -137,7 +154,8 @@ class DiagnosticEngine {
   friend class DiagnosticRef;
 
 public:
-  DiagnosticEngine(llvm::SourceMgr &SM) : SourceManager(SM), ActiveDiag() {}
+  DiagnosticEngine(dusk::SourceManager &SM)
+      : SourceManager(SM), ActiveDiag() {}
 
   /// Adds another \c DiagnosticConsumer.
   void addConsumer(DiagnosticConsumer *C) { Consumers.push_back(C); }
@@ -150,6 +168,15 @@ public:
     return Ret;
   }
 
+  /// Returns source manager providing context of diagnostics.
+  dusk::SourceManager &getSourceManager() const { return SourceManager; }
+
+  /// Passes an already formed diagnostic to all consumers.
+  void forward(SMDiagnostic &Diagnostic) {
+    for (auto C : Consumers)
+      C->consume(Diagnostic);
+  }
+
   /// \brief Create and emit a single diagnostic.
   ///
   /// \param SourceLoc Location to which the diagnostic referes in the source
@@ -11,6 +11,7 @@
 #define DUSK_EXPR_H
 
 #include "dusk/AST/ASTNode.h"
+#include "dusk/AST/Identifier.h"
 #include "dusk/AST/Pattern.h"
 #include "dusk/Parse/Token.h"
 #include "llvm/Support/SMLoc.h"
@@ -26,6 +27,8 @@ class PrefixExpr;
 class AssignExpr;
 class CallExpr;
 class SubscriptExpr;
+class Decl;
+class FuncDecl;
 class BlockStmt;
 class ExprPattern;
 class Stmt;
@@ -97,15 +100,22 @@ public:
 };
 
 class IdentifierExpr : public Expr {
-  StringRef Name;
+  Identifier Name;
   SMLoc NameLoc;
 
+  /// Declaration the identifier refers to, resolved during type checking.
+  Decl *D;
+
 public:
-  IdentifierExpr(StringRef N, SMLoc L);
+  IdentifierExpr(Identifier N, SMLoc L);
 
-  StringRef getName() const { return Name; }
+  StringRef getName() const { return Name.str(); }
+  Identifier getIdentifier() const { return Name; }
   SMLoc getNameLoc() const { return NameLoc; }
 
+  Decl *getDecl() const { return D; }
+  void setDecl(Decl *Ref) { D = Ref; }
+
   SMRange getSourceRange() const override;
 };
 
@@ -221,6 +231,9 @@ class CallExpr : public Expr {
   /// Function arguments
   Pattern *Args;
 
+  /// Called function, resolved during type checking.
+  FuncDecl *CalleeDecl;
+
 public:
   CallExpr(Expr *C, Pattern *A);
 
@@ -228,6 +241,9 @@ public:
   Pattern *getArgs() { return Args; }
   void setCallee(Expr *C) { Callee = C; }
 
+  FuncDecl *getCalleeDecl() const { return CalleeDecl; }
+  void setCalleeDecl(FuncDecl *D) { CalleeDecl = D; }
+
   SMRange getSourceRange() const override;
 };
 
@@ -0,0 +1,84 @@
+//===--- Identifier.h - Uniqued identifier ----------------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_IDENTIFIER_H
+#define DUSK_IDENTIFIER_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ADT/DenseMapInfo.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace dusk {
+class ASTContext;
+
+/// A uniqued name.
+///
+/// Identifiers are interned by the \c ASTContext, therefore two identifiers
+/// with the same spelling are the same object and can be compared and hashed
+/// by a pointer.
+class Identifier {
+  friend class ASTContext;
+
+public:
+  using EntryTy = llvm::StringMapEntry<char>;
+
+private:
+  const EntryTy *Entry;
+
+  explicit Identifier(const EntryTy *E) : Entry(E) {}
+
+public:
+  /// Creates an empty identifier.
+  Identifier() : Entry(nullptr) {}
+
+  /// Returns \c true if the identifier does not hold any name.
+  bool empty() const { return Entry == nullptr; }
+
+  /// Returns spelling of the identifier.
+  StringRef str() const { return Entry ? Entry->getKey() : StringRef(); }
+
+  /// Returns length of the identifier.
+  size_t size() const { return Entry ? Entry->getKeyLength() : 0; }
+
+  operator StringRef() const { return str(); }
+
+  bool operator==(Identifier RHS) const { return Entry == RHS.Entry; }
+  bool operator!=(Identifier RHS) const { return Entry != RHS.Entry; }
+
+  const void *getAsOpaquePointer() const { return Entry; }
+  static Identifier getFromOpaquePointer(const void *P) {
+    return Identifier(static_cast<const EntryTy *>(P));
+  }
+};
+
+} // namespace dusk
+
+namespace llvm {
+
+template <> struct DenseMapInfo<dusk::Identifier> {
+  static dusk::Identifier getEmptyKey() {
+    return dusk::Identifier::getFromOpaquePointer(
+        DenseMapInfo<const void *>::getEmptyKey());
+  }
+  static dusk::Identifier getTombstoneKey() {
+    return dusk::Identifier::getFromOpaquePointer(
+        DenseMapInfo<const void *>::getTombstoneKey());
+  }
+  static unsigned getHashValue(dusk::Identifier Val) {
+    return DenseMapInfo<const void *>::getHashValue(Val.getAsOpaquePointer());
+  }
+  static bool isEqual(dusk::Identifier LHS, dusk::Identifier RHS) {
+    return LHS == RHS;
+  }
+};
+
+} // namespace llvm
+
+#endif /* DUSK_IDENTIFIER_H */
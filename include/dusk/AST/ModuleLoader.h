@@ -0,0 +1,35 @@
+//===--- ModuleLoader.h - Loading of imported modules -----------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_MODULE_LOADER_H
+#define DUSK_MODULE_LOADER_H
+
+namespace dusk {
+class DiagnosticEngine;
+class ExternalNameSource;
+class ImportDecl;
+
+/// Interface of loaders of modules imported by the compiled module.
+class ModuleLoader {
+public:
+  virtual ~ModuleLoader() = default;
+
+  /// \brief Loads the module imported by \c D.
+  ///
+  /// Loading a module more than once returns the same source.
+  ///
+  /// \return Source of the declarations of the module, or \c nullptr if
+  ///   the module could not be loaded. Errors are reported into \c Diag.
+  virtual ExternalNameSource *loadModule(ImportDecl *D,
+                                         DiagnosticEngine &Diag) = 0;
+};
+
+} // namespace dusk
+
+#endif /* DUSK_MODULE_LOADER_H */
@@ -11,76 +11,110 @@
 #define DUSK_CONTEXT_H
 
 #include "dusk/Basic/LLVM.h"
-#include "llvm/ADT/StringRef.h"
-#include "llvm/ADT/StringMap.h"
-#include <memory>
+#include "dusk/AST/Identifier.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include <utility>
 
 namespace dusk {
 class Decl;
 
-/// Represents current context declaration level.
+/// \brief Source of global declarations, which are not part of the module
+/// being compiled, e.g. declarations of an imported module.
 ///
-/// Constructors of this struct are private, instances of \c ContextVals class
-/// can be made by only \c Context instances.
-struct LookupImpl {
-  /// Holds pointer to the parent context.
-  std::unique_ptr<LookupImpl> Parent;
+/// Declarations are looked up by name only when they are referenced, so that
+/// a source may materialize them lazily. Lookups may be called concurrently.
+class ExternalNameSource {
+public:
+  virtual ~ExternalNameSource() = default;
 
-  /// Holds constant declarations of current scope.
-  llvm::StringMap<Decl *> Consts;
+  /// Returns a function named \c Name, or \c nullptr if there is none.
+  virtual Decl *lookupFunc(Identifier Name) = 0;
 
-  /// Holds variable declarations of current scope.
-  llvm::StringMap<Decl *> Vars;
+  /// Returns a global constant named \c Name, or \c nullptr if there is
+  /// none.
+  virtual Decl *lookupVal(Identifier Name) = 0;
+};
 
-public:
-  /// Returns \c true if there is a reachable value delcaration for given name
-  /// the scope, \c false otherwise.
-  bool contains(StringRef Str) const { return get(Str) != nullptr; }
+/// Represents a current declaration lookup context.
+///
+/// Holds declaration of variables, constatnts and functions.
+///
+/// All visible values live in a single flat table mapping an identifier to
+/// its innermost declaration. When a declaration shadows another one, the
+/// previous binding is recorded in an undo log, which is replayed when
+/// the declaring scope is popped. Pushing, popping and lookups are therefore
+/// independent of the scope nesting depth.
+///
+/// A lookup context can be layered over the global scope of another one,
+/// which is then only read. This allows multiple threads to resolve names
+/// within their own scopes, while sharing the global declarations.
+class NameLookup {
+  /// Innermost visible declaration of a name.
+  struct Binding {
+    Decl *D = nullptr;
 
-  /// Returns \c true if a declaration for given name was performed in current
-  /// scope.
-  bool isDeclared(StringRef Str) const;
+    /// Depth of the scope the declaration was made in.
+    unsigned Depth = 0;
 
-  /// Returns variable for given name, if found, \c nullptr otherwise.
-  Decl *getVar(StringRef Str) const;
+    /// \c true if declared via \c declareLet.
+    bool IsConst = false;
 
-  /// Returns variable for given name, if found, \c nullptr otherwise.
-  Decl *get(StringRef Str) const;
+    /// Order of the declaration among global declarations.
+    unsigned Index = 0;
+  };
 
-  /// Pushes a new context layer to the stack and returns a pointer to the top
-  /// of the stack.
-  LookupImpl *push();
+  llvm::DenseMap<Identifier, Decl *> Funcs;
+  llvm::DenseMap<Identifier, Binding> Vals;
 
-  /// Pop a top context layer from the stack and returns a pointer to the top
-  /// of the stack.
+  /// Bindings overridden by declarations of the currently open scopes.
   ///
-  /// \note This method calls \c delete \c this on itself, therefore noone
-  /// should access this object after calling this method.
-  LookupImpl *pop();
+  /// An entry with an empty binding denotes, that the name was not visible
+  /// before the declaration.
+  SmallVector<std::pair<Identifier, Binding>, 64> UndoLog;
 
-private:
-  friend class NameLookup;
-  LookupImpl();
-  LookupImpl(LookupImpl *P);
+  /// Size of the undo log at the time each of the open scopes was pushed.
+  SmallVector<unsigned, 16> Scopes;
 
-  LookupImpl(const LookupImpl &other) = delete;
-  LookupImpl &operator=(const LookupImpl &other) = delete;
-};
+  /// Number of values declared in the global scope.
+  unsigned NumGlobals = 0;
 
-/// Represents a current declaration lookup context.
-///
-/// Holds declaration of variables, constatnts and functions.
-class NameLookup {
-  llvm::StringMap<Decl *> Funcs;
-  LookupImpl *Impl;
-  unsigned Depth = 0;
+  /// Context whose global scope encloses this one, if any.
+  const NameLookup *Outer = nullptr;
+
+  /// Number of global values of the \c Outer context visible in this one.
+  unsigned NumOuterVisible = 0;
+
+  /// Sources of names not declared in the module itself, searched in order
+  /// after the global scope.
+  SmallVector<ExternalNameSource *, 4> ExternalSources;
 
 public:
-  NameLookup();
-  ~NameLookup();
+  /// Creates an empty lookup context.
+  NameLookup() = default;
+
+  /// \brief Creates a lookup context enclosed by the global scope of
+  /// \c Outer.
+  ///
+  /// All functions of the \c Outer are visible, but only first
+  /// \c NumVisible global values, i.e. the ones declared before the point
+  /// the new context corresponds to. The \c Outer must not be modified
+  /// during the lifetime of the new context.
+  NameLookup(const NameLookup &Outer, unsigned NumVisible);
+
+  /// Returns number of values declared in the global scope.
+  unsigned getNumGlobals() const { return NumGlobals; }
+
+  /// \brief Adds a source of global declarations, e.g. an imported module.
+  ///
+  /// Declarations of the module itself take precedence over the external
+  /// ones. The source must outlive the context.
+  void addExternalSource(ExternalNameSource *S) {
+    ExternalSources.push_back(S);
+  }
 
   /// Returns current depth of the context.
-  unsigned getDepth() const { return Depth; }
+  unsigned getDepth() const { return Scopes.size(); }
 
   /// \brief Declares a variable in current scope.
   ///
@@ -106,28 +140,41 @@ public:
   /// and constant.
   ///
   /// If no value is found, \c nullptr is returned.
-  Decl *getVal(StringRef Str) const;
+  Decl *getVal(Identifier Str) const;
 
-  /// Returns a value for given identifier. Can be both, reference variable
-  /// and constant.
+  /// Returns a variable for given identifier.
   ///
-  /// If no value is found, \c nullptr is returned.
-  Decl *getVar(StringRef Str) const;
+  /// If no value is found or the innermost value declaration is a constant,
+  /// \c nullptr is returned.
+  Decl *getVar(Identifier Str) const;
 
   /// Returns function type for given identifier.
   ///
   /// If no type is found, \c nullptr is returned.
-  Decl *getFunc(StringRef Str);
+  Decl *getFunc(Identifier Str) const;
 
   /// Returns \c true, if in the current scope if a declaration associated with
   /// given identifier.
-  bool contains(StringRef Str) const;
+  bool contains(Identifier Str) const;
 
   /// Pushes a new scope to the internal stack.
   void push();
 
   /// Pops current scope from the internal stack.
   void pop();
+
+private:
+  bool declare(Decl *D, bool IsConst);
+
+  /// Returns the innermost visible binding of \c Name or \c nullptr.
+  const Binding *lookup(Identifier Name) const;
+
+  /// Returns a constant \c Name of an external source or \c nullptr.
+  Decl *lookupExternalVal(Identifier Name) const;
+
+  /// Returns a function \c Name of an external source of this context or
+  /// \c nullptr.
+  Decl *lookupExternalFunc(Identifier Name) const;
 };
 
 } // namespace dusk
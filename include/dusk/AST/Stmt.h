@@ -173,11 +173,28 @@ class FuncStmt : public Stmt {
   Decl *Prototype;
   Stmt *Body;
 
+  /// Range of a body, which is not parsed yet.
+  SMRange DelayedBody;
+
 public:
   FuncStmt(Decl *FP, Stmt *B);
 
+  /// Creates a function, whose body in range \c BodyRange is parsed later.
+  FuncStmt(Decl *FP, SMRange BodyRange);
+
   Decl *getPrototype() { return Prototype; }
+
+  /// Returns body of the function, \c nullptr if it's not parsed yet or
+  /// it has been released.
   Stmt *getBody() { return Body; }
+  void setBody(Stmt *B) { Body = B; }
+
+  /// Returns \c true if the body is parsed separately from the prototype.
+  bool hasDelayedBody() const { return DelayedBody.isValid(); }
+
+  /// Returns locations of the opening and closing brace of a body parsed
+  /// separately from the prototype.
+  SMRange getDelayedBodyRange() const { return DelayedBody; }
 
   virtual SMRange getSourceRange() const override;
 };
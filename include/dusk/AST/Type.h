@@ -14,6 +14,7 @@
 #include "dusk/Parse/Token.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/FoldingSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/SMLoc.h"
 
@@ -33,19 +34,27 @@ enum struct TypeKind {
 #include "dusk/AST/TypeNodes.def"
 };
 
+/// Base class of all types.
+///
+/// Types are uniqued by the \c ASTContext, which makes every type instance
+/// canonical. Two types are therefore equal if and only if they are
+/// the same object.
 class Type {
   /// Exact kind of the type.
   TypeKind Kind;
 
-public:
+protected:
   Type(TypeKind K);
 
+public:
   TypeKind getKind() const { return Kind; }
   
   virtual bool isRefType() const { return false; }
   virtual bool isValueType() const { return false; }
   virtual bool isVoidType() const { return false; }
-  virtual bool isClassOf(const Type *T) const { return this == T; }
+
+  /// Returns \c true if the \c T denotes the same type, \c false otherwise.
+  bool isClassOf(const Type *T) const { return this == T; }
 
 #define TYPE(CLASS, PARENT) CLASS##Type *get##CLASS##Type();
 #include "dusk/AST/TypeNodes.def"
@@ -61,115 +70,94 @@ public:
 };
 
 class ValueType : public Type {
-public:
+protected:
   ValueType(TypeKind K);
+
+public:
   virtual bool isValueType() const override { return true; }
 };
 
 /// Void type encapsulation.
 class VoidType : public Type {
-public:
+  friend class ASTContext;
   VoidType();
+
+public:
   bool isVoidType() const override { return true; }
-  bool isClassOf(const Type *T) const override {
-    if (Type::isClassOf(T))
-      return true;
-    return T->isVoidType();
-  }
 };
 
 /// Integer type encapsulation.
 class IntType : public ValueType {
-public:
+  friend class ASTContext;
   IntType();
-  bool isClassOf(const Type *T) const override {
-    if (Type::isClassOf(T))
-      return true;
-    return T->getKind() == TypeKind::Int;
-  }
 };
 
 /// Representing array type
-class ArrayType : public ValueType {
+class ArrayType : public ValueType, public llvm::FoldingSetNode {
   Type *BaseTy;
   size_t Size;
 
-public:
+  friend class ASTContext;
   ArrayType(Type *Ty, size_t S);
 
+public:
   Type *getBaseType() const { return BaseTy; }
   size_t getSize() const { return Size; }
 
   bool isRefType() const override { return true; }
-  bool isClassOf(const Type *T) const override {
-    if (Type::isClassOf(T))
-      return true;
-    if (auto Ty = dynamic_cast<const ArrayType *>(T))
-      return isClassOf(Ty);
-    return false;
-  }
 
-  bool isClassOf(const ArrayType *T) const;
+  void Profile(llvm::FoldingSetNodeID &ID) const {
+    Profile(ID, BaseTy, Size);
+  }
+  static void Profile(llvm::FoldingSetNodeID &ID, Type *BaseTy, size_t Size);
 };
 
 /// Representation of an inout type
-class InOutType : public ValueType {
+class InOutType : public ValueType, public llvm::FoldingSetNode {
   Type *BaseTy;
-  
-public:
+
+  friend class ASTContext;
   InOutType(Type *Ty);
-  
+
+public:
   Type *getBaseType() const { return BaseTy; }
   
   bool isRefType() const override { return true; }
-  bool isClassOf(const Type *T) const override {
-    if (Type::isClassOf(T))
-      return true;
-    if (auto Ty = dynamic_cast<const InOutType *>(T))
-      return isClassOf(Ty);
-    return false;
-  }
-  
-  bool isClassOf(const InOutType *Ty) const;
+
+  void Profile(llvm::FoldingSetNodeID &ID) const { Profile(ID, BaseTy); }
+  static void Profile(llvm::FoldingSetNodeID &ID, Type *BaseTy);
 };
   
 /// Representing function type
-class FunctionType : public Type {
+class FunctionType : public Type, public llvm::FoldingSetNode {
   Type *ArgsTy;
   Type *RetTy;
 
-public:
+  friend class ASTContext;
   FunctionType(Type *AT, Type *RT);
+
+public:
   Type *getArgsType() const { return ArgsTy; }
   Type *getRetType() const { return RetTy; }
 
-  bool isClassOf(const Type *T) const override {
-    if (Type::isClassOf(T))
-      return true;
-    if (auto Ty = dynamic_cast<const FunctionType *>(T))
-      return isClassOf(Ty);
-    return false;
+  void Profile(llvm::FoldingSetNodeID &ID) const {
+    Profile(ID, ArgsTy, RetTy);
   }
-
-  bool isClassOf(const FunctionType *T) const;
+  static void Profile(llvm::FoldingSetNodeID &ID, Type *ArgsTy, Type *RetTy);
 };
 
-class PatternType : public Type {
-  SmallVector<Type *, 128> Items;
+class PatternType : public Type, public llvm::FoldingSetNode {
+  /// Item types, allocated in the owning \c ASTContext.
+  ArrayRef<Type *> Items;
 
-public:
-  PatternType(SmallVector<Type *, 128> &&I);
+  friend class ASTContext;
+  PatternType(ArrayRef<Type *> I);
 
+public:
   ArrayRef<Type *> getItems() const { return Items; }
 
-  bool isClassOf(const Type *T) const override {
-    if (Type::isClassOf(T))
-      return true;
-    if (auto Ty = dynamic_cast<const PatternType *>(T))
-      return isClassOf(Ty);
-    return false;
-  }
-  bool isClassOf(const PatternType *T) const;
+  void Profile(llvm::FoldingSetNodeID &ID) const { Profile(ID, Items); }
+  static void Profile(llvm::FoldingSetNodeID &ID, ArrayRef<Type *> Items);
 };
 
 } // namespace dusk
@@ -0,0 +1,91 @@
+//===--- BoundedQueue.h - Blocking queue of limited size --------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_BOUNDED_QUEUE_H
+#define DUSK_BOUNDED_QUEUE_H
+
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace dusk {
+
+/// \brief A thread-safe FIFO queue holding at most a fixed number of items.
+///
+/// Used to connect stages of a pipeline running on separate threads.
+/// A producer blocks while the queue is full, therefore a fast stage never
+/// runs arbitrarily far ahead of a slow one. Once the producers are done,
+/// the queue is closed and consumers drain the remaining items.
+template <typename T> class BoundedQueue {
+  std::deque<T> Items;
+  size_t Capacity;
+  bool IsClosed = false;
+
+  std::mutex Lock;
+  std::condition_variable NotFull;
+  std::condition_variable NotEmpty;
+
+  BoundedQueue(const BoundedQueue &other) = delete;
+  void operator=(const BoundedQueue &other) = delete;
+
+public:
+  explicit BoundedQueue(size_t Capacity) : Capacity(Capacity) {
+    assert(Capacity > 0 && "Queue must be able to hold an item.");
+  }
+
+  /// \brief Appends \c Item to the queue, blocks while the queue is full.
+  ///
+  /// \return \c false if the queue has been closed and the item was dropped.
+  bool push(T Item) {
+    std::unique_lock<std::mutex> Guard(Lock);
+    NotFull.wait(Guard, [this] { return IsClosed || Items.size() < Capacity; });
+    if (IsClosed)
+      return false;
+    Items.push_back(std::move(Item));
+    NotEmpty.notify_one();
+    return true;
+  }
+
+  /// \brief Removes the first item of the queue into \c Item, blocks while
+  /// the queue is empty.
+  ///
+  /// \return \c false once the queue is closed and all items were consumed.
+  bool pop(T &Item) {
+    std::unique_lock<std::mutex> Guard(Lock);
+    NotEmpty.wait(Guard, [this] { return IsClosed || !Items.empty(); });
+    if (Items.empty())
+      return false;
+    Item = std::move(Items.front());
+    Items.pop_front();
+    NotFull.notify_one();
+    return true;
+  }
+
+  /// Returns \c true if there is no item immediately available.
+  bool empty() {
+    std::lock_guard<std::mutex> Guard(Lock);
+    return Items.empty();
+  }
+
+  /// Closes the queue. Pending items can still be consumed, but no new items
+  /// are accepted and blocked clients are woken up.
+  void close() {
+    std::lock_guard<std::mutex> Guard(Lock);
+    IsClosed = true;
+    NotFull.notify_all();
+    NotEmpty.notify_all();
+  }
+};
+
+} // namespace dusk
+
+#endif /* DUSK_BOUNDED_QUEUE_H */
@@ -1,4 +1,4 @@
-//===--- SourceManager.h - Convenience functions ----------------*- C++ -*-===//
+//===--- SourceManager.h - Source buffer manager ----------------*- C++ -*-===//
 //
 //                                 dusk-lang
 // This source file is part of a dusk-lang project, which is a semestral
@@ -13,17 +13,76 @@
 #include "dusk/Basic/LLVM.h"
 #include "llvm/Support/SourceMgr.h"
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
 
 namespace dusk {
 
-/// \brief Returns an ID of the buffer containing provided \c Loc.
+/// \brief Source manager with fast location lookups.
 ///
-/// \param SM Source manager providing buffers for context.
+/// Extends \c llvm::SourceMgr with an index of buffer ranges sorted by their
+/// start address and a per-buffer table of line offsets. Both are built
+/// lazily on first use, after which mapping a location to its buffer, line
+/// and column is logarithmic rather than linear in the size of the input.
 ///
-/// \param Loc Location refering to a buffer.
-///
-/// \return ID of buffer containing provided location.
-unsigned getBufferForLoc(const llvm::SourceMgr &SM, SMLoc Loc);
+/// \note Queries are safe to call from multiple threads, as long as no
+///  buffers are being added concurrently.
+class SourceManager : public llvm::SourceMgr {
+  struct BufferRange {
+    const char *Start;
+    const char *End;
+    unsigned ID;
+  };
+
+  /// Ranges of all indexed buffers sorted by their start.
+  mutable std::vector<BufferRange> BufferIndex;
+
+  /// Offsets of line starts, indexed by buffer ID - 1.
+  mutable std::vector<std::unique_ptr<std::vector<uint32_t>>> LineTables;
+
+  mutable std::mutex CacheLock;
+
+public:
+  SourceManager() = default;
+
+  /// \brief Returns an ID of the buffer containing provided \c Loc.
+  ///
+  /// \param Loc Location refering to a buffer.
+  ///
+  /// \return ID of buffer containing provided location.
+  unsigned getBufferForLoc(SMLoc Loc) const;
+
+  using llvm::SourceMgr::getLineAndColumn;
+
+  /// \brief Returns 1-based line and column numbers of the \c Loc.
+  ///
+  /// \param BufferID ID of the buffer containing \c Loc, looked up if \c 0.
+  std::pair<unsigned, unsigned> getLineAndColumn(SMLoc Loc,
+                                                 unsigned BufferID = 0) const;
+
+  /// Retrieve a location for the start of the line referenced by the \c Loc.
+  SMLoc getLocForStartOfLine(SMLoc Loc) const;
+
+  /// Retrieve a location for end of line (start of next line) referenced
+  /// by the \c Loc.
+  SMLoc getLocForEndOfLine(SMLoc Loc) const;
+
+  /// Retrive a line in the source code referenced by the \c Loc including
+  /// its line terminator.
+  StringRef getLineForLoc(SMLoc Loc) const;
+
+private:
+  /// Returns line table of the buffer \c BufferID. \c CacheLock must be held.
+  const std::vector<uint32_t> &getLineTable(unsigned BufferID) const;
+
+  /// Returns index of line containing \c Loc within \c BufferID together with
+  /// offset of the line start.
+  std::pair<unsigned, const char *> getLineStart(unsigned BufferID,
+                                                 SMLoc Loc) const;
+};
 
 } // namespace dusk
 
@@ -0,0 +1,95 @@
+//===--- TimeTrace.h - Time trace of the compiler ---------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file declares recording of time spent in nested scopes of
+// the compiler, used by -ftime-trace and -ftime-report.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_TIME_TRACE_H
+#define DUSK_TIME_TRACE_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+
+namespace dusk {
+
+namespace detail {
+struct TimeTracer;
+
+/// Recorder of the process, \c nullptr if no time trace is recorded.
+extern TimeTracer *TimeTracerInstance;
+} // namespace detail
+
+/// \brief Starts recording time trace of the process.
+///
+/// Scopes shorter than \c Granularity microseconds are left out of the trace
+/// to keep it small, they are still accounted in the report.
+void timeTraceInitialize(unsigned Granularity = 500);
+
+/// Stops recording and releases the recorded trace. Must not be called while
+/// any scope is open.
+void timeTraceCleanup();
+
+/// Returns \c true, if time trace is being recorded.
+inline bool isTimeTraceEnabled() {
+  return detail::TimeTracerInstance != nullptr;
+}
+
+/// \brief Opens a scope \c Name on the calling thread.
+///
+/// \c Detail further describes the scope, e.g. by name of the function
+/// the scope works on. Scopes are closed by \c timeTraceEnd in reverse order.
+/// Does nothing unless time trace is being recorded.
+void timeTraceBegin(StringRef Name, StringRef Detail = "");
+
+/// Closes the innermost open scope of the calling thread.
+void timeTraceEnd();
+
+/// \brief Writes the recorded trace into \c OS.
+///
+/// The trace is a JSON in Chrome trace event format, which can be viewed
+/// by \c chrome://tracing or https://ui.perfetto.dev.
+void timeTraceWrite(raw_ostream &OS);
+
+/// \brief Prints a table of total time spent in scopes of each name into
+/// \c OS.
+///
+/// Nested scopes of the same name, e.g. of recursive calls, are counted only
+/// once. Scopes running on multiple threads may add up to more than the wall
+/// time of the process.
+void timeTracePrintReport(raw_ostream &OS);
+
+/// \brief Opens a time trace scope for lifetime of the object.
+///
+/// \code
+///   TimeTraceScope Trace("IRGenFunction", Fn->getName());
+/// \endcode
+class TimeTraceScope {
+  bool IsOpen;
+
+public:
+  explicit TimeTraceScope(StringRef Name, StringRef Detail = "")
+      : IsOpen(isTimeTraceEnabled()) {
+    if (IsOpen)
+      timeTraceBegin(Name, Detail);
+  }
+
+  ~TimeTraceScope() {
+    if (IsOpen)
+      timeTraceEnd();
+  }
+
+  TimeTraceScope(const TimeTraceScope &other) = delete;
+  TimeTraceScope &operator=(const TimeTraceScope &other) = delete;
+};
+
+} // namespace dusk
+
+#endif /* DUSK_TIME_TRACE_H */
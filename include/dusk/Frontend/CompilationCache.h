@@ -0,0 +1,132 @@
+//===--- CompilationCache.h - Cache of compiled object files ----*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_COMPILATION_CACHE_H
+#define DUSK_COMPILATION_CACHE_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dusk {
+class CompilerInvocation;
+class Decl;
+class FuncStmt;
+class ModuleDecl;
+
+/// \brief On-disk content-addressed cache of object files.
+///
+/// An entry is keyed by a hash of everything the object file depends on,
+/// that is the source buffer, versions of the compiler and LLVM and all
+/// code generation options of the invocation.
+///
+/// Entries are written into a temporary file first and renamed into place,
+/// therefore multiple compilers may share a single cache directory. The size
+/// of the cache is bounded, least recently used entries are evicted first.
+class CompilationCache {
+public:
+  /// Cache statistics of the whole process.
+  struct Statistics {
+    std::atomic<unsigned> Hits{0};
+    std::atomic<unsigned> Misses{0};
+    std::atomic<unsigned> Stores{0};
+  };
+
+private:
+  std::string Path;
+  uint64_t MaxSize;
+
+public:
+  /// Default size limit of the cache in bytes.
+  static constexpr uint64_t DefaultMaxSize = 512 * 1024 * 1024;
+
+  /// Creates a cache stored in directory \c Path, limited to \c MaxSize
+  /// bytes.
+  CompilationCache(StringRef Path, uint64_t MaxSize = DefaultMaxSize)
+      : Path(Path), MaxSize(MaxSize) {}
+
+  /// Returns a key of the object file compiled by invocation \c Inv.
+  static std::string computeKey(const CompilerInvocation &Inv);
+
+  /// \brief Copies an entry \c Key into file \c Dest.
+  ///
+  /// \return \c true on a hit, \c false if the entry is not cached.
+  bool lookup(StringRef Key, StringRef Dest);
+
+  /// Returns contents of an entry \c Key, or \c nullptr if the entry is not
+  /// cached.
+  std::unique_ptr<llvm::MemoryBuffer> lookup(StringRef Key);
+
+  /// \brief Atomically stores file \c Src as an entry \c Key and evicts
+  /// entries exceeding the size limit.
+  ///
+  /// \return \c true on success.
+  bool store(StringRef Key, StringRef Src);
+
+  /// \brief Atomically stores object file \c Object as an entry \c Key and
+  /// evicts entries exceeding the size limit.
+  ///
+  /// \return \c true on success.
+  bool store(StringRef Key, llvm::MemoryBufferRef Object);
+
+  /// Returns statistics of all caches used by the process.
+  static Statistics &getStatistics();
+
+private:
+  /// Returns path of the entry \c Key.
+  std::string getEntryPath(StringRef Key) const;
+
+  /// Updates access time of an existing entry, returns \c false if the entry
+  /// is not cached.
+  bool touchEntry(StringRef Entry);
+
+  /// Evicts least recently used entries exceeding the size limit.
+  void prune();
+};
+
+/// \brief Computes cache keys of separately compiled parts of a module.
+///
+/// A key of a function depends only on its own source text and on text of
+/// declarations it refers to, that is prototypes of called functions and
+/// global values. Editing a function therefore invalidates only the function
+/// itself and, if its prototype changes, its callers. Declarations of imported
+/// modules contribute their signatures and values of constants.
+class ModuleCacheKeys {
+  const CompilerInvocation &Inv;
+
+  /// Source text of each function, including its body.
+  llvm::DenseMap<FuncStmt *, StringRef> FuncText;
+
+  /// Source text of each function prototype and global value declaration.
+  llvm::DenseMap<Decl *, StringRef> DeclText;
+
+  /// Global value declarations in order of declaration.
+  std::vector<Decl *> Globals;
+
+  /// Source text of all global value declarations.
+  std::string GlobalsText;
+
+public:
+  ModuleCacheKeys(const CompilerInvocation &Inv, ModuleDecl *M);
+
+  /// Returns a key of the object file containing only function \c S.
+  std::string getFuncKey(FuncStmt *S) const;
+
+  /// Returns a key of the object file containing only global values.
+  std::string getGlobalsKey() const;
+};
+
+} // namespace dusk
+
+#endif /* DUSK_COMPILATION_CACHE_H */
@@ -10,23 +10,32 @@
 #include "dusk/Basic/LLVM.h"
 #include "dusk/AST/ASTContext.h"
 #include "dusk/AST/Diagnostics.h"
+#include "dusk/Basic/SourceManager.h"
 #include "dusk/Frontend/CompilerInvocation.h"
 #include "dusk/Frontend/SourceFile.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/IR/Module.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <memory>
+#include <string>
+#include <vector>
 
 #ifndef DUSK_COMPILER_INSTANCE_H
 #define DUSK_COMPILER_INSTANCE_H
 
 namespace dusk {
 class ModuleDecl;
+class SerializedModuleLoader;
+
+namespace sema {
+class Sema;
+}
 
 /// Encapsulation of compiler state and execution.
 class CompilerInstance : public DiagnosticConsumer {
   CompilerInvocation Invocation;
-  SourceMgr SourceManager;
+  dusk::SourceManager SourceManager;
   DiagnosticEngine Diag{SourceManager};
 
   /// Compilation context.
@@ -35,12 +44,24 @@ class CompilerInstance : public DiagnosticConsumer {
   /// Main compilation module
   ModuleDecl *MainModule = nullptr;
 
+  /// Loader of modules imported by the main module.
+  std::unique_ptr<SerializedModuleLoader> Loader;
+
+  /// Stream diagnostics and errors are reported to.
+  raw_ostream &OS;
+
 public:
   /// Constructs a default compiler instance.
   CompilerInstance();
 
+  /// Constructs a compiler instance, which reports diagnostics and errors
+  /// into \c OS.
+  explicit CompilerInstance(raw_ostream &OS);
+
+  ~CompilerInstance();
+
   /// Retuns compilers source manager.
-  SourceMgr &getSourceManager() { return SourceManager; }
+  dusk::SourceManager &getSourceManager() { return SourceManager; }
 
   /// Returns compilers diagnostics.
   DiagnosticEngine &getDiags() { return Diag; }
@@ -58,9 +79,76 @@ public:
   /// Returns the input file.
   SourceFile *getInputFile();
 
-  /// Compiles a source file.
+  /// Returns object files of modules imported by the compiled module, which
+  /// the executable must be linked with.
+  std::vector<std::string> getImportedObjectFiles() const;
+
+  /// \brief Compiles a source file.
+  ///
+  /// If the invocation has a compilation cache, the object file is taken from
+  /// the cache when possible and stored into it otherwise. If requested,
+  /// an interface of the module is written along with the object file, which
+  /// is then compiled to be loadable by \c DuskJIT as well.
   void performCompilation();
 
+  /// \brief Compiles a source file reusing cached objects of unchanged
+  /// functions.
+  ///
+  /// Each function is compiled into its own partial object file, which is
+  /// cached under a key of the function and declarations it refers to.
+  /// Only functions missing in the cache are emitted, the partial objects
+  /// are then combined into a single object file. Functions are optimized
+  /// separately, there is no inlining across functions.
+  void performIncrementalCompilation();
+
+  /// \brief Compiles a source file with stages running concurrently.
+  ///
+  /// Functions are passed to IR generation as soon as their bodies are type
+  /// checked, and emitted partial modules are passed to code generation
+  /// threads. Stages are connected by bounded queues, therefore no stage
+  /// runs arbitrarily far ahead. The partial objects are combined into
+  /// a single object file at the end.
+  void performPipelinedCompilation();
+
+  /// \brief Compiles a source file one function body at a time.
+  ///
+  /// Only declarations are kept for the whole compilation. Each function
+  /// body is parsed, type checked and emitted into its own arena, which is
+  /// released right after, therefore memory use does not grow with
+  /// the number of functions in the file.
+  void performStreamingCompilation();
+
+  /// \brief Compiles a source file in memory and runs it.
+  ///
+  /// The program is compiled by \c DuskJIT, no object file is written and no
+  /// linker is invoked.
+  ///
+  /// \return Exit code of the program, or \c 1 if it could not be compiled.
+  int performRun();
+
+  /// \brief Interprets a source file.
+  ///
+  /// The program is lowered into bytecode and executed by
+  /// \c interp::Interpreter, which skips LLVM entirely and therefore starts
+  /// faster than \c performRun.
+  ///
+  /// \return Exit code of the program, or \c 1 if it could not be
+  ///   interpreted.
+  int performInterpret();
+
+  /// \brief Compiles a source file into an object file kept in memory, e.g.
+  /// to be added to \c DuskJIT.
+  ///
+  /// The source is always type checked, therefore the module is available
+  /// afterwards. If the invocation has a compilation cache, code generation
+  /// is skipped when the object file is cached and the object file is stored
+  /// into the cache otherwise. The object is generated with relocation and
+  /// code model set up by \c DuskJIT::setUpInvocation.
+  ///
+  /// \return The object file, or \c nullptr if the source could not be
+  ///   compiled.
+  std::unique_ptr<llvm::MemoryBuffer> performInMemoryCompilation();
+
   /// Parses file and performs a semantic analysis.
   void performSema();
 
@@ -76,7 +164,31 @@ public:
   virtual void consume(SMDiagnostic &Diagnostic);
 
 private:
-  void emitObjectFile(llvm::Module *M);
+  /// Compiles a source file bypassing the compilation cache.
+  void performUncachedCompilation();
+
+  /// \brief Compiles a source file using a whole object file cache.
+  ///
+  /// Programs importing modules are never stored, since the key does not
+  /// cover interfaces of the modules.
+  void performCachedCompilation();
+
+  /// Makes modules imported by the main module available to \c S.
+  void setUpModuleLoader(sema::Sema &S);
+
+  /// Writes interface of the main module, returns \c true on success.
+  bool emitModuleInterface();
+
+  /// Emits an object file of \c M, returns \c true on success.
+  bool emitObjectFile(std::unique_ptr<llvm::Module> M);
+
+  /// \brief Emits an object file \c Filename of \c M using multiple threads.
+  ///
+  /// The module is split into groups of functions, which are compiled
+  /// concurrently into partial object files. The partial objects are then
+  /// combined into a single relocatable object file.
+  bool emitObjectFileParallel(std::unique_ptr<llvm::Module> M,
+                              StringRef Filename);
 
   // Explicitly forbid copying of any kind.
   CompilerInstance(const CompilerInstance &other) = delete;
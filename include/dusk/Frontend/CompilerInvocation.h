@@ -14,14 +14,49 @@
 #include "dusk/AST/Diagnostics.h"
 #include "dusk/Frontend/SourceFile.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/Optional.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/Support/CodeGen.h"
 #include "llvm/Support/SourceMgr.h"
+#include <cstdint>
 #include <vector>
 #include <memory>
+#include <string>
 
 namespace dusk {
 
+/// Describes how the source is lexed for the parser.
+enum class LexingMode {
+  /// Tokens are lexed on demand, as the parser consumes them.
+  OnDemand,
+
+  /// The whole buffer is lexed into a \c TokenStream before parsing.
+  Buffered,
+
+  /// The buffer is lexed into a \c TokenStream on a separate thread,
+  /// running ahead of the parser.
+  Threaded
+};
+
+/// Optimization level of the generated code.
+enum class OptLevel {
+  /// No optimizations.
+  O0,
+
+  /// Optimizations that do not slow down compilation noticeably.
+  O1,
+
+  /// Most optimizations, the default pipeline.
+  O2,
+
+  /// All optimizations including the ones increasing code size.
+  O3,
+
+  /// Optimizations with preference of smaller code.
+  Os
+};
+
 /// Compiler configuration.
 class CompilerInvocation {
 
@@ -33,8 +68,54 @@ class CompilerInvocation {
   StringRef ModuleName;
   StringRef OutputName;
 
+  /// Path of the emitted object file.
+  std::string ObjectFile;
+
   bool IsQuiet;
   bool PrintIR;
+
+  LexingMode LexMode;
+
+  /// Number of threads used to type check function bodies.
+  unsigned SemaJobs;
+
+  /// Number of partitions the module is split into for code generation.
+  unsigned CodegenJobs;
+
+  /// Run type checking, IR generation and code generation as a pipeline.
+  bool IsPipelined;
+
+  /// Parse, check and emit function bodies one at a time.
+  bool IsStreaming;
+
+  OptLevel OptLvl;
+
+  /// CPU the code is generated for.
+  std::string TargetCPU;
+
+  /// Comma separated list of enabled (+) and disabled (-) target features.
+  std::string TargetFeatures;
+
+  /// Relocation model of the generated code, target default if not set.
+  Optional<llvm::Reloc::Model> RelocModel;
+
+  /// Code model of the generated code, target default if not set.
+  Optional<llvm::CodeModel::Model> CodeModel;
+
+  /// Directory of the compilation cache, empty if caching is disabled.
+  std::string CachePath;
+
+  /// Size limit of the compilation cache in bytes.
+  uint64_t CacheSizeLimit;
+
+  /// Cache object files of individual functions.
+  bool IsIncremental;
+
+  /// Directories searched for interfaces of imported modules.
+  std::vector<std::string> ImportPaths;
+
+  /// Path of the emitted module interface, empty if none is emitted.
+  std::string ModuleInterfaceFile;
   
 public:
   CompilerInvocation();
@@ -42,9 +123,93 @@ public:
   void setArgs(SourceMgr &SM, DiagnosticEngine &Diag, StringRef InFile,
                StringRef OutFile, bool IsQuiet, bool PrintIR);
 
+  /// \brief Sets source \c Source named \c Name as the input file.
+  ///
+  /// The source is compiled from memory, \c Name is used only in diagnostics
+  /// and to find modules imported by the source.
+  void setInputBuffer(SourceMgr &SM, StringRef Name, StringRef Source);
+
   bool isQuiet() const { return IsQuiet; }
+
+  /// Sets path of the emitted object file, \c <input>.o by default.
+  void setObjectFile(StringRef Path) { ObjectFile = Path; }
+
+  StringRef getObjectFile() const { return ObjectFile; }
   
   bool printIR() const { return PrintIR; }
+
+  void setLexingMode(LexingMode M) { LexMode = M; }
+
+  LexingMode getLexingMode() const { return LexMode; }
+
+  void setSemaJobs(unsigned N) { SemaJobs = N; }
+
+  unsigned getSemaJobs() const { return SemaJobs; }
+
+  void setCodegenJobs(unsigned N) { CodegenJobs = N; }
+
+  unsigned getCodegenJobs() const { return CodegenJobs; }
+
+  void setPipelined(bool P) { IsPipelined = P; }
+
+  bool isPipelined() const { return IsPipelined; }
+
+  void setStreaming(bool S) { IsStreaming = S; }
+
+  bool isStreaming() const { return IsStreaming; }
+
+  void setOptLevel(OptLevel L) { OptLvl = L; }
+
+  OptLevel getOptLevel() const { return OptLvl; }
+
+  /// \brief Sets the CPU the code is generated for.
+  ///
+  /// \c "native" selects the host CPU and enables all features available on
+  /// the host.
+  void setTargetCPU(StringRef CPU);
+
+  StringRef getTargetCPU() const { return TargetCPU; }
+
+  /// Enables (\c "+feature") or disables (\c "-feature") a target feature.
+  void addTargetFeature(StringRef Feature);
+
+  StringRef getTargetFeatures() const { return TargetFeatures; }
+
+  void setRelocModel(llvm::Reloc::Model RM) { RelocModel = RM; }
+
+  Optional<llvm::Reloc::Model> getRelocModel() const { return RelocModel; }
+
+  void setCodeModel(llvm::CodeModel::Model CM) { CodeModel = CM; }
+
+  Optional<llvm::CodeModel::Model> getCodeModel() const { return CodeModel; }
+
+  /// Enables caching of object files in directory \c Path limited to
+  /// \c SizeLimit bytes.
+  void setCache(StringRef Path, uint64_t SizeLimit) {
+    CachePath = Path;
+    CacheSizeLimit = SizeLimit;
+  }
+
+  StringRef getCachePath() const { return CachePath; }
+
+  uint64_t getCacheSizeLimit() const { return CacheSizeLimit; }
+
+  /// Sets whether functions are compiled and cached individually, so that
+  /// only changed functions are recompiled. Requires a cache directory.
+  void setIncremental(bool I) { IsIncremental = I; }
+
+  bool isIncremental() const { return IsIncremental; }
+
+  /// Adds a directory searched for interfaces of imported modules. Directory
+  /// of the input file is always searched first.
+  void addImportPath(StringRef Path) { ImportPaths.push_back(Path.str()); }
+
+  ArrayRef<std::string> getImportPaths() const { return ImportPaths; }
+
+  /// Sets path of the module interface emitted along with the object file.
+  void setModuleInterfaceFile(StringRef Path) { ModuleInterfaceFile = Path; }
+
+  StringRef getModuleInterfaceFile() const { return ModuleInterfaceFile; }
   
   StringRef getTargetTriple() const { return Target.str(); }
 
@@ -0,0 +1,98 @@
+//===--- DuskJIT.h - In-process execution of dusk programs ------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_DUSK_JIT_H
+#define DUSK_DUSK_JIT_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/IR/DataLayout.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <functional>
+#include <memory>
+
+namespace dusk {
+class CompilerInvocation;
+
+/// \brief Compiles and runs dusk programs in the compiler process.
+///
+/// A thin wrapper around ORC \c LLJIT. Runtime functions of the standard
+/// library are resolved to their definitions linked into the host process,
+/// therefore no object file is written and no linker is invoked.
+class DuskJIT {
+  std::unique_ptr<llvm::orc::LLJIT> JIT;
+
+  DuskJIT(std::unique_ptr<llvm::orc::LLJIT> J) : JIT(std::move(J)) {}
+
+public:
+  /// Creates a JIT generating code for the host using target CPU, features,
+  /// relocation and code model and optimization level of \c Inv.
+  static llvm::Expected<std::unique_ptr<DuskJIT>>
+  create(const CompilerInvocation &Inv);
+
+  /// \brief Sets up relocation and code model of \c Inv, so that object
+  /// files compiled by it can be added to the JIT.
+  ///
+  /// Code of the JIT may be placed anywhere in memory, arbitrarily far from
+  /// other objects and the runtime functions of the host process, hence
+  /// relocations of the static model with small code would overflow.
+  static void setUpInvocation(CompilerInvocation &Inv);
+
+  /// Returns a builder of target machines generating code for the host
+  /// configured by \c Inv.
+  static llvm::Expected<llvm::orc::JITTargetMachineBuilder>
+  createTargetMachineBuilder(const CompilerInvocation &Inv);
+
+  /// Returns data layout modules must use to be added to the JIT.
+  const llvm::DataLayout &getDataLayout() const {
+    return JIT->getDataLayout();
+  }
+
+  /// Adds module \c M owned together with its context \c Ctx to the JIT.
+  llvm::Error addModule(std::unique_ptr<llvm::Module> M,
+                        std::unique_ptr<llvm::LLVMContext> Ctx);
+
+  /// Adds precompiled object file \c Path, e.g. of an imported module.
+  llvm::Error addObjectFile(StringRef Path);
+
+  /// Adds object file \c Object compiled in memory.
+  llvm::Error addObject(std::unique_ptr<llvm::MemoryBuffer> Object);
+
+  /// Defines symbol \c Name at address \c Addr of the host process, e.g.
+  /// a function called by an \c extern function of the program.
+  llvm::Error defineSymbol(StringRef Name, llvm::JITTargetAddress Addr);
+
+  /// Returns address of symbol \c Name, linking code defining it first if
+  /// necessary.
+  llvm::Expected<llvm::JITTargetAddress> lookup(StringRef Name);
+
+  /// Reports errors of linking, e.g. undefined symbols, to \c Reporter
+  /// rather than to the standard error output.
+  void setErrorReporter(std::function<void(llvm::Error)> Reporter) {
+    JIT->getExecutionSession().setErrorReporter(std::move(Reporter));
+  }
+
+  /// \brief Runs \c main function of the program.
+  ///
+  /// \return Exit code of the program.
+  llvm::Expected<int> runMain();
+
+private:
+  /// Defines runtime functions in the main dylib of the JIT.
+  llvm::Error defineRuntime();
+};
+
+} // namespace dusk
+
+#endif /* DUSK_DUSK_JIT_H */
@@ -0,0 +1,200 @@
+//===--- IncrementalDocument.h - Incrementally checked source ---*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_INCREMENTAL_DOCUMENT_H
+#define DUSK_INCREMENTAL_DOCUMENT_H
+
+#include "dusk/Basic/LLVM.h"
+#include "dusk/AST/Diagnostics.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/SourceMgr.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dusk {
+class ASTContext;
+class FuncStmt;
+class SerializedModuleLoader;
+class SourceFile;
+class SourceManager;
+
+namespace sema {
+class Sema;
+}
+
+/// Diagnostic of a document resolved to a position within its current text.
+struct DocumentDiagnostic {
+  llvm::SourceMgr::DiagKind Kind;
+  std::string Message;
+
+  /// 0-based line and column of the diagnosed location.
+  unsigned Line;
+  unsigned Column;
+
+  /// Number of characters of the diagnosed token, at least 1.
+  unsigned Length;
+};
+
+/// \brief Source file, which is kept parsed and type checked while being
+/// edited.
+///
+/// The source manager, AST context and the global scope of the document stay
+/// resident between edits. When all edits since the last update lie within
+/// bodies of top-level functions, only the edited bodies are lexed, parsed
+/// and type checked again against the global scope. Any other edit rebuilds
+/// the whole document.
+///
+/// Function bodies are released right after being checked, only their
+/// diagnostics are kept. Positions of diagnostics are stored relative to
+/// the function they belong to, so that edits of other functions do not
+/// invalidate them.
+class IncrementalDocument : public DiagnosticConsumer {
+  /// A diagnostic stored relative to its owner.
+  struct StoredDiagnostic {
+    llvm::SourceMgr::DiagKind Kind;
+    std::string Message;
+    int64_t Offset;
+  };
+
+  /// A top-level function with a separately checked body.
+  struct FuncEntry {
+    FuncStmt *FS;
+
+    /// Offsets of the opening brace and one past the closing brace of
+    /// the body in the buffer of the last rebuild.
+    size_t OrigBegin;
+    size_t OrigEnd;
+
+    /// Offsets of the body in the current text.
+    size_t Begin;
+    size_t End;
+
+    /// The body was edited since the last update.
+    bool IsDirty = false;
+
+    /// Diagnostics of the body, relative to \c Begin.
+    std::vector<StoredDiagnostic> Diags;
+  };
+
+  std::string Filename;
+  std::string Text;
+  std::vector<std::string> ImportPaths;
+
+  /// Offsets of starts of lines of \c Text.
+  std::vector<size_t> LineStarts;
+
+  // Compilation state, recreated by every rebuild.
+  std::unique_ptr<dusk::SourceManager> SourceManager;
+  std::unique_ptr<DiagnosticEngine> Diag;
+  std::unique_ptr<SourceFile> File;
+  std::unique_ptr<ASTContext> Context;
+  std::unique_ptr<SerializedModuleLoader> Loader;
+  std::unique_ptr<sema::Sema> Sema;
+
+  /// Start of the buffer of the last rebuild.
+  const char *MainBufferStart = nullptr;
+  unsigned MainBufferID = 0;
+
+  /// Functions in order of their appearance.
+  std::vector<FuncEntry> Funcs;
+
+  /// Diagnostics outside of function bodies, relative to the buffer of
+  /// the last rebuild.
+  std::vector<StoredDiagnostic> GlobalDiags;
+
+  /// Function being checked, diagnostics are attributed to it.
+  FuncEntry *CurrentFunc = nullptr;
+
+  /// Buffer of the edited body being checked, if any.
+  StringRef CurrentBody;
+
+  /// Arena of the function body being checked.
+  llvm::BumpPtrAllocator BodyArena;
+
+  /// \c true if all declarations are valid, so that bodies may be checked
+  /// separately.
+  bool IsGlobalScopeValid = false;
+
+  /// An edit outside of function bodies requires a rebuild.
+  bool NeedsRebuild = true;
+
+  /// Size of buffers of edited bodies added since the last rebuild.
+  size_t BufferedBytes = 0;
+
+  unsigned NumRebuilds = 0;
+  unsigned NumRechecks = 0;
+
+public:
+  /// Creates a document \c Filename of contents \c Text. Imported modules are
+  /// searched for in the directory of the file and in \c ImportPaths.
+  IncrementalDocument(StringRef Filename, StringRef Text,
+                      std::vector<std::string> ImportPaths = {});
+  ~IncrementalDocument();
+
+  StringRef getText() const { return Text; }
+
+  /// Replaces the whole text of the document.
+  void setText(StringRef NewText);
+
+  /// Returns offset of 0-based \c Line and \c Column, clamped to the text.
+  size_t getOffset(unsigned Line, unsigned Column) const;
+
+  /// Replaces \c Length characters at \c Offset with \c NewText.
+  void edit(size_t Offset, size_t Length, StringRef NewText);
+
+  /// \brief Brings diagnostics up to date with all edits.
+  ///
+  /// \return \c true if the document was rebuilt, \c false if only edited
+  ///   function bodies were checked.
+  bool update();
+
+  /// Returns diagnostics of the last update.
+  std::vector<DocumentDiagnostic> getDiagnostics() const;
+
+  /// Returns number of whole document rebuilds.
+  unsigned getNumRebuilds() const { return NumRebuilds; }
+
+  /// Returns number of separately checked function bodies.
+  unsigned getNumRechecks() const { return NumRechecks; }
+
+  void consume(SMDiagnostic &Diagnostic) override;
+
+private:
+  /// Parses and checks the whole document from scratch.
+  void rebuild();
+
+  /// Parses and checks the edited body of \c F, returns \c false if its
+  /// extent has changed and the document must be rebuilt instead.
+  bool recheck(FuncEntry &F);
+
+  /// Checks a body of \c F, which was just parsed.
+  void checkBody(FuncEntry &F, bool IsParsed);
+
+  /// Returns the function, whose body contains range [\c Begin, \c End)
+  /// excluding its braces, or \c nullptr if there is none.
+  FuncEntry *findFunc(size_t Begin, size_t End);
+
+  /// Maps offset in the buffer of the last rebuild to the current text.
+  size_t mapMainOffset(size_t Offset) const;
+
+  void computeLineStarts();
+
+  /// Resolves \c D stored at offset \c Offset of the current text.
+  DocumentDiagnostic resolve(const StoredDiagnostic &D, int64_t Offset) const;
+
+  /// Releases the compilation state in reverse order of dependencies.
+  void resetState();
+};
+
+} // namespace dusk
+
+#endif /* DUSK_INCREMENTAL_DOCUMENT_H */
@@ -0,0 +1,48 @@
+//===--- Linker.h - Linking of dusk executables -----------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_LINKER_H
+#define DUSK_LINKER_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+#include <string>
+
+namespace dusk {
+
+/// \brief Links object files \c ObjFiles with the standard library into
+/// an executable \c Out.
+///
+/// If dusk is built with lld (\c DUSK_HAVE_LLD), the executable is linked
+/// in-process against the static \c libstddusk archive. Otherwise, or if
+/// linking by lld fails, the system \c clang++ driver is executed. The
+/// standard library is searched for in \c DUSK_STDLIB_PATH, if set.
+///
+/// \return \c true on success, \c false otherwise. Errors are reported into
+///   \c OS.
+bool linkExecutable(ArrayRef<std::string> ObjFiles, StringRef Out,
+                    raw_ostream &OS);
+
+/// \brief Combines object files \c Parts into a single relocatable object
+/// file \c Out.
+///
+/// If dusk is built with lld (\c DUSK_HAVE_LLD), the objects are combined
+/// in-process by a relocatable link. Otherwise, or if lld fails, the system
+/// \c ld supporting \c -r is executed, which must be found in \c PATH.
+///
+/// \return \c true on success, \c false otherwise. Errors are reported into
+///   \c OS.
+bool mergeObjectFiles(ArrayRef<std::string> Parts, StringRef Out,
+                      raw_ostream &OS);
+
+} // namespace dusk
+
+#endif /* DUSK_LINKER_H */
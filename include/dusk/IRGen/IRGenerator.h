@@ -15,7 +15,6 @@
 #include "dusk/AST/Stmt.h"
 #include "dusk/AST/Pattern.h"
 #include "dusk/AST/ASTWalker.h"
-#include "dusk/AST/NameLookup.h"
 #include "dusk/AST/ASTContext.h"
 
 #include "llvm/ADT/StringMap.h"
@@ -33,9 +32,28 @@
 #include "llvm/IR/Verifier.h"
 #include <stack>
 #include <memory>
+#include <vector>
 
 namespace dusk {
 namespace irgen {
+class IRGenModule;
+
+/// A part of the program, which owns its LLVM context and therefore can be
+/// compiled independently on any thread.
+struct IRGenUnit {
+  std::unique_ptr<llvm::LLVMContext> Context;
+  std::unique_ptr<llvm::Module> Module;
+
+  IRGenUnit() = default;
+  IRGenUnit(IRGenUnit &&Other) = default;
+
+  IRGenUnit &operator=(IRGenUnit &&Other) {
+    // Module must be destroyed before its context.
+    Module = std::move(Other.Module);
+    Context = std::move(Other.Context);
+    return *this;
+  }
+};
 
 class IRGenerator : public ASTWalker {
   llvm::StringMap<llvm::AllocaInst *> NamedValues;
@@ -49,6 +67,69 @@ public:
   ~IRGenerator();
 
   llvm::Module *perform();
+
+  /// Emits the whole program into a unit owning its own LLVM context.
+  IRGenUnit performUnit();
+};
+
+/// \brief Makes global variables of module \c M visible to other modules
+/// under the hidden symbols of partial modules.
+///
+/// Functions of \c M split into several modules may then share a global,
+/// while its symbol cannot clash with functions or runtime symbols.
+void exportGlobals(llvm::Module &M);
+
+/// \brief Emits the program function by function into partial modules.
+///
+/// Unlike \c IRGenerator, which requires the whole module to be type
+/// checked, a function can be emitted as soon as its body is type checked.
+/// Functions and global values used by a partial module, but defined by
+/// another one, are declared as external and resolved by the linker.
+///
+/// \note Prototypes of all functions and types of all global values must be
+///  resolved before emitting the first function.
+class PartialIRGenerator {
+  ASTContext &Context;
+  std::unique_ptr<llvm::LLVMContext> LLVMContext;
+  std::unique_ptr<llvm::Module> Module;
+  std::unique_ptr<llvm::IRBuilder<>> Builder;
+  std::unique_ptr<IRGenModule> IRGM;
+
+  /// External functions, which are declared in every unit.
+  std::vector<FuncDecl *> Externs;
+
+  /// Number of functions emitted into the current unit.
+  unsigned NumFuncs;
+
+  /// Number of units already taken.
+  unsigned NumUnits;
+
+public:
+  PartialIRGenerator(ASTContext &Ctx);
+  ~PartialIRGenerator();
+
+  /// Emits definition of function \c S into the current unit.
+  void emitFunc(FuncStmt *S);
+
+  /// Emits definitions of all global values into the current unit.
+  void emitGlobals();
+
+  /// Returns number of functions emitted into the current unit.
+  unsigned getNumFuncs() const { return NumFuncs; }
+
+  /// Returns number of instructions emitted into the current unit.
+  unsigned getNumInstructions() {
+    return Module ? Module->getInstructionCount() : 0;
+  }
+
+  /// Finishes the current unit and returns it. Following emission starts
+  /// a new unit.
+  IRGenUnit takeUnit();
+
+private:
+  /// Creates a new empty unit. Units are created lazily, on the first
+  /// emission into them.
+  void startUnit();
 };
 
 } // namespace ir
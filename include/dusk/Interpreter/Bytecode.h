@@ -0,0 +1,124 @@
+//===--- Bytecode.h - Dusk interpreter bytecode -----------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_INTERPRETER_BYTECODE_H
+#define DUSK_INTERPRETER_BYTECODE_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dusk {
+namespace interp {
+
+enum class Opcode : uint16_t {
+#define OPCODE(Id, Format) Id,
+#include "dusk/Interpreter/Opcodes.def"
+};
+
+/// Returns name of opcode \c Op.
+StringRef getOpcodeName(Opcode Op);
+
+/// \brief A single instruction of the register machine.
+///
+/// Operands are registers of the current frame, a 16-bit immediate or
+/// a 32-bit immediate stored in operands \c B and \c C.
+struct Instruction {
+  Opcode Op;
+  uint16_t A;
+  uint16_t B;
+  uint16_t C;
+
+  Instruction(Opcode Op, uint16_t A = 0, uint16_t B = 0, uint16_t C = 0)
+      : Op(Op), A(A), B(B), C(C) {}
+
+  /// Returns an instruction with register \c A and 32-bit immediate \c Imm.
+  static Instruction getWithImm(Opcode Op, uint16_t A, int32_t Imm) {
+    Instruction I(Op, A);
+    I.setImm(Imm);
+    return I;
+  }
+
+  int32_t getImm() const {
+    return static_cast<int32_t>(uint32_t(B) | uint32_t(C) << 16);
+  }
+
+  void setImm(int32_t Imm) {
+    B = static_cast<uint16_t>(uint32_t(Imm));
+    C = static_cast<uint16_t>(uint32_t(Imm) >> 16);
+  }
+};
+
+static_assert(sizeof(Instruction) == 8, "Instructions must stay compact");
+
+/// Storage of a local array, which is a part of the function frame.
+struct FrameArray {
+  /// Index of the first cell in the frame.
+  uint32_t Offset;
+
+  /// Number of cells of the array.
+  uint32_t Size;
+};
+
+/// A function lowered to bytecode.
+struct BytecodeFunction {
+  std::string Name;
+  unsigned NumParams = 0;
+  bool ReturnsValue = false;
+
+  /// Number of registers, parameters occupy the first ones.
+  unsigned NumRegs = 0;
+
+  /// Number of cells of a frame, registers followed by local arrays.
+  unsigned FrameSize = 0;
+
+  std::vector<Instruction> Code;
+  std::vector<int64_t> Constants;
+  std::vector<FrameArray> Arrays;
+};
+
+/// A function implemented by the runtime or by the host process.
+struct NativeFunction {
+  std::string Name;
+  unsigned NumParams = 0;
+  bool ReturnsValue = false;
+};
+
+/// \brief A program lowered to bytecode.
+///
+/// All values are 64-bit cells, arrays are represented by an address of
+/// their first element. Global values and array literals are initialized
+/// when the module is created, therefore the module is only valid for
+/// a single run.
+class BytecodeModule {
+  /// Arrays with static storage, i.e. global arrays and array literals.
+  std::vector<std::unique_ptr<int64_t[]>> Storage;
+
+public:
+  std::vector<BytecodeFunction> Functions;
+  std::vector<NativeFunction> Natives;
+  std::vector<int64_t> Globals;
+
+  /// Index of the \c main function, or \c -1 if the program has none.
+  int Main = -1;
+
+  /// Returns a zeroed static array of \c Size cells.
+  int64_t *allocateArray(size_t Size);
+
+  /// Prints human readable listing of the module.
+  void print(raw_ostream &OS) const;
+};
+
+} // namespace interp
+} // namespace dusk
+
+#endif /* DUSK_INTERPRETER_BYTECODE_H */
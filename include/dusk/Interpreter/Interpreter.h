@@ -0,0 +1,81 @@
+//===--- Interpreter.h - Dusk bytecode interpreter --------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_INTERPRETER_INTERPRETER_H
+#define DUSK_INTERPRETER_INTERPRETER_H
+
+#include "dusk/Basic/LLVM.h"
+#include "dusk/Interpreter/Bytecode.h"
+#include <memory>
+#include <vector>
+
+namespace dusk {
+class ASTContext;
+
+namespace interp {
+
+/// \brief Lowers a type checked module into bytecode.
+///
+/// The generated code has the same semantics as the code generated by
+/// \c IRGenerator, except that functions of imported modules cannot be
+/// called, since only their object code is available.
+class BytecodeGenerator {
+  ASTContext &Context;
+  raw_ostream &OS;
+
+public:
+  BytecodeGenerator(ASTContext &Ctx, raw_ostream &OS);
+
+  /// \return The lowered module, or \c nullptr if the program cannot be
+  ///   interpreted. The reason is reported into the stream.
+  std::unique_ptr<BytecodeModule> perform();
+};
+
+/// \brief Executes programs lowered into bytecode.
+///
+/// Instructions are dispatched by threaded code where the compiler supports
+/// computed gotos, and by a switch otherwise. Native functions, i.e.
+/// the runtime and \c extern functions, are resolved in the host process.
+class Interpreter {
+  BytecodeModule &Module;
+  raw_ostream &OS;
+
+  /// Addresses of native functions of the module.
+  std::vector<void *> Natives;
+
+public:
+  /// Number of cells of the stack of frames.
+  static const size_t StackSize = 1 << 23;
+
+  /// Maximal number of nested calls.
+  static const size_t MaxCallDepth = 1 << 20;
+
+  /// Maximal number of parameters of a native function.
+  static const unsigned MaxNativeParams = 6;
+
+  Interpreter(BytecodeModule &M, raw_ostream &OS);
+
+  /// Runs \c main function of the module.
+  ///
+  /// \return Exit code of the program, or \c 1 if it could not be run or
+  ///   failed at run time.
+  int run();
+
+private:
+  /// Resolves native functions of the module.
+  bool link();
+
+  /// Executes function \c Fn until it returns.
+  bool execute(unsigned Fn);
+};
+
+} // namespace interp
+} // namespace dusk
+
+#endif /* DUSK_INTERPRETER_INTERPRETER_H */
@@ -15,9 +15,12 @@
 #define DUSK_LEXER_H
 
 #include "dusk/AST/Diagnostics.h"
+#include "dusk/Basic/SourceManager.h"
 #include "dusk/Parse/Token.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/SourceMgr.h"
+#include <utility>
+#include <vector>
 
 namespace dusk {
 
@@ -43,6 +46,9 @@ class Lexer {
   // Option to keep comments as tokens
   bool KeepComments;
 
+  /// Diagnostics recorded for later emission, if set.
+  std::vector<std::pair<SMLoc, diag::DiagID>> *DeferredDiags = nullptr;
+
 private:
   Lexer(const Lexer &other) = delete;
   void operator=(const Lexer &other) = delete;
@@ -76,6 +82,19 @@ public:
   void diagnose(diag::DiagID ID = diag::DiagID::lex_unexpected_symbol);
   void diagnose(Token T, diag::DiagID ID);
 
+  /// \brief Records diagnostics into \c Diags instead of emitting them.
+  ///
+  /// Allows lexing without access to the diagnostic engine, e.g. on
+  /// a different thread. Recorded diagnostics can be later emitted via
+  /// \c Lexer::emitDiagnostic.
+  void deferDiagnostics(std::vector<std::pair<SMLoc, diag::DiagID>> *Diags) {
+    DeferredDiags = Diags;
+  }
+
+  /// Emits a lexer diagnostic \c ID at \c Loc.
+  static void emitDiagnostic(DiagnosticEngine &Engine, SMLoc Loc,
+                             diag::DiagID ID);
+
   // MARK: - Static interface
 
   /// \brief Determins if the given string is a valid non-keyword identifier.
@@ -93,29 +112,29 @@ public:
 
   /// \brief Retrieve a Token, which starts at location \c Loc.
   ///
-  /// \param SM A \c SourceMgr instance, which provides the buffer context.
+  /// \param SM A \c SourceManager instance, which provides the buffer context.
   ///
   /// \param Loc The source location at which the token starts. The location
   ///  must be from provided source manager.
-  static Token getTokenAtLocation(const llvm::SourceMgr &SM, SMLoc Loc);
+  static Token getTokenAtLocation(const dusk::SourceManager &SM, SMLoc Loc);
 
   /// \brief Retrieve a location that points one character pass the end
   ///  of the Token referenced by the \c Loc.
   ///
-  /// \param SM A \c SourceMgr instance, which provides the buffer context.
+  /// \param SM A \c SourceManager instance, which provides the buffer context.
   ///
   /// \param Loc Location of the beginning of the token.
-  static SMLoc getLocForEndOfToken(const llvm::SourceMgr &SM, SMLoc Loc);
+  static SMLoc getLocForEndOfToken(const dusk::SourceManager &SM, SMLoc Loc);
 
   /// Retrieve a location for the start of the line referenced by the \c Loc.
-  static SMLoc getLocForStartOfLine(const llvm::SourceMgr &SM, SMLoc Loc);
+  static SMLoc getLocForStartOfLine(const dusk::SourceManager &SM, SMLoc Loc);
 
   /// Retrieve a location for end of line (start of next line) referenced
   /// by the \c Loc.
-  static SMLoc getLocForEndOfLine(const llvm::SourceMgr &SM, SMLoc Loc);
+  static SMLoc getLocForEndOfLine(const dusk::SourceManager &SM, SMLoc Loc);
 
   /// Retrive a line in the source code referenced by the \c Loc.
-  static StringRef getLineForLoc(const llvm::SourceMgr &SM, SMLoc Loc);
+  static StringRef getLineForLoc(const dusk::SourceManager &SM, SMLoc Loc);
 
 private: // MARK: - Private interface
   void skipToEndOfLine(bool ConsumeNewline);
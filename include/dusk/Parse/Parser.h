@@ -26,12 +26,33 @@
 #include "dusk/AST/Diagnostics.h"
 #include "dusk/Parse/Token.h"
 #include "dusk/Parse/Lexer.h"
+#include "dusk/Parse/TokenStream.h"
 #include "dusk/Frontend/SourceFile.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/SourceMgr.h"
 
 namespace dusk {
 
+/// \brief Saved state of the parser.
+///
+/// Allows the parser to backtrack to a previously visited token.
+class ParserPosition {
+  friend class Parser;
+
+  size_t TokIdx;
+  Token Tok;
+  SMLoc PreviousLoc;
+
+  ParserPosition(size_t Idx, Token T, SMLoc PrevLoc)
+      : TokIdx(Idx), Tok(T), PreviousLoc(PrevLoc) {}
+
+public:
+  ParserPosition() : TokIdx(0), Tok(), PreviousLoc() {}
+
+  bool isValid() const { return Tok.getLoc().isValid(); }
+};
+
 /// The main class used for parsing a dusk-lang (.dusk) source file.
 class Parser {
   ASTContext &Context;
@@ -42,22 +63,56 @@ class Parser {
 
   DiagnosticEngine &Diag;
 
+  /// Lexer used to lex tokens on demand, if no pre-lexed stream is used.
   Lexer *L;
 
+  /// Pre-lexed tokens of the buffer, if any.
+  TokenStream *Tokens;
+
+  /// Index of the token after \c Tok in the \c Tokens.
+  size_t TokIdx;
+
   /// Token currently evaluated by the parser.
   Token Tok;
 
   /// Location of previous token
   SMLoc PreviousLoc;
 
+  /// Skip bodies of functions, which are parsed later by
+  /// \c parseDelayedFuncBody.
+  bool DelayFuncBodies = false;
+
+  /// Positions of opening braces of skipped function bodies.
+  llvm::DenseMap<FuncStmt *, ParserPosition> DelayedBodies;
+
 public:
+  /// \brief Creates a parser of buffer \c BufferID.
+  ///
+  /// \param Tokens Optional pre-lexed tokens of the buffer. If provided,
+  ///   the parser reads tokens from the stream instead of lexing them
+  ///   on demand, allowing for arbitrary lookahead and constant time
+  ///   backtracking.
   Parser(ASTContext &C, SourceMgr &SM, SourceFile &SF, DiagnosticEngine &Diag,
-         unsigned BufferID);
+         unsigned BufferID, TokenStream *Tokens = nullptr);
 
   ~Parser();
 
-  /// Returns next token to be parsed.
-  const Token &peekToken() const;
+  /// \brief Returns \c N-th token after the current one.
+  ///
+  /// \note Lookahead of more than a single token is supported only when
+  ///  parsing from a pre-lexed \c TokenStream.
+  Token peekToken(unsigned N = 1) const;
+
+  /// Returns current position of the parser.
+  ParserPosition getParserPosition() const {
+    return ParserPosition(TokIdx, Tok, PreviousLoc);
+  }
+
+  /// \brief Restores position of the parser.
+  ///
+  /// Backtracking is constant time with a pre-lexed \c TokenStream,
+  /// otherwise the lexer re-lexes the source from the position.
+  void backtrackToPosition(ParserPosition Pos);
 
   /// Consumes current token and returns it's location.
   SMLoc consumeToken();
@@ -85,6 +140,26 @@ public:
   /// Main parsing method.
   ModuleDecl *parseModule();
 
+  /// \brief Enables or disables skipping of function bodies.
+  ///
+  /// If enabled, \c parseModule parses only prototypes of functions and
+  /// records positions of their bodies instead. Bodies are then parsed
+  /// one by one using \c parseDelayedFuncBody, e.g. into a separate arena.
+  void setDelayFuncBodies(bool D) { DelayFuncBodies = D; }
+
+  /// \brief Parses a skipped body of function \c FS and sets it as its body.
+  ///
+  /// \return Parsed body, \c nullptr on error.
+  Stmt *parseDelayedFuncBody(FuncStmt *FS);
+
+  /// \brief Parses a body of function \c FS from a buffer containing only
+  /// the body and sets it as its body.
+  ///
+  /// Allows a single function to be parsed again after its body was edited.
+  ///
+  /// \return Parsed body, \c nullptr on error.
+  Stmt *parseFuncBody(FuncStmt *FS);
+
 private:
 //===------------------------------------------------------------------------===
 //
@@ -102,6 +177,8 @@ private:
 
   Decl *parseLetDecl();
 
+  Decl *parseImportDecl();
+
   Expr *parseDeclValue();
 
   Decl *parseFuncDecl();
@@ -111,6 +188,9 @@ private:
 
   Stmt *parseBlock();
 
+  /// Skips a balanced block, returns location of its closing brace.
+  SMLoc skipBlock();
+
   ASTNode *parseBlockBody();
 
   Decl *parseParamDecl();
@@ -0,0 +1,139 @@
+//===--- TokenStream.h - Pre-lexed token buffer -----------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+//
+// This file defines a buffer of pre-lexed tokens.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_TOKEN_STREAM_H
+#define DUSK_TOKEN_STREAM_H
+
+#include "dusk/Parse/Token.h"
+#include "dusk/Parse/Lexer.h"
+#include "llvm/Support/SourceMgr.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace dusk {
+
+/// \brief All tokens of a single source buffer.
+///
+/// Tokens are stored as a struct-of-arrays, a kind byte and a 32-bit offset
+/// and length relative to the start of the buffer, in fixed-size chunks.
+/// Any token can be accessed by its index in constant time, which allows
+/// arbitrary lookahead and backtracking.
+///
+/// The buffer can be either lexed eagerly during construction or on
+/// a background thread, in which case accessing a token that has not been
+/// lexed yet blocks until it's available.
+///
+/// \note Lexer diagnostics are recorded while filling the stream and are
+///  emitted by \c diagnoseUpTo, as the client reaches their location.
+class TokenStream {
+public:
+  /// Number of tokens per chunk.
+  static constexpr size_t ChunkSize = 4096;
+
+private:
+  struct Chunk {
+    uint8_t Kinds[ChunkSize];
+    uint32_t Offsets[ChunkSize];
+    uint32_t Lengths[ChunkSize];
+  };
+
+  const char *BufferStart;
+
+  /// Chunk table. Its capacity is computed up front from the buffer size,
+  /// therefore it never reallocates while the lexing thread appends to it.
+  std::unique_ptr<std::unique_ptr<Chunk>[]> Chunks;
+
+  /// Number of tokens that are safe to read.
+  std::atomic<size_t> NumReady;
+
+  /// Set once the \c tok::eof token is published.
+  std::atomic<bool> IsDone;
+
+  /// Recorded lexer diagnostics, guarded by \c ReadyLock.
+  std::vector<std::pair<SMLoc, diag::DiagID>> Diags;
+
+  /// Number of published diagnostics.
+  std::atomic<size_t> NumDiags;
+
+  /// Number of diagnostics already emitted by \c diagnoseUpTo.
+  size_t NumEmitted;
+
+  mutable std::mutex ReadyLock;
+  mutable std::condition_variable ReadyCond;
+  std::thread Worker;
+
+  TokenStream(const TokenStream &other) = delete;
+  void operator=(const TokenStream &other) = delete;
+
+public:
+  /// \brief Creates a token stream of the buffer \c BufferID.
+  ///
+  /// \param Async If \c true, the buffer is lexed on a separate thread,
+  ///   otherwise the whole buffer is lexed before the constructor returns.
+  TokenStream(const llvm::SourceMgr &SM, unsigned BufferID,
+              bool Async = false);
+
+  ~TokenStream();
+
+  /// \brief Returns a token at index \c Idx.
+  ///
+  /// Blocks, if the token has not been lexed yet. The last token of the
+  /// stream is always \c tok::eof, which is also returned for any index
+  /// past the end of the stream.
+  Token operator[](size_t Idx) const {
+    if (Idx >= NumReady.load(std::memory_order_acquire))
+      Idx = waitFor(Idx);
+    auto &C = *Chunks[Idx / ChunkSize];
+    auto I = Idx % ChunkSize;
+    return Token(static_cast<tok>(C.Kinds[I]),
+                 StringRef(BufferStart + C.Offsets[I], C.Lengths[I]));
+  }
+
+  /// \brief Returns number of tokens in the stream including \c tok::eof.
+  ///
+  /// Blocks until the whole buffer is lexed.
+  size_t size() const;
+
+  /// \brief Emits lexer diagnostics located before \c Loc.
+  ///
+  /// Each diagnostic is emitted only once, even if the client backtracks.
+  void diagnoseUpTo(DiagnosticEngine &Engine, SMLoc Loc) {
+    if (NumEmitted != NumDiags.load(std::memory_order_acquire))
+      emitDiagnostics(Engine, Loc);
+  }
+
+private:
+  void emitDiagnostics(DiagnosticEngine &Engine, SMLoc Loc);
+
+  /// Blocks until token at index \c Idx is available and returns the index
+  /// clamped to the end of the stream.
+  size_t waitFor(size_t Idx) const;
+
+  /// Lexes the whole buffer, publishing tokens as whole chunks are filled.
+  void lexBuffer(std::unique_ptr<Lexer> L);
+
+  /// Makes first \c N tokens and recorded diagnostics \c Pending available
+  /// to readers.
+  void publish(size_t N, bool Done,
+               std::vector<std::pair<SMLoc, diag::DiagID>> &Pending);
+};
+
+} // namespace dusk
+
+#endif /* DUSK_TOKEN_STREAM_H */
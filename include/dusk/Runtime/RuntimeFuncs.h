@@ -27,12 +27,13 @@ namespace dusk {
 
 static ASTNode *getPrintln(ASTContext &Context) {
   auto TyRepr = new (Context) IdentTypeRepr("Int");
-  auto P =
-      new (Context) ParamDecl(ValDecl::Specifier::Let, "val", SMLoc{}, TyRepr);
+  auto P = new (Context) ParamDecl(
+      ValDecl::Specifier::Let, Context.getIdentifier("val"), SMLoc{}, TyRepr);
   llvm::SmallVector<Decl *, 128> Prms;
   Prms.push_back(P);
   auto Pttrn = new (Context) VarPattern(std::move(Prms), SMLoc{}, SMLoc{});
-  auto Fn = new (Context) FuncDecl("println", SMLoc{}, SMLoc{}, Pttrn);
+  auto Fn = new (Context) FuncDecl(Context.getIdentifier("println"), SMLoc{},
+                                   SMLoc{}, Pttrn);
   return new (Context) ExternStmt(SMLoc{}, Fn);
 }
 
@@ -41,35 +42,36 @@ static ASTNode *getReadln(ASTContext &Context) {
   llvm::SmallVector<Decl *, 128> Prms;
   auto Pttrn = new (Context) VarPattern(std::move(Prms), SMLoc{}, SMLoc{});
   auto TyRepr = new (Context) IdentTypeRepr("Int");
-  auto Fn = new (Context) FuncDecl("readln", SMLoc{}, SMLoc{}, Pttrn, TyRepr);
+  auto Fn = new (Context) FuncDecl(Context.getIdentifier("readln"), SMLoc{},
+                                   SMLoc{}, Pttrn, TyRepr);
   return new (Context) ExternStmt(SMLoc{}, Fn);
 }
   
 static ASTNode *get__iter_range(ASTContext &Context) {
   auto TyRepr = new (Context) IdentTypeRepr("Int");
   llvm::SmallVector<Decl *, 128> Prms;
-  Prms.push_back(new (Context) ParamDecl(ValDecl::Specifier::Let, "Start",
-                                         SMLoc{}, TyRepr));
-  Prms.push_back(new (Context) ParamDecl(ValDecl::Specifier::Let, "End",
-                                         SMLoc{}, TyRepr));
+  Prms.push_back(new (Context) ParamDecl(
+      ValDecl::Specifier::Let, Context.getIdentifier("Start"), SMLoc{}, TyRepr));
+  Prms.push_back(new (Context) ParamDecl(
+      ValDecl::Specifier::Let, Context.getIdentifier("End"), SMLoc{}, TyRepr));
 
   auto Pttrn = new (Context) VarPattern(std::move(Prms), SMLoc{}, SMLoc{});
-  auto Fn =
-      new (Context) FuncDecl("__iter_range", SMLoc{}, SMLoc{}, Pttrn, TyRepr);
+  auto Fn = new (Context) FuncDecl(Context.getIdentifier("__iter_range"),
+                                   SMLoc{}, SMLoc{}, Pttrn, TyRepr);
   return new (Context) ExternStmt(SMLoc{}, Fn);
 }
 
 static ASTNode *get__iter_step(ASTContext &Context) {
   auto TyRepr = new (Context) IdentTypeRepr("Int");
   llvm::SmallVector<Decl *, 128> Prms;
-  Prms.push_back(new (Context) ParamDecl(ValDecl::Specifier::Let, "Start",
-                                         SMLoc{}, TyRepr));
-  Prms.push_back(new (Context) ParamDecl(ValDecl::Specifier::Let, "End",
-                                         SMLoc{}, TyRepr));
+  Prms.push_back(new (Context) ParamDecl(
+      ValDecl::Specifier::Let, Context.getIdentifier("Start"), SMLoc{}, TyRepr));
+  Prms.push_back(new (Context) ParamDecl(
+      ValDecl::Specifier::Let, Context.getIdentifier("End"), SMLoc{}, TyRepr));
   
   auto Pttrn = new (Context) VarPattern(std::move(Prms), SMLoc{}, SMLoc{});
-  auto Fn =
-  new (Context) FuncDecl("__iter_step", SMLoc{}, SMLoc{}, Pttrn, TyRepr);
+  auto Fn = new (Context) FuncDecl(Context.getIdentifier("__iter_step"),
+                                   SMLoc{}, SMLoc{}, Pttrn, TyRepr);
   return new (Context) ExternStmt(SMLoc{}, Fn);
 }
   
@@ -15,7 +15,9 @@
 #include "dusk/AST/Diagnostics.h"
 #include "dusk/AST/NameLookup.h"
 #include "dusk/AST/Scope.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/SourceMgr.h"
+#include <functional>
 
 namespace dusk {
 class ASTContext;
@@ -25,6 +27,8 @@ class Stmt;
 class ArrayLiteralExpr;
 class Pattern;
 class FuncDecl;
+class FuncStmt;
+class ModuleLoader;
 class Type;
 class TypeRepr;
 
@@ -42,18 +46,72 @@ class Sema {
   NameLookup DeclCtx;
   Scope Scp;
 
+  /// Number of threads used to type check function bodies.
+  unsigned NumThreads;
+
+  /// Invoked with every successfully type checked function.
+  std::function<void(FuncStmt *)> OnFuncChecked;
+
+  /// Loader of imported modules, if imports are supported.
+  ModuleLoader *Loader = nullptr;
+
+  /// Number of globals visible to bodies of functions checked separately
+  /// by \c typeCheckFuncBody.
+  llvm::DenseMap<FuncStmt *, unsigned> FuncGlobals;
+
 public:
-  Sema(ASTContext &C, DiagnosticEngine &D);
+  /// \brief Creates a semantic analyzer of the root module of \c C.
+  ///
+  /// \param NumThreads Number of threads type checking function bodies.
+  ///   Diagnostics are reported in the same order regardless of the value.
+  Sema(ASTContext &C, DiagnosticEngine &D, unsigned NumThreads = 1);
 
   void perform();
 
+  /// \brief Type checks all top-level declarations, except bodies of
+  /// functions.
+  ///
+  /// Bodies are checked one by one by \c typeCheckFuncBody afterwards,
+  /// which allows them to be parsed and released separately.
+  void performDeclarations();
+
+  /// \brief Type checks body of function \c FS, whose prototype was
+  /// checked by \c performDeclarations.
+  ///
+  /// The body sees only global values declared before the function.
+  void typeCheckFuncBody(FuncStmt *FS);
+
+  /// \brief Sets a callback invoked with every function, whose body was
+  /// type checked without any error in the module so far.
+  ///
+  /// The callback is invoked as soon as the body is checked, before
+  /// \c perform returns, possibly concurrently from multiple threads.
+  void setFuncCheckedCallback(std::function<void(FuncStmt *)> Fn) {
+    OnFuncChecked = std::move(Fn);
+  }
+
+  /// \brief Sets loader of modules imported by the root module.
+  ///
+  /// Without a loader, every import is reported as an unknown module.
+  void setModuleLoader(ModuleLoader *L) { Loader = L; }
+
   Type *typeReprResolve(TypeRepr *TR);
   Type *typeReprResolve(FuncDecl *FD);
   Type *typeReprResolve(ArrayLiteralExpr *FD);
 
 private:
+  /// Makes declarations of all imported modules visible to the root module.
+  void importModules();
+
   void declareFuncs();
   void typeCheck();
+
+  /// Type checks top-level node \c N, only prototype in case of a function.
+  void typeCheckTopLevel(ASTNode *N, DiagnosticEngine &D);
+
+  /// Type checks globals and function prototypes sequentially, followed by
+  /// function bodies checked concurrently.
+  void typeCheckConcurrently();
 };
 
 } // namespace sema
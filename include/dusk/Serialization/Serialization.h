@@ -0,0 +1,36 @@
+//===--- Serialization.h - Writing of module interfaces ---------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_SERIALIZATION_H
+#define DUSK_SERIALIZATION_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace dusk {
+class ModuleDecl;
+
+/// Extension of module interface files.
+constexpr const char *ModuleInterfaceExtension = "duskmodule";
+
+/// \brief Writes an interface of type checked module \c M into file \c Path.
+///
+/// The interface contains prototypes of all functions except \c main and
+/// global constants initialized by an integer literal. \c ObjectFile is the object file defining
+/// the module, programs importing the module are linked against it.
+///
+/// \return \c true on success, \c false otherwise. Errors are reported into
+///   \c OS.
+bool serializeModule(ModuleDecl *M, StringRef Path, StringRef ObjectFile,
+                     raw_ostream &OS);
+
+} // namespace dusk
+
+#endif /* DUSK_SERIALIZATION_H */
@@ -0,0 +1,54 @@
+//===--- SerializedModuleLoader.h - Loading of module files -----*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_SERIALIZED_MODULE_LOADER_H
+#define DUSK_SERIALIZED_MODULE_LOADER_H
+
+#include "dusk/Basic/LLVM.h"
+#include "dusk/AST/ModuleLoader.h"
+#include "llvm/ADT/StringMap.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dusk {
+class ASTContext;
+class ModuleFile;
+
+/// \brief Loads imported modules from their binary interfaces.
+///
+/// Module \c name is looked up as a file \c name.duskmodule in each of
+/// the search paths in order.
+class SerializedModuleLoader : public ModuleLoader {
+  ASTContext &Ctx;
+  std::vector<std::string> SearchPaths;
+
+  /// Loaded modules by their names.
+  llvm::StringMap<std::unique_ptr<ModuleFile>> Modules;
+
+  std::mutex Lock;
+
+public:
+  SerializedModuleLoader(ASTContext &C, std::vector<std::string> Paths);
+  ~SerializedModuleLoader();
+
+  ExternalNameSource *loadModule(ImportDecl *D,
+                                 DiagnosticEngine &Diag) override;
+
+  /// Returns object files defining all of the loaded modules.
+  std::vector<std::string> getObjectFiles() const;
+
+  /// Returns \c true if any module has been loaded.
+  bool hasLoadedModules() const { return !Modules.empty(); }
+};
+
+} // namespace dusk
+
+#endif /* DUSK_SERIALIZED_MODULE_LOADER_H */
@@ -13,24 +13,141 @@
 using namespace dusk;
 
 ASTContext::ASTContext()
-    : TheIntType(new (*this) IntType()), TheVoidType(new (*this) VoidType()) {}
+    : NodeAllocator(&Allocator), NumAllocations(0), IdentifierTable(Allocator),
+      IsError(false), TheIntType(new (*this) IntType()),
+      TheVoidType(new (*this) VoidType()) {}
 
-ASTContext::~ASTContext() {
-  for (auto Cleanup : Cleanups) {
-    Cleanup();
+ASTContext::~ASTContext() = default;
+
+void ASTContext::setConcurrent(bool C) {
+  assert(NodeAllocator == &Allocator && "Arenas are not thread-safe.");
+  // Generations are unique across contexts, a context allocated at the
+  // address of a destroyed one must not see its arenas.
+  static std::atomic<unsigned long> NextGeneration(0);
+  if (C)
+    ConcurrentGeneration = ++NextGeneration;
+  IsConcurrent = C;
+}
+
+llvm::BumpPtrAllocator &ASTContext::getThreadAllocator() {
+  struct ThreadAllocator {
+    unsigned long Generation = 0;
+    llvm::BumpPtrAllocator *Allocator = nullptr;
+  };
+  static thread_local ThreadAllocator Current;
+  if (Current.Generation != ConcurrentGeneration) {
+    std::lock_guard<std::mutex> Guard(ThreadAllocatorsLock);
+    ThreadAllocators.push_back(std::make_unique<llvm::BumpPtrAllocator>());
+    Current = {ConcurrentGeneration, ThreadAllocators.back().get()};
   }
+  return *Current.Allocator;
 }
 
-void *ASTContext::Allocate(size_t Bytes) {
+void *ASTContext::Allocate(size_t Bytes, unsigned Alignment) {
   if (Bytes == 0)
     return nullptr;
 
-  auto Res = new uint8_t[Bytes];
-  Cleanups.push_back([Res] { delete[] Res; });
+  ++NumAllocations;
+  if (IsConcurrent)
+    return getThreadAllocator().Allocate(Bytes, Alignment);
+  return NodeAllocator->Allocate(Bytes, Alignment);
+}
+
+void *ASTContext::AllocatePermanent(size_t Bytes, unsigned Alignment) {
+  if (Bytes == 0)
+    return nullptr;
 
-  return static_cast<void *>(Res);
+  auto Guard = lockTables();
+  ++NumAllocations;
+  return Allocator.Allocate(Bytes, Alignment);
+}
+
+size_t ASTContext::getTotalMemory() const {
+  auto Total = Allocator.getTotalMemory();
+  if (NodeAllocator != &Allocator)
+    Total += NodeAllocator->getTotalMemory();
+  for (auto &A : ThreadAllocators)
+    Total += A->getTotalMemory();
+  return Total;
+}
+
+size_t ASTContext::getBytesAllocated() const {
+  auto Total = Allocator.getBytesAllocated();
+  if (NodeAllocator != &Allocator)
+    Total += NodeAllocator->getBytesAllocated();
+  for (auto &A : ThreadAllocators)
+    Total += A->getBytesAllocated();
+  return Total;
+}
+
+Identifier ASTContext::getIdentifier(StringRef Str) {
+  if (Str.empty())
+    return Identifier();
+
+  auto Guard = lockTables();
+  auto &Entry = *IdentifierTable.insert({Str, char()}).first;
+  return Identifier(&Entry);
 }
 
 VoidType *ASTContext::getVoidType() const { return TheVoidType; }
 
 IntType *ASTContext::getIntType() const { return TheIntType; }
+
+ArrayType *ASTContext::getArrayType(Type *BaseTy, size_t Size) {
+  llvm::FoldingSetNodeID ID;
+  ArrayType::Profile(ID, BaseTy, Size);
+
+  auto Guard = lockTables();
+  void *InsertPos = nullptr;
+  if (auto Ty = ArrayTypes.FindNodeOrInsertPos(ID, InsertPos))
+    return Ty;
+
+  auto Ty = new (*this) ArrayType(BaseTy, Size);
+  ArrayTypes.InsertNode(Ty, InsertPos);
+  return Ty;
+}
+
+InOutType *ASTContext::getInOutType(Type *BaseTy) {
+  llvm::FoldingSetNodeID ID;
+  InOutType::Profile(ID, BaseTy);
+
+  auto Guard = lockTables();
+  void *InsertPos = nullptr;
+  if (auto Ty = InOutTypes.FindNodeOrInsertPos(ID, InsertPos))
+    return Ty;
+
+  auto Ty = new (*this) InOutType(BaseTy);
+  InOutTypes.InsertNode(Ty, InsertPos);
+  return Ty;
+}
+
+FunctionType *ASTContext::getFunctionType(Type *ArgsTy, Type *RetTy) {
+  llvm::FoldingSetNodeID ID;
+  FunctionType::Profile(ID, ArgsTy, RetTy);
+
+  auto Guard = lockTables();
+  void *InsertPos = nullptr;
+  if (auto Ty = FunctionTypes.FindNodeOrInsertPos(ID, InsertPos))
+    return Ty;
+
+  auto Ty = new (*this) FunctionType(ArgsTy, RetTy);
+  FunctionTypes.InsertNode(Ty, InsertPos);
+  return Ty;
+}
+
+PatternType *ASTContext::getPatternType(ArrayRef<Type *> Items) {
+  llvm::FoldingSetNodeID ID;
+  PatternType::Profile(ID, Items);
+
+  auto Guard = lockTables();
+  void *InsertPos = nullptr;
+  if (auto Ty = PatternTypes.FindNodeOrInsertPos(ID, InsertPos))
+    return Ty;
+
+  auto Mem = static_cast<Type **>(
+      AllocatePermanent(sizeof(Type *) * Items.size(), alignof(Type *)));
+  std::uninitialized_copy(Items.begin(), Items.end(), Mem);
+  auto Ty = new (*this) PatternType({Mem, Items.size()});
+  PatternTypes.InsertNode(Ty, InsertPos);
+  return Ty;
+}
@@ -18,7 +18,7 @@
 using namespace dusk;
 
 void *ASTNode::operator new(size_t Bytes, ASTContext &Context) {
-  return Context.Allocate(Bytes);
+  return Context.Allocate(Bytes, alignof(ASTNode));
 }
 
 bool ASTNode::walk(ASTWalker &Walker) {
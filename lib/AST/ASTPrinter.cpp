@@ -108,6 +108,12 @@ public:
     Printer.printDeclPost(D);
   }
 
+  void visitImportDecl(ImportDecl *D) {
+    Printer.printDeclPre(D);
+    Printer << D->getName();
+    Printer.printDeclPost(D);
+  }
+
   void visitParamDecl(ParamDecl *D) {
     Printer.printDeclPre(D);
     Printer << D->getName();
@@ -352,6 +358,12 @@ public:
     case DeclKind::Func:
       KW = tok::kw_func;
       break;
+
+    case DeclKind::Import:
+      if (!isAtStartOfLine())
+        printNewline();
+      KW = tok::kw_import;
+      break;
     default:
       return;
     }
@@ -359,7 +371,7 @@ public:
   }
 
   virtual void printDeclPost(Decl *D) override {
-    if (D->isKind(DeclKind::Var))
+    if (D->isKind(DeclKind::Var) || D->isKind(DeclKind::Import))
       return printText(";");
   }
 
@@ -74,6 +74,8 @@ class Traversal : public ASTVisitor<Traversal,
     return !D->hasTypeRepr() || traverse(D->getTypeRepr());
   }
 
+  bool visitImportDecl(ImportDecl *D) { return true; }
+
   bool visitModuleDecl(ModuleDecl *D) {
     for (auto &N : D->getContents()) {
       if (auto D = dynamic_cast<Decl *>(N))
@@ -235,6 +237,9 @@ class Traversal : public ASTVisitor<Traversal,
   bool visitFuncStmt(FuncStmt *S) {
     if (!traverse(S->getPrototype()))
       return false;
+    // Body may not be parsed yet.
+    if (!S->getBody())
+      return true;
     return traverse(S->getBody());
   }
 
@@ -280,7 +285,7 @@ class Traversal : public ASTVisitor<Traversal,
     for (auto Var : P->getVars())
       if (!traverse(Var))
         return false;
-    return false;
+    return true;
   }
 
   // MARK: - Type representations
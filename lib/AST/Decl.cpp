@@ -17,8 +17,9 @@ using namespace dusk;
 
 // MARK: - Decl class
 
-Decl::Decl(DeclKind K, StringRef N, SMLoc NL)
-    : Kind(K), Name(N), NameLoc(NL), Ty(nullptr), TyRepr(nullptr) {}
+Decl::Decl(DeclKind K, Identifier N, SMLoc NL)
+    : Kind(K), Name(N), NameLoc(NL), Ty(nullptr), TyRepr(nullptr),
+      IsImported(false) {}
 
 #define DECL(CLASS, PARENT)                                                    \
 CLASS##Decl *Decl::get##CLASS##Decl() {                                        \
@@ -27,7 +28,8 @@ CLASS##Decl *Decl::get##CLASS##Decl() {                                        \
 }
 #include "dusk/AST/DeclNodes.def"
 
-Decl::Decl(DeclKind K, StringRef N, SMLoc NL, TypeRepr *TR) : Decl(K, N, NL) {
+Decl::Decl(DeclKind K, Identifier N, SMLoc NL, TypeRepr *TR)
+    : Decl(K, N, NL) {
   TyRepr = TR;
 }
 
@@ -42,25 +44,27 @@ bool Decl::isValDecl() const {
 }
 
 SMRange Decl::getSourceRange() const {
-  auto EndLoc = Name.data() + Name.size();
+  if (!NameLoc.isValid())
+    return SMRange();
+  auto EndLoc = NameLoc.getPointer() + Name.size();
   return {NameLoc, SMLoc::getFromPointer(EndLoc)};
 }
 
 // MARK: - ValDecl class
 
-ValDecl::ValDecl(DeclKind K, Specifier S, StringRef N, SMLoc NL, Expr *E)
+ValDecl::ValDecl(DeclKind K, Specifier S, Identifier N, SMLoc NL, Expr *E)
     : Decl(K, N, NL), Value(E), Spec(S) {}
 
-ValDecl::ValDecl(DeclKind K, Specifier S, StringRef N, SMLoc NL, Expr *E,
+ValDecl::ValDecl(DeclKind K, Specifier S, Identifier N, SMLoc NL, Expr *E,
                  TypeRepr *TR)
     : Decl(K, N, NL, TR), Value(E), Spec(S) {}
 
 // MARK: - VarDecl class
 
-VarDecl::VarDecl(Specifier S, StringRef N, SMLoc NL, SMLoc VarL, Expr *V)
+VarDecl::VarDecl(Specifier S, Identifier N, SMLoc NL, SMLoc VarL, Expr *V)
     : ValDecl(DeclKind::Var, S, N, NL, V), VarLoc(VarL) {}
 
-VarDecl::VarDecl(Specifier S, StringRef N, SMLoc NL, SMLoc VarL, Expr *V,
+VarDecl::VarDecl(Specifier S, Identifier N, SMLoc NL, SMLoc VarL, Expr *V,
                  TypeRepr *TR)
     : ValDecl(DeclKind::Var, S, N, NL, V, TR), VarLoc(VarL) {}
 
@@ -75,17 +79,17 @@ SMRange VarDecl::getSourceRange() const {
 
 // MARK: - ParamDecl class
 
-ParamDecl::ParamDecl(Specifier S, StringRef N, SMLoc NL)
+ParamDecl::ParamDecl(Specifier S, Identifier N, SMLoc NL)
     : ValDecl(DeclKind::Param, S, N, NL, nullptr) {}
-ParamDecl::ParamDecl(Specifier S, StringRef N, SMLoc NL, TypeRepr *TR)
+ParamDecl::ParamDecl(Specifier S, Identifier N, SMLoc NL, TypeRepr *TR)
     : ValDecl(DeclKind::Param, S, N, NL, nullptr, TR) {}
 
 // MARK: - FuncDecl class
 
-FuncDecl::FuncDecl(StringRef N, SMLoc NL, SMLoc FuncL, VarPattern *A)
+FuncDecl::FuncDecl(Identifier N, SMLoc NL, SMLoc FuncL, VarPattern *A)
     : Decl(DeclKind::Func, N, NL), FuncLoc(FuncL), Params(A) {}
 
-FuncDecl::FuncDecl(StringRef N, SMLoc NL, SMLoc FuncL, VarPattern *A,
+FuncDecl::FuncDecl(Identifier N, SMLoc NL, SMLoc FuncL, VarPattern *A,
                    TypeRepr *TR)
     : Decl(DeclKind::Func, N, NL, TR), FuncLoc(FuncL), Params(A) {}
 
@@ -93,9 +97,18 @@ SMRange FuncDecl::getSourceRange() const {
   return {FuncLoc, Params->getLocEnd()};
 }
 
+// MARK: - Import declaration
+
+ImportDecl::ImportDecl(Identifier N, SMLoc NL, SMLoc ImportL)
+    : Decl(DeclKind::Import, N, NL), ImportLoc(ImportL) {}
+
+SMRange ImportDecl::getSourceRange() const {
+  return {ImportLoc, Decl::getSourceRange().End};
+}
+
 // MARK: - Module declaration
 
-ModuleDecl::ModuleDecl(StringRef N, std::vector<ASTNode *> &&C)
+ModuleDecl::ModuleDecl(Identifier N, std::vector<ASTNode *> &&C)
     : Decl(DeclKind::Module, N, SMLoc()), Contents(C) {}
 
 SMRange ModuleDecl::getSourceRange() const {
@@ -64,11 +64,11 @@ void DiagnosticEngine::flushActiveDiag() {
 
 void DiagnosticEngine::emitDiagnostic(const Diagnostic &Diag) {
   auto Loc = Diag.getLoc();
-  auto ID = getBufferForLoc(SourceManager, Loc);
+  auto ID = SourceManager.getBufferForLoc(Loc);
   auto FN = SourceManager.getMemoryBuffer(ID)->getBufferIdentifier();
   auto[L, C] = SourceManager.getLineAndColumn(Loc);
   auto K = llvm::SourceMgr::DiagKind::DK_Error;
-  auto Line = Lexer::getLineForLoc(SourceManager, Loc);
+  auto Line = SourceManager.getLineForLoc(Loc);
   auto Msg = diag::getTextForID(Diag.getID());
   auto D = SMDiagnostic(SourceManager, Loc, FN, L, C, K, Msg, Line, llvm::None,
                         Diag.getFixIts());
@@ -77,3 +77,11 @@ void DiagnosticEngine::emitDiagnostic(const Diagnostic &Diag) {
     C->consume(D);
   }
 }
+
+// MARK: - Diagnostic buffer
+
+void DiagnosticBuffer::flush(DiagnosticEngine &Engine) {
+  for (auto &D : Diags)
+    Engine.forward(D);
+  Diags.clear();
+}
@@ -43,11 +43,11 @@ SMRange ArrayLiteralExpr::getSourceRange() const {
 
 // MARK: - Identifier expression
 
-IdentifierExpr::IdentifierExpr(StringRef N, SMLoc L)
-    : Expr(ExprKind::Identifier), Name(N), NameLoc(L) {}
+IdentifierExpr::IdentifierExpr(Identifier N, SMLoc L)
+    : Expr(ExprKind::Identifier), Name(N), NameLoc(L), D(nullptr) {}
 
 SMRange IdentifierExpr::getSourceRange() const {
-  auto E = SMLoc::getFromPointer(Name.data() + Name.size());
+  auto E = SMLoc::getFromPointer(NameLoc.getPointer() + Name.size());
   return {NameLoc, E};
 }
 
@@ -97,7 +97,7 @@ SMRange PrefixExpr::getSourceRange() const {
 // MARK: - FuncCall expression
 
 CallExpr::CallExpr(Expr *C, Pattern *A)
-    : Expr(ExprKind::Call), Callee(C), Args(A) {}
+    : Expr(ExprKind::Call), Callee(C), Args(A), CalleeDecl(nullptr) {}
 
 SMRange CallExpr::getSourceRange() const {
   return {Callee->getLocStart(), Args->getLocEnd()};
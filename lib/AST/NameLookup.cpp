@@ -12,100 +12,122 @@
 
 using namespace dusk;
 
-// MARK: - Context values
-
-LookupImpl::LookupImpl() : Parent(nullptr) {}
-
-LookupImpl::LookupImpl(LookupImpl *P) : Parent(P) {}
-
-LookupImpl *LookupImpl::push() { return new LookupImpl(this); }
-
-LookupImpl *LookupImpl::pop() {
-  auto Ret = Parent.release();
-  delete this;
-  return Ret;
+NameLookup::NameLookup(const NameLookup &Outer, unsigned NumVisible)
+    : Outer(&Outer), NumOuterVisible(NumVisible) {
+  assert(Outer.getDepth() == 0 && "Outer context must be in global scope.");
+  assert(NumVisible <= Outer.getNumGlobals() && "Invalid number of globals.");
 }
 
-bool LookupImpl::isDeclared(StringRef Str) const {
-  return Vars.find(Str) != Vars.end() || Consts.find(Str) != Consts.end();
-}
+bool NameLookup::declare(Decl *D, bool IsConst) {
+  auto Name = D->getIdentifier();
+  auto It = Vals.find(Name);
 
-Decl *LookupImpl::getVar(StringRef Str) const {
-  auto Var = Vars.find(Str);
-  if (Var != Vars.end())
-    return Var->second;
+  // Check if already declared in current scope
+  if ((It != Vals.end() && It->second.D != nullptr &&
+       It->second.Depth == getDepth()) ||
+      getFunc(Name) != nullptr)
+    return false;
 
-  if (Parent != nullptr)
-    return Parent->getVar(Str);
-  return nullptr;
-}
+  // Only an accepted declaration gets a binding.
+  if (It == Vals.end())
+    It = Vals.insert({Name, Binding()}).first;
+  auto &B = It->second;
 
-Decl *LookupImpl::get(StringRef Str) const {
-  if (auto Var = getVar(Str))
-    return Var;
+  // Remember shadowed binding, global declarations are never popped.
+  if (!Scopes.empty())
+    UndoLog.push_back({Name, B});
 
-  auto Const = Consts.find(Str);
-  if (Const != Consts.end())
-    return Const->second;
+  B.D = D;
+  B.Depth = getDepth();
+  B.IsConst = IsConst;
+  B.Index = Scopes.empty() ? NumGlobals++ : 0;
+  return true;
+}
 
-  if (Parent != nullptr)
-    return Parent->get(Str);
-  return nullptr;
+const NameLookup::Binding *NameLookup::lookup(Identifier Name) const {
+  auto It = Vals.find(Name);
+  if (It != Vals.end() && It->second.D != nullptr)
+    return &It->second;
+  if (Outer == nullptr)
+    return nullptr;
+
+  // Only globals declared before this context are visible.
+  auto B = Outer->lookup(Name);
+  if (B == nullptr || B->Index >= NumOuterVisible)
+    return nullptr;
+  return B;
 }
 
-// MARK: - Context
+bool NameLookup::declareVar(Decl *D) { return declare(D, false); }
 
-NameLookup::NameLookup() : Impl(new LookupImpl()) {}
+bool NameLookup::declareLet(Decl *D) { return declare(D, true); }
 
-NameLookup::~NameLookup() { delete Impl; }
+bool NameLookup::declareFunc(Decl *Fn) {
+  // Validate that we're in global scope.
+  assert(getDepth() == 0 &&
+         "Function declaration must be declared in global scope");
 
-bool NameLookup::declareVar(Decl *D) {
   // Check if already declared in current scope
-  if (Impl->isDeclared(D->getName()) || Funcs[D->getName()] != nullptr)
+  auto &F = Funcs[Fn->getIdentifier()];
+  if (F != nullptr)
     return false;
-
-  Impl->Vars[D->getName()] = D;
+  F = Fn;
   return true;
 }
 
-bool NameLookup::declareLet(Decl *D) {
-  // Check if already declared in current scope
-  if (Impl->isDeclared(D->getName()) || Funcs[D->getName()] != nullptr)
-    return false;
-  Impl->Consts[D->getName()] = D;
-  return true;
+Decl *NameLookup::lookupExternalVal(Identifier Name) const {
+  for (auto S : ExternalSources)
+    if (auto D = S->lookupVal(Name))
+      return D;
+  return Outer ? Outer->lookupExternalVal(Name) : nullptr;
 }
 
-bool NameLookup::declareFunc(Decl *Fn) {
-  // Validate that we're in global scope.
-  assert(Depth == 0 && "Function declaration must be declared in global scope");
-
-  // Check if already declared in current scope
-  if (Funcs[Fn->getName()] != nullptr)
-    return false;
-  Funcs[Fn->getName()] = Fn;
-  return true;
+Decl *NameLookup::lookupExternalFunc(Identifier Name) const {
+  for (auto S : ExternalSources)
+    if (auto D = S->lookupFunc(Name))
+      return D;
+  return nullptr;
 }
 
-Decl *NameLookup::getVal(StringRef Str) const { return Impl->get(Str); }
-
-Decl *NameLookup::getVar(StringRef Str) const { return Impl->getVar(Str); }
+Decl *NameLookup::getVal(Identifier Str) const {
+  if (auto B = lookup(Str))
+    return B->D;
+  return lookupExternalVal(Str);
+}
 
-Decl *NameLookup::getFunc(StringRef Str) { return Funcs[Str]; }
+Decl *NameLookup::getVar(Identifier Str) const {
+  // External values are always constants.
+  auto B = lookup(Str);
+  if (B == nullptr || B->IsConst)
+    return nullptr;
+  return B->D;
+}
 
-bool NameLookup::contains(StringRef Str) const {
-  return Funcs.find(Str) != Funcs.end() || Impl->contains(Str);
+Decl *NameLookup::getFunc(Identifier Str) const {
+  if (auto Fn = Funcs.lookup(Str))
+    return Fn;
+  if (Outer)
+    if (auto Fn = Outer->getFunc(Str))
+      return Fn;
+  return lookupExternalFunc(Str);
 }
 
-void NameLookup::push() {
-  ++Depth;
-  // Update the 'virtual' stack.
-  Impl = Impl->push();
+bool NameLookup::contains(Identifier Str) const {
+  return getFunc(Str) != nullptr || getVal(Str) != nullptr;
 }
 
+void NameLookup::push() { Scopes.push_back(UndoLog.size()); }
+
 void NameLookup::pop() {
-  assert(Depth != 0 && "Cannot pop from global scope");
-  --Depth;
-  // Update the 'virtual' stack.
-  Impl = Impl->pop();
+  assert(!Scopes.empty() && "Cannot pop from global scope");
+  // Restore all bindings shadowed by the popped scope.
+  while (UndoLog.size() > Scopes.back()) {
+    auto &Entry = UndoLog.back();
+    if (Entry.second.D == nullptr)
+      Vals.erase(Entry.first);
+    else
+      Vals[Entry.first] = Entry.second;
+    UndoLog.pop_back();
+  }
+  Scopes.pop_back();
 }
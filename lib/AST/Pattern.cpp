@@ -26,7 +26,7 @@ CLASS##Pattern *Pattern::get##CLASS##Pattern() {                               \
 #include "dusk/AST/PatternNodes.def"
 
 void *Pattern::operator new(size_t Bytes, ASTContext &Context) {
-  return Context.Allocate(Bytes);
+  return Context.Allocate(Bytes, alignof(Pattern));
 }
 
 // MARK: - Expression pattern
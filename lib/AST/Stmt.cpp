@@ -79,7 +79,13 @@ SMRange ExternStmt::getSourceRange() const {
 FuncStmt::FuncStmt(Decl *FP, Stmt *B)
     : Stmt(StmtKind::Func), Prototype(FP), Body(B) {}
 
+FuncStmt::FuncStmt(Decl *FP, SMRange BodyRange)
+    : Stmt(StmtKind::Func), Prototype(FP), Body(nullptr),
+      DelayedBody(BodyRange) {}
+
 SMRange FuncStmt::getSourceRange() const {
+  if (!Body)
+    return {Prototype->getLocStart(), DelayedBody.End};
   return {Prototype->getLocStart(), Body->getLocEnd()};
 }
 
@@ -22,7 +22,8 @@ CLASS##Type *Type::get##CLASS##Type() {                                        \
 #include "dusk/AST/TypeNodes.def"
 
 void *Type::operator new(size_t Bytes, ASTContext &Context) {
-  return Context.Allocate(Bytes);
+  // Types are uniqued, hence they must outlive any arena.
+  return Context.AllocatePermanent(Bytes, alignof(Type));
 }
 
 ValueType::ValueType(TypeKind K) : Type(K) {}
@@ -36,8 +37,10 @@ IntType::IntType() : ValueType(TypeKind::Int) {}
 ArrayType::ArrayType(Type *BT, size_t S)
     : ValueType(TypeKind::Array), BaseTy(BT), Size(S) {}
 
-bool ArrayType::isClassOf(const ArrayType *T) const {
-  return BaseTy->isClassOf(T->getBaseType()) && Size == T->getSize();
+void ArrayType::Profile(llvm::FoldingSetNodeID &ID, Type *BaseTy,
+                        size_t Size) {
+  ID.AddPointer(BaseTy);
+  ID.AddInteger(Size);
 }
 
 // MARK: - InOut type
@@ -45,8 +48,8 @@ bool ArrayType::isClassOf(const ArrayType *T) const {
 InOutType::InOutType(Type *BaseTy)
     : ValueType(TypeKind::InOut), BaseTy(BaseTy) {}
 
-bool InOutType::isClassOf(const InOutType *Ty) const {
-  return BaseTy->isClassOf(Ty->getBaseType());
+void InOutType::Profile(llvm::FoldingSetNodeID &ID, Type *BaseTy) {
+  ID.AddPointer(BaseTy);
 }
 
 // MARK: - Function type
@@ -54,21 +57,20 @@ bool InOutType::isClassOf(const InOutType *Ty) const {
 FunctionType::FunctionType(Type *AT, Type *RT)
     : Type(TypeKind::Function), ArgsTy(AT), RetTy(RT) {}
 
-bool FunctionType::isClassOf(const FunctionType *T) const {
-  return ArgsTy->isClassOf(T->ArgsTy) && RetTy->isClassOf(T->RetTy);
+void FunctionType::Profile(llvm::FoldingSetNodeID &ID, Type *ArgsTy,
+                           Type *RetTy) {
+  ID.AddPointer(ArgsTy);
+  ID.AddPointer(RetTy);
 }
 
 // MARK: - Pattern type
 
-PatternType::PatternType(SmallVector<Type *, 128> &&I)
+PatternType::PatternType(ArrayRef<Type *> I)
     : Type(TypeKind::Pattern), Items(I) {}
 
-bool PatternType::isClassOf(const PatternType *T) const {
-  if (Items.size() != T->Items.size())
-    return false;
-  for (size_t i = 0; i < Items.size(); i++) {
-    if (!Items[i]->isClassOf(T->Items[i]))
-      return false;
-  }
-  return true;
+void PatternType::Profile(llvm::FoldingSetNodeID &ID,
+                          ArrayRef<Type *> Items) {
+  ID.AddInteger(Items.size());
+  for (auto Item : Items)
+    ID.AddPointer(Item);
 }
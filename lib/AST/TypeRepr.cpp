@@ -23,7 +23,7 @@ CLASS##TypeRepr *TypeRepr::get##CLASS##TypeRepr() {                            \
 #include "dusk/AST/TypeReprNodes.def"
 
 void *TypeRepr::operator new(size_t Bytes, ASTContext &Context) {
-  return Context.Allocate(Bytes);
+  return Context.Allocate(Bytes, alignof(TypeRepr));
 }
 
 // MARK: - Identifier type representation
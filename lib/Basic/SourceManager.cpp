@@ -1,4 +1,4 @@
-//===--- SourceManager.cpp ------------------------------------------------===//
+//===--- SourceManager.cpp - Source buffer manager ------------------------===//
 //
 //                                 dusk-lang
 // This source file is part of a dusk-lang project, which is a semestral
@@ -8,18 +8,147 @@
 //===----------------------------------------------------------------------===//
 
 #include "dusk/Basic/SourceManager.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <algorithm>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define DUSK_SOURCE_MANAGER_USE_SSE2 1
+#endif
 
 using namespace dusk;
 
-unsigned dusk::getBufferForLoc(const llvm::SourceMgr &SM, SMLoc Loc) {
+/// Returns \c true if the character at \c Ptr terminates a line. A carriage
+/// return terminates a line on its own unless a newline follows it.
+static bool isLineTerminator(const char *Ptr, const char *End) {
+  return *Ptr == '\n' || (*Ptr == '\r' && (Ptr + 1 == End || Ptr[1] != '\n'));
+}
+
+/// Appends offsets of starts of all lines following a line terminator in
+/// buffer [Start, End) into \c Lines.
+static void collectLineStarts(const char *Start, const char *End,
+                              std::vector<uint32_t> &Lines) {
+  auto Ptr = Start;
+#if DUSK_SOURCE_MANAGER_USE_SSE2
+  // Scan 16 bytes at a time, line terminators are usually sparse.
+  auto NL = _mm_set1_epi8('\n');
+  auto CR = _mm_set1_epi8('\r');
+  for (; End - Ptr >= 16; Ptr += 16) {
+    auto Block = _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
+    unsigned Mask = _mm_movemask_epi8(
+        _mm_or_si128(_mm_cmpeq_epi8(Block, NL), _mm_cmpeq_epi8(Block, CR)));
+    while (Mask) {
+      auto Pos = Ptr + llvm::countTrailingZeros(Mask);
+      if (isLineTerminator(Pos, End))
+        Lines.push_back(Pos - Start + 1);
+      Mask &= Mask - 1;
+    }
+  }
+#endif
+  for (; Ptr != End; Ptr++)
+    if (isLineTerminator(Ptr, End))
+      Lines.push_back(Ptr - Start + 1);
+}
+
+unsigned SourceManager::getBufferForLoc(SMLoc Loc) const {
   // Validate location
   assert(Loc.isValid());
 
-  auto ptr = Loc.getPointer();
-  for (unsigned i = 1; i <= SM.getNumBuffers(); i++) {
-    auto Buff = SM.getMemoryBuffer(i);
-    if (ptr >= Buff->getBufferStart() && ptr <= Buff->getBufferEnd())
-      return i;
+  std::lock_guard<std::mutex> Guard(CacheLock);
+  // Buffers are only ever added, index the new ones.
+  if (BufferIndex.size() != getNumBuffers()) {
+    for (unsigned i = BufferIndex.size() + 1; i <= getNumBuffers(); i++) {
+      auto Buff = getMemoryBuffer(i);
+      BufferIndex.push_back({Buff->getBufferStart(), Buff->getBufferEnd(), i});
+    }
+    std::sort(BufferIndex.begin(), BufferIndex.end(),
+              [](const BufferRange &L, const BufferRange &R) {
+                return L.Start < R.Start;
+              });
   }
+
+  auto Ptr = Loc.getPointer();
+  auto It = std::upper_bound(
+      BufferIndex.begin(), BufferIndex.end(), Ptr,
+      [](const char *P, const BufferRange &R) { return P < R.Start; });
+  if (It != BufferIndex.begin() && Ptr <= (--It)->End)
+    return It->ID;
   llvm_unreachable("Location in non-existing buffer.");
 }
+
+const std::vector<uint32_t> &
+SourceManager::getLineTable(unsigned BufferID) const {
+  if (LineTables.size() < BufferID)
+    LineTables.resize(getNumBuffers());
+
+  auto &Table = LineTables[BufferID - 1];
+  if (!Table) {
+    auto Buff = getMemoryBuffer(BufferID);
+    assert(Buff->getBufferSize() < std::numeric_limits<uint32_t>::max() &&
+           "Buffer too large.");
+    Table = std::make_unique<std::vector<uint32_t>>(1, 0);
+    collectLineStarts(Buff->getBufferStart(), Buff->getBufferEnd(), *Table);
+  }
+  return *Table;
+}
+
+std::pair<unsigned, const char *>
+SourceManager::getLineStart(unsigned BufferID, SMLoc Loc) const {
+  auto BuffStart = getMemoryBuffer(BufferID)->getBufferStart();
+  uint32_t Offset = Loc.getPointer() - BuffStart;
+
+  std::lock_guard<std::mutex> Guard(CacheLock);
+  auto &Lines = getLineTable(BufferID);
+  // First line starting after the location, the table is never empty.
+  auto It = std::upper_bound(Lines.begin(), Lines.end(), Offset);
+  return {It - Lines.begin(), BuffStart + *std::prev(It)};
+}
+
+std::pair<unsigned, unsigned>
+SourceManager::getLineAndColumn(SMLoc Loc, unsigned BufferID) const {
+  if (!BufferID)
+    BufferID = getBufferForLoc(Loc);
+  auto [Line, Start] = getLineStart(BufferID, Loc);
+  return {Line, Loc.getPointer() - Start + 1};
+}
+
+SMLoc SourceManager::getLocForStartOfLine(SMLoc Loc) const {
+  // Invalid address
+  if (!Loc.isValid())
+    return Loc;
+  auto Start = getLineStart(getBufferForLoc(Loc), Loc).second;
+  return SMLoc::getFromPointer(Start);
+}
+
+SMLoc SourceManager::getLocForEndOfLine(SMLoc Loc) const {
+  // Invalid address
+  if (!Loc.isValid())
+    return Loc;
+
+  auto ID = getBufferForLoc(Loc);
+  auto Buff = getMemoryBuffer(ID);
+  auto Line = getLineStart(ID, Loc).first;
+
+  const char *End;
+  {
+    std::lock_guard<std::mutex> Guard(CacheLock);
+    auto &Lines = getLineTable(ID);
+    End = Line < Lines.size() ? Buff->getBufferStart() + Lines[Line]
+                              : Buff->getBufferEnd();
+  }
+
+  // The line ends by the carriage return of a CRLF terminator.
+  StringRef Rest(Loc.getPointer(), End - Loc.getPointer());
+  auto CR = Rest.find('\r');
+  if (CR != StringRef::npos)
+    End = Rest.data() + CR + 1;
+  return SMLoc::getFromPointer(End);
+}
+
+StringRef SourceManager::getLineForLoc(SMLoc Loc) const {
+  auto S = getLocForStartOfLine(Loc);
+  auto E = getLocForEndOfLine(Loc);
+  return {S.getPointer(), (size_t)(E.getPointer() - S.getPointer())};
+}
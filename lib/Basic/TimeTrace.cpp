@@ -0,0 +1,211 @@
+//===--- TimeTrace.cpp - Time trace of the compiler -----------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Basic/TimeTrace.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace dusk;
+using namespace detail;
+
+using Clock = std::chrono::steady_clock;
+using Microseconds = std::chrono::microseconds;
+
+namespace {
+
+/// A scope of the trace.
+struct Entry {
+  Clock::time_point Start;
+  Clock::duration Duration;
+  std::string Name;
+  std::string Detail;
+  unsigned ThreadID;
+
+  Entry(StringRef Name, StringRef Detail, unsigned ThreadID)
+      : Start(Clock::now()), Duration(0), Name(Name), Detail(Detail),
+        ThreadID(ThreadID) {}
+};
+
+/// Total time spent in scopes of a single name.
+struct Total {
+  Clock::duration Duration{0};
+  unsigned Count = 0;
+};
+
+/// Scopes opened by a single thread.
+struct ThreadState {
+  std::vector<Entry> Stack;
+  unsigned ThreadID;
+
+  ThreadState();
+};
+
+} // anonymous namespace
+
+namespace dusk {
+namespace detail {
+
+struct TimeTracer {
+  const Clock::time_point StartTime;
+  const Clock::duration Granularity;
+
+  std::mutex Lock;
+  std::vector<Entry> Entries;
+  llvm::StringMap<Total> Totals;
+
+  TimeTracer(unsigned Granularity)
+      : StartTime(Clock::now()), Granularity(Microseconds(Granularity)) {}
+};
+
+TimeTracer *TimeTracerInstance = nullptr;
+
+} // namespace detail
+} // namespace dusk
+
+/// Threads are numbered in order they open their first scope.
+static std::atomic<unsigned> NextThreadID(1);
+
+ThreadState::ThreadState() : ThreadID(NextThreadID++) {}
+
+static ThreadState &getThreadState() {
+  thread_local ThreadState State;
+  return State;
+}
+
+void dusk::timeTraceInitialize(unsigned Granularity) {
+  assert(!TimeTracerInstance && "Time trace is already being recorded.");
+  TimeTracerInstance = new TimeTracer(Granularity);
+}
+
+void dusk::timeTraceCleanup() {
+  delete TimeTracerInstance;
+  TimeTracerInstance = nullptr;
+}
+
+void dusk::timeTraceBegin(StringRef Name, StringRef Detail) {
+  if (!TimeTracerInstance)
+    return;
+  auto &State = getThreadState();
+  State.Stack.emplace_back(Name, Detail, State.ThreadID);
+}
+
+void dusk::timeTraceEnd() {
+  if (!TimeTracerInstance)
+    return;
+  auto &Stack = getThreadState().Stack;
+  assert(!Stack.empty() && "Time trace scope was not opened.");
+  auto &E = Stack.back();
+  E.Duration = Clock::now() - E.Start;
+
+  // Only the outermost scope of a name contributes to the total.
+  auto IsNested = std::any_of(Stack.begin(), Stack.end() - 1,
+                              [&](const Entry &O) { return O.Name == E.Name; });
+
+  auto &T = *TimeTracerInstance;
+  {
+    std::lock_guard<std::mutex> Guard(T.Lock);
+    if (!IsNested) {
+      auto &Tot = T.Totals[E.Name];
+      Tot.Duration += E.Duration;
+      Tot.Count++;
+    }
+    if (E.Duration >= T.Granularity)
+      T.Entries.push_back(std::move(E));
+  }
+  Stack.pop_back();
+}
+
+/// Returns \c D in microseconds.
+static int64_t toMicroseconds(Clock::duration D) {
+  return std::chrono::duration_cast<Microseconds>(D).count();
+}
+
+void dusk::timeTraceWrite(raw_ostream &OS) {
+  assert(TimeTracerInstance && "Time trace is not being recorded.");
+  auto &T = *TimeTracerInstance;
+  std::lock_guard<std::mutex> Guard(T.Lock);
+
+  llvm::json::Array Events;
+  unsigned NumThreads = 0;
+  for (auto &E : T.Entries) {
+    llvm::json::Object Event{
+        {"pid", 1},
+        {"tid", int64_t(E.ThreadID)},
+        {"ph", "X"},
+        {"ts", toMicroseconds(E.Start - T.StartTime)},
+        {"dur", toMicroseconds(E.Duration)},
+        {"name", E.Name}};
+    if (!E.Detail.empty())
+      Event["args"] = llvm::json::Object{{"detail", E.Detail}};
+    Events.push_back(std::move(Event));
+    NumThreads = std::max(NumThreads, E.ThreadID);
+  }
+
+  // Name the process and its threads in viewers.
+  Events.push_back(llvm::json::Object{
+      {"pid", 1},
+      {"tid", 0},
+      {"ph", "M"},
+      {"name", "process_name"},
+      {"args", llvm::json::Object{{"name", "duskc"}}}});
+  for (unsigned i = 1; i <= NumThreads; i++)
+    Events.push_back(llvm::json::Object{
+        {"pid", 1},
+        {"tid", int64_t(i)},
+        {"ph", "M"},
+        {"name", "thread_name"},
+        {"args", llvm::json::Object{{"name", "thread " + std::to_string(i)}}}});
+
+  OS << llvm::json::Value(llvm::json::Object{{"traceEvents", std::move(Events)},
+                                             {"displayTimeUnit", "ms"}});
+  OS << "\n";
+}
+
+void dusk::timeTracePrintReport(raw_ostream &OS) {
+  assert(TimeTracerInstance && "Time trace is not being recorded.");
+  auto &T = *TimeTracerInstance;
+  std::lock_guard<std::mutex> Guard(T.Lock);
+
+  std::vector<std::pair<StringRef, Total>> Totals;
+  for (auto &E : T.Totals)
+    Totals.emplace_back(E.getKey(), E.getValue());
+  std::sort(Totals.begin(), Totals.end(), [](const auto &L, const auto &R) {
+    return L.second.Duration > R.second.Duration;
+  });
+
+  auto toSeconds = [](Clock::duration D) {
+    return std::chrono::duration<double>(D).count();
+  };
+  auto Wall = toSeconds(Clock::now() - T.StartTime);
+
+  OS << "===" << std::string(73, '-') << "===\n";
+  OS << "                          Dusk compilation time report\n";
+  OS << "===" << std::string(73, '-') << "===\n";
+  OS << llvm::format("  Total Execution Time: %.4f seconds (wall clock)\n\n",
+                     Wall);
+  OS << "   ---Wall Time---  ---Count---  --- Name ---\n";
+  for (auto &E : Totals) {
+    auto Time = toSeconds(E.second.Duration);
+    OS << llvm::format("  %8.4f (%5.1f%%)  %11u  ", Time,
+                       Wall > 0 ? Time / Wall * 100 : 0.0, E.second.Count)
+       << E.first << "\n";
+  }
+  OS << "\n";
+}
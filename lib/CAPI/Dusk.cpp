@@ -0,0 +1,186 @@
+//===--- Dusk.cpp - C interface for embedding dusk ------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk-c/Dusk.h"
+
+#include "dusk/AST/Decl.h"
+#include "dusk/AST/Stmt.h"
+#include "dusk/Frontend/CompilationCache.h"
+#include "dusk/Frontend/CompilerInstance.h"
+#include "dusk/Frontend/CompilerInvocation.h"
+#include "dusk/Frontend/DuskJIT.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dusk;
+
+struct DuskOpaqueContext {
+  OptLevel OptLvl = OptLevel::O0;
+  std::string TargetCPU = "generic";
+  std::string CachePath;
+  uint64_t CacheSizeLimit = 0;
+  std::vector<std::string> ImportPaths;
+
+  /// Host functions defined in every compiled module.
+  llvm::StringMap<DuskFunction> Functions;
+
+  /// Diagnostics of the last failed compilation.
+  std::string Error;
+};
+
+struct DuskOpaqueModule {
+  std::unique_ptr<DuskJIT> JIT;
+
+  /// Addresses of all functions defined by the module.
+  llvm::StringMap<DuskFunction> Functions;
+};
+
+/// Returns an invocation compiling \c Source named \c Name with
+/// configuration of \c C.
+static CompilerInvocation createInvocation(DuskOpaqueContext &C,
+                                           CompilerInstance &Compiler,
+                                           StringRef Name, StringRef Source) {
+  CompilerInvocation Inv;
+  Inv.setInputBuffer(Compiler.getSourceManager(), Name, Source);
+  Inv.setOptLevel(C.OptLvl);
+  Inv.setTargetCPU(C.TargetCPU);
+  if (!C.CachePath.empty())
+    Inv.setCache(C.CachePath, C.CacheSizeLimit);
+  for (auto &P : C.ImportPaths)
+    Inv.addImportPath(P);
+  return Inv;
+}
+
+/// Compiles and links module \c Source, reports errors into \c OS.
+static std::unique_ptr<DuskOpaqueModule>
+compileModule(DuskOpaqueContext &C, StringRef Name, StringRef Source,
+              raw_ostream &OS) {
+  CompilerInstance Compiler(OS);
+  auto Inv = createInvocation(C, Compiler, Name, Source);
+  auto JIT = DuskJIT::create(Inv);
+  if (!JIT) {
+    OS << toString(JIT.takeError()) << "\n";
+    return nullptr;
+  }
+  Compiler.reset(std::move(Inv));
+
+  auto Object = Compiler.performInMemoryCompilation();
+  if (!Object)
+    return nullptr;
+
+  auto Reported = [&OS](llvm::Error E) {
+    if (!E)
+      return false;
+    OS << toString(std::move(E)) << "\n";
+    return true;
+  };
+  // Undefined symbols are reported by the session rather than by a lookup.
+  (*JIT)->setErrorReporter(
+      [&OS](llvm::Error E) { OS << toString(std::move(E)) << "\n"; });
+  for (auto &F : C.Functions)
+    if (Reported((*JIT)->defineSymbol(
+            F.first(), llvm::pointerToJITTargetAddress(F.second))))
+      return nullptr;
+  for (auto &Obj : Compiler.getImportedObjectFiles())
+    if (Reported((*JIT)->addObjectFile(Obj)))
+      return nullptr;
+  if (Reported((*JIT)->addObject(std::move(Object))))
+    return nullptr;
+
+  // Functions are resolved right away, so that undefined extern functions
+  // are reported by the compilation rather than by a later lookup.
+  auto M = std::make_unique<DuskOpaqueModule>();
+  for (auto N : Compiler.getModule()->getContents()) {
+    auto S = dynamic_cast<FuncStmt *>(N);
+    if (!S)
+      continue;
+    auto FnName = S->getPrototype()->getName();
+    auto Addr = (*JIT)->lookup(FnName);
+    if (!Addr) {
+      Reported(Addr.takeError());
+      return nullptr;
+    }
+    M->Functions[FnName] = llvm::jitTargetAddressToPointer<DuskFunction>(*Addr);
+  }
+  // Everything is linked, the stream does not outlive the compilation.
+  (*JIT)->setErrorReporter(
+      [](llvm::Error E) { llvm::consumeError(std::move(E)); });
+  M->JIT = std::move(*JIT);
+  return M;
+}
+
+unsigned DuskGetAPIVersion(void) { return DUSK_C_API_VERSION; }
+
+DuskContextRef DuskContextCreate(void) { return new DuskOpaqueContext(); }
+
+void DuskContextDispose(DuskContextRef C) { delete C; }
+
+void DuskSetOptLevel(DuskContextRef C, DuskOptLevel L) {
+  switch (L) {
+  case DuskOptLevelO0:
+    C->OptLvl = OptLevel::O0;
+    break;
+  case DuskOptLevelO1:
+    C->OptLvl = OptLevel::O1;
+    break;
+  case DuskOptLevelO2:
+    C->OptLvl = OptLevel::O2;
+    break;
+  case DuskOptLevelO3:
+    C->OptLvl = OptLevel::O3;
+    break;
+  case DuskOptLevelOs:
+    C->OptLvl = OptLevel::Os;
+    break;
+  }
+}
+
+void DuskSetTargetCPU(DuskContextRef C, const char *CPU) {
+  C->TargetCPU = CPU;
+}
+
+void DuskSetCache(DuskContextRef C, const char *Path, uint64_t SizeLimit) {
+  C->CachePath = Path;
+  C->CacheSizeLimit =
+      SizeLimit != 0 ? SizeLimit : CompilationCache::DefaultMaxSize;
+}
+
+void DuskAddImportPath(DuskContextRef C, const char *Path) {
+  C->ImportPaths.push_back(Path);
+}
+
+void DuskAddFunction(DuskContextRef C, const char *Name, DuskFunction Fn) {
+  C->Functions[Name] = Fn;
+}
+
+DuskModuleRef DuskCompileModule(DuskContextRef C, const char *Name,
+                                const char *Source, size_t Size) {
+  C->Error.clear();
+  llvm::raw_string_ostream OS(C->Error);
+  auto M = compileModule(*C, Name && *Name ? Name : "<module>",
+                         StringRef(Source, Size), OS);
+  OS.flush();
+  return M.release();
+}
+
+const char *DuskGetErrorMessage(DuskContextRef C) { return C->Error.c_str(); }
+
+DuskFunction DuskGetFunction(DuskModuleRef M, const char *Name) {
+  auto It = M->Functions.find(Name);
+  if (It == M->Functions.end())
+    return nullptr;
+  return It->second;
+}
+
+void DuskModuleDispose(DuskModuleRef M) { delete M; }
@@ -0,0 +1,302 @@
+//===--- CompilationCache.cpp ---------------------------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Frontend/CompilationCache.h"
+#include "dusk/AST/ASTWalker.h"
+#include "dusk/AST/Decl.h"
+#include "dusk/AST/Expr.h"
+#include "dusk/AST/Stmt.h"
+#include "dusk/AST/Type.h"
+#include "dusk/Frontend/CompilerInvocation.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Support/CachePruning.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA1.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+
+#ifndef DUSK_VERSION
+#define DUSK_VERSION "unknown"
+#endif
+
+using namespace dusk;
+
+/// Prefix of cache entries, the only files \c llvm::pruneCache considers.
+static const char *EntryPrefix = "llvmcache-";
+
+namespace {
+
+/// Hashes a sequence of fields into a cache key.
+class KeyHasher {
+  llvm::SHA1 Hasher;
+
+public:
+  /// Adds a field to the key. Fields are separated, so that no two distinct
+  /// sequences of fields hash the same sequence of bytes.
+  void add(StringRef Field) {
+    Hasher.update(Field);
+    Hasher.update(StringRef("\0", 1));
+  }
+
+  /// Adds code generation options of invocation \c Inv.
+  void addCodegenOptions(const CompilerInvocation &Inv) {
+    add("dusk-" DUSK_VERSION);
+    add("llvm-" LLVM_VERSION_STRING);
+    add(Inv.getTargetTriple());
+    add(Inv.getTargetCPU());
+    add(Inv.getTargetFeatures());
+    add(llvm::utostr(static_cast<unsigned>(Inv.getOptLevel())));
+    // Objects loaded by DuskJIT are generated with a different relocation
+    // and code model than the ones linked into executables.
+    auto RM = Inv.getRelocModel();
+    add(RM ? llvm::utostr(static_cast<unsigned>(*RM)) : "");
+    auto CM = Inv.getCodeModel();
+    add(CM ? llvm::utostr(static_cast<unsigned>(*CM)) : "");
+  }
+
+  /// Adds structure of type \c Ty.
+  void addType(Type *Ty) {
+    if (!Ty)
+      return add("");
+    add(llvm::utostr(static_cast<unsigned>(Ty->getKind())));
+    if (auto ATy = dynamic_cast<ArrayType *>(Ty)) {
+      add(llvm::utostr(ATy->getSize()));
+      addType(ATy->getBaseType());
+    } else if (auto IOTy = dynamic_cast<InOutType *>(Ty)) {
+      addType(IOTy->getBaseType());
+    } else if (auto FTy = dynamic_cast<FunctionType *>(Ty)) {
+      addType(FTy->getArgsType());
+      addType(FTy->getRetType());
+    } else if (auto PTy = dynamic_cast<PatternType *>(Ty)) {
+      add(llvm::utostr(PTy->getItems().size()));
+      for (auto I : PTy->getItems())
+        addType(I);
+    }
+  }
+
+  std::string getKey() { return llvm::toHex(Hasher.final()); }
+};
+
+/// Collects declarations and constant values referenced by a function body
+/// or a global declaration.
+class ReferenceCollector : public ASTWalker {
+public:
+  llvm::SetVector<Decl *> Refs;
+
+  /// Values of all integer literals. Sema replaces references to constants
+  /// by their values, which are therefore not part of the source text.
+  std::string Literals;
+
+  std::pair<bool, Expr *> preWalkExpr(Expr *E) override {
+    if (auto Lit = dynamic_cast<NumberLiteralExpr *>(E)) {
+      Literals += llvm::itostr(Lit->getValue());
+      Literals += ',';
+    } else if (auto Ident = dynamic_cast<IdentifierExpr *>(E)) {
+      if (Ident->getDecl())
+        Refs.insert(Ident->getDecl());
+    } else if (auto Call = dynamic_cast<CallExpr *>(E)) {
+      if (Call->getCalleeDecl())
+        Refs.insert(Call->getCalleeDecl());
+    }
+    return {true, E};
+  }
+};
+
+/// Adds declarations and constants referenced by node \c N to the key.
+void addReferences(KeyHasher &Hasher, ASTNode *N,
+                   const llvm::DenseMap<Decl *, StringRef> &DeclText) {
+  ReferenceCollector Collector;
+  N->walk(Collector);
+  Hasher.add(Collector.Literals);
+  for (auto D : Collector.Refs) {
+    // Imported declarations have no source text, only their signature
+    // affects the generated code.
+    if (D->isImported()) {
+      Hasher.add(D->getName());
+      Hasher.addType(D->getType());
+      continue;
+    }
+    auto It = DeclText.find(D);
+    // Locals are part of the function text.
+    if (It == DeclText.end())
+      continue;
+    Hasher.add(D->getName());
+    Hasher.add(It->second);
+  }
+}
+
+} // anonymous namespace
+
+std::string CompilationCache::computeKey(const CompilerInvocation &Inv) {
+  KeyHasher Hasher;
+  Hasher.add("module");
+  Hasher.addCodegenOptions(Inv);
+  // Partitioning of the module changes the layout of the object file.
+  Hasher.add(llvm::utostr(Inv.getCodegenJobs()));
+  Hasher.add(Inv.isPipelined() ? "pipelined" : "");
+  Hasher.add(Inv.isStreaming() ? "streaming" : "");
+  Hasher.add(Inv.getInputFile()->buffer()->getBuffer());
+  return Hasher.getKey();
+}
+
+std::string CompilationCache::getEntryPath(StringRef Key) const {
+  SmallString<128> Entry(Path);
+  llvm::sys::path::append(Entry, EntryPrefix + Key);
+  return Entry.str().str();
+}
+
+bool CompilationCache::touchEntry(StringRef Entry) {
+  int FD;
+  if (llvm::sys::fs::openFileForRead(Entry, FD))
+    return false;
+  // Eviction is based on access times, which are not updated by every file
+  // system.
+  llvm::sys::fs::setLastModificationAndAccessTime(
+      FD, std::chrono::system_clock::now());
+  llvm::sys::fs::closeFile(FD);
+  return true;
+}
+
+bool CompilationCache::lookup(StringRef Key, StringRef Dest) {
+  auto Entry = getEntryPath(Key);
+  // The entry may have been evicted in the meantime.
+  if (!touchEntry(Entry) || llvm::sys::fs::copy_file(Entry, Dest)) {
+    getStatistics().Misses++;
+    return false;
+  }
+  getStatistics().Hits++;
+  return true;
+}
+
+std::unique_ptr<llvm::MemoryBuffer> CompilationCache::lookup(StringRef Key) {
+  auto Entry = getEntryPath(Key);
+  if (!touchEntry(Entry)) {
+    getStatistics().Misses++;
+    return nullptr;
+  }
+  // Entries are replaced by renaming, never written in place, therefore
+  // the file may be mapped.
+  auto Buffer = llvm::MemoryBuffer::getFile(Entry);
+  if (!Buffer) {
+    getStatistics().Misses++;
+    return nullptr;
+  }
+  getStatistics().Hits++;
+  return std::move(*Buffer);
+}
+
+bool CompilationCache::store(StringRef Key, StringRef Src) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Src);
+  if (!Buffer)
+    return false;
+  return store(Key, (*Buffer)->getMemBufferRef());
+}
+
+bool CompilationCache::store(StringRef Key, llvm::MemoryBufferRef Object) {
+  if (llvm::sys::fs::create_directories(Path))
+    return false;
+
+  // Entry is written under a temporary name, which pruning ignores, and
+  // atomically renamed into place. Concurrent readers never observe
+  // a partially written entry.
+  SmallString<128> Model(Path);
+  llvm::sys::path::append(Model, "tmp-%%%%%%%%%%%%.o");
+  auto Temp = llvm::sys::fs::TempFile::create(Model);
+  if (!Temp) {
+    llvm::consumeError(Temp.takeError());
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream OS(Temp->FD, /*shouldClose=*/false);
+    OS << Object.getBuffer();
+  }
+  if (auto Err = Temp->keep(getEntryPath(Key))) {
+    llvm::consumeError(std::move(Err));
+    llvm::consumeError(Temp->discard());
+    return false;
+  }
+  getStatistics().Stores++;
+  prune();
+  return true;
+}
+
+void CompilationCache::prune() {
+  llvm::CachePruningPolicy Policy;
+  Policy.MaxSizeBytes = MaxSize;
+  // Scan the directory at most once a minute across all compilers.
+  Policy.Interval = std::chrono::seconds(60);
+  llvm::pruneCache(Path, Policy);
+}
+
+CompilationCache::Statistics &CompilationCache::getStatistics() {
+  static Statistics Stats;
+  return Stats;
+}
+
+// MARK: - Module cache keys
+
+ModuleCacheKeys::ModuleCacheKeys(const CompilerInvocation &Inv, ModuleDecl *M)
+    : Inv(Inv) {
+  // Text of a function ends with the closing brace of its body. Source ranges
+  // of other nodes do not cover their last token, their text spans up to
+  // the start of the following node.
+  auto Contents = M->getContents();
+  auto BufferEnd = Inv.getInputFile()->buffer()->getBufferEnd();
+  for (size_t i = 0, e = Contents.size(); i < e; i++) {
+    auto Start = Contents[i]->getLocStart().getPointer();
+    auto End = i + 1 < e ? Contents[i + 1]->getLocStart().getPointer()
+                         : BufferEnd;
+    if (auto FS = dynamic_cast<FuncStmt *>(Contents[i]))
+      if (auto BodyEnd = FS->getLocEnd().getPointer())
+        End = BodyEnd + 1;
+    if (!Start || !End || End < Start)
+      continue;
+    StringRef Text(Start, End - Start);
+
+    if (auto FS = dynamic_cast<FuncStmt *>(Contents[i])) {
+      FuncText[FS] = Text;
+      auto BodyStart = FS->getBody() ? FS->getBody()->getLocStart().getPointer()
+                                     : End;
+      DeclText[FS->getPrototype()] = StringRef(Start, BodyStart - Start);
+    } else if (auto ES = dynamic_cast<ExternStmt *>(Contents[i])) {
+      DeclText[ES->getPrototype()] = Text;
+    } else if (auto D = dynamic_cast<ValDecl *>(Contents[i])) {
+      Globals.push_back(D);
+      DeclText[D] = Text;
+      GlobalsText += Text;
+      GlobalsText += '\0';
+    }
+  }
+}
+
+std::string ModuleCacheKeys::getFuncKey(FuncStmt *S) const {
+  KeyHasher Hasher;
+  Hasher.add("function");
+  Hasher.addCodegenOptions(Inv);
+  Hasher.add(FuncText.lookup(S));
+  addReferences(Hasher, S, DeclText);
+  return Hasher.getKey();
+}
+
+std::string ModuleCacheKeys::getGlobalsKey() const {
+  KeyHasher Hasher;
+  Hasher.add("globals");
+  Hasher.addCodegenOptions(Inv);
+  Hasher.add(GlobalsText);
+  for (auto D : Globals)
+    addReferences(Hasher, D, DeclText);
+  return Hasher.getKey();
+}
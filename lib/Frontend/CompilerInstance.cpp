@@ -10,31 +10,61 @@
 #include "dusk/Frontend/CompilerInstance.h"
 
 #include "dusk/AST/Diagnostics.h"
+#include "dusk/AST/Stmt.h"
+#include "dusk/Basic/BoundedQueue.h"
+#include "dusk/Basic/TimeTrace.h"
+#include "dusk/Frontend/CompilationCache.h"
+#include "dusk/Frontend/DuskJIT.h"
+#include "dusk/Frontend/Linker.h"
+#include "dusk/Interpreter/Interpreter.h"
 #include "dusk/Parse/Parser.h"
 #include "dusk/Runtime/RuntimeFuncs.h"
 #include "dusk/Sema/Sema.h"
+#include "dusk/Serialization/Serialization.h"
+#include "dusk/Serialization/SerializedModuleLoader.h"
 #include "dusk/IRGen/IRGenerator.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IR/Type.h"
 #include "llvm/IR/Verifier.h"
+#include "llvm/IR/PassInstrumentation.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/IR/LegacyPassManager.h"
+#include "llvm/ADT/Any.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/CodeGen/ParallelCG.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Support/CodeGen.h"
 #include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/TargetRegistry.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Target/TargetMachine.h"
 #include "llvm/Target/TargetOptions.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 using namespace dusk;
 
-CompilerInstance::CompilerInstance() {
+CompilerInstance::CompilerInstance() : CompilerInstance(llvm::errs()) {}
+
+CompilerInstance::CompilerInstance(raw_ostream &OS) : OS(OS) {
   if (!Invocation.isQuiet())
     Diag.addConsumer(this);
 }
 
+CompilerInstance::~CompilerInstance() = default;
+
 ModuleDecl *CompilerInstance::getModule() {
   if (hasASTContext() && !Context->isError())
     return MainModule;
@@ -46,19 +76,84 @@ SourceFile *CompilerInstance::getInputFile() {
   return Invocation.getInputFile();
 }
 
+std::vector<std::string> CompilerInstance::getImportedObjectFiles() const {
+  if (!Loader)
+    return {};
+  return Loader->getObjectFiles();
+}
+
 void CompilerInstance::performCompilation() {
+  // Objects of modules are linked into executables as well as loaded by
+  // DuskJIT when an importing program is run, hence they are compiled to be
+  // loadable anywhere in memory.
+  if (!Invocation.getModuleInterfaceFile().empty())
+    DuskJIT::setUpInvocation(Invocation);
+
+  // Cache provides only the object file, not the printed IR. The interface
+  // is written from the AST, which a hit of the whole object skips.
+  if (Invocation.getCachePath().empty() || Invocation.printIR())
+    performUncachedCompilation();
+  else if (Invocation.isIncremental())
+    performIncrementalCompilation();
+  else if (!Invocation.getModuleInterfaceFile().empty())
+    performUncachedCompilation();
+  else
+    performCachedCompilation();
+
+  if (Context->isError() || Invocation.getModuleInterfaceFile().empty())
+    return;
+  if (!emitModuleInterface())
+    Context->setError();
+}
+
+void CompilerInstance::performCachedCompilation() {
+  CompilationCache Cache(Invocation.getCachePath(),
+                         Invocation.getCacheSizeLimit());
+  auto Key = CompilationCache::computeKey(Invocation);
+  if (Cache.lookup(Key, Invocation.getObjectFile())) {
+    // Nothing is parsed, the context only reports a successful compilation.
+    Context = std::make_unique<ASTContext>();
+    MainModule = nullptr;
+    Loader.reset();
+    return;
+  }
+
+  performUncachedCompilation();
+  if (!Context->isError() && !Loader->hasLoadedModules())
+    Cache.store(Key, Invocation.getObjectFile());
+}
+
+void CompilerInstance::setUpModuleLoader(sema::Sema &S) {
+  // Modules next to the input file are found first.
+  std::vector<std::string> Paths;
+  Paths.push_back(
+      llvm::sys::path::parent_path(Invocation.getInputFile()->file()).str());
+  if (Paths.back().empty())
+    Paths.back() = ".";
+  for (auto &P : Invocation.getImportPaths())
+    Paths.push_back(P);
+
+  Loader = std::make_unique<SerializedModuleLoader>(*Context, std::move(Paths));
+  S.setModuleLoader(Loader.get());
+}
+
+bool CompilerInstance::emitModuleInterface() {
+  return serializeModule(MainModule, Invocation.getModuleInterfaceFile(),
+                         Invocation.getObjectFile(), OS);
+}
+
+void CompilerInstance::performUncachedCompilation() {
+  if (Invocation.isStreaming())
+    return performStreamingCompilation();
+  if (Invocation.isPipelined())
+    return performPipelinedCompilation();
   performSema();
   if (Context->isError())
     return;
   irgen::IRGenerator Gen(*Context);
-  auto M = Gen.perform();
-  
-  if (Invocation.printIR()) {
-    M->print(llvm::errs(), nullptr);
-    llvm::errs() << "\n";
-  }
-
-  emitObjectFile(M);
+  std::unique_ptr<llvm::Module> M(Gen.perform());
+  if (!emitObjectFile(std::move(M)))
+    Context->setError();
 }
 
 void CompilerInstance::performSema() {
@@ -66,78 +161,823 @@ void CompilerInstance::performSema() {
   if (Context->isError())
     return;
   getFuncs(*Context);
-  sema::Sema S(*Context, Diag);
+  sema::Sema S(*Context, Diag, Invocation.getSemaJobs());
+  setUpModuleLoader(S);
   S.perform();
 }
 
 void CompilerInstance::performParseOnly() {
+  Loader.reset();
   Context = std::make_unique<ASTContext>();
   auto InputFile = Invocation.getInputFile();
-  Parser P(*Context, SourceManager, *InputFile, Diag, InputFile->bufferID());
+  std::unique_ptr<TokenStream> Tokens;
+  if (Invocation.getLexingMode() != LexingMode::OnDemand)
+    Tokens = std::make_unique<TokenStream>(
+        SourceManager, InputFile->bufferID(),
+        Invocation.getLexingMode() == LexingMode::Threaded);
+  Parser P(*Context, SourceManager, *InputFile, Diag, InputFile->bufferID(),
+           Tokens.get());
   MainModule = P.parseModule();
   Context->setRootModule(MainModule);
 }
 
-void CompilerInstance::freeContext() { Context.reset(); }
+void CompilerInstance::freeContext() {
+  Loader.reset();
+  Context.reset();
+}
 
 void CompilerInstance::reset(CompilerInvocation &&I) {
   Invocation = std::move(I);
   MainModule = nullptr;
   freeContext();
+
+  // Honor quiet mode of the new invocation.
+  Diag.takeConsumers();
+  if (!Invocation.isQuiet())
+    Diag.addConsumer(this);
 }
 
 void CompilerInstance::consume(SMDiagnostic &Diagnostic) {
-  Diagnostic.print("duskc", llvm::errs());
+  Diagnostic.print("duskc", OS);
 }
 
-void CompilerInstance::emitObjectFile(llvm::Module *M) {
-  llvm::InitializeAllTargetInfos();
-  llvm::InitializeAllTargets();
-  llvm::InitializeAllTargetMCs();
-  llvm::InitializeAllAsmParsers();
-  llvm::InitializeAllAsmPrinters();
+/// Registers all targets. Safe to be called from multiple threads, the
+/// registration is performed only once per process.
+static void initializeTargets() {
+  static std::once_flag Flag;
+  std::call_once(Flag, [] {
+    llvm::InitializeAllTargetInfos();
+    llvm::InitializeAllTargets();
+    llvm::InitializeAllTargetMCs();
+    llvm::InitializeAllAsmParsers();
+    llvm::InitializeAllAsmPrinters();
+  });
+}
 
-  std::string Err;
-  auto Target =
-      llvm::TargetRegistry::lookupTarget(Invocation.getTargetTriple(), Err);
+/// Returns code generator optimization level matching \c L.
+static llvm::CodeGenOpt::Level getCodeGenOptLevel(OptLevel L) {
+  switch (L) {
+  case OptLevel::O0:
+    return llvm::CodeGenOpt::None;
+  case OptLevel::O1:
+    return llvm::CodeGenOpt::Less;
+  case OptLevel::O2:
+  case OptLevel::Os:
+    return llvm::CodeGenOpt::Default;
+  case OptLevel::O3:
+    return llvm::CodeGenOpt::Aggressive;
+  }
+  llvm_unreachable("Invalid optimization level");
+}
+
+/// Creates a new target machine for the target triple, CPU, features,
+/// relocation and code model and optimization level of \c Inv.
+static std::unique_ptr<llvm::TargetMachine>
+createTargetMachine(const CompilerInvocation &Inv, std::string &Err) {
+  initializeTargets();
+  auto Triple = Inv.getTargetTriple();
+  auto Target = llvm::TargetRegistry::lookupTarget(Triple.str(), Err);
+  if (!Target)
+    return nullptr;
+
+  llvm::TargetOptions Opt;
+  return std::unique_ptr<llvm::TargetMachine>(Target->createTargetMachine(
+      Triple, Inv.getTargetCPU(), Inv.getTargetFeatures(), Opt,
+      Inv.getRelocModel(), Inv.getCodeModel(),
+      getCodeGenOptLevel(Inv.getOptLevel())));
+}
+
+/// \brief Returns a target machine for the target configuration of \c Inv.
+///
+/// Creating a target machine is expensive, therefore machines are cached and
+/// reused by all compilations running on the same thread. Target machines
+/// are not thread-safe, hence the cache is not shared between threads.
+static llvm::TargetMachine *getTargetMachine(const CompilerInvocation &Inv,
+                                             std::string &Err) {
+  thread_local llvm::StringMap<std::unique_ptr<llvm::TargetMachine>> Machines;
+  auto RM = Inv.getRelocModel();
+  auto CM = Inv.getCodeModel();
+  auto Key = (Inv.getTargetTriple() + "/" + Inv.getTargetCPU() + "/" +
+              Inv.getTargetFeatures() + "/O" +
+              Twine(static_cast<unsigned>(Inv.getOptLevel())) + "/R" +
+              (RM ? Twine(static_cast<unsigned>(*RM)) : Twine("-")) + "/C" +
+              (CM ? Twine(static_cast<unsigned>(*CM)) : Twine("-")))
+                 .str();
+  auto &TM = Machines[Key];
+  if (!TM)
+    TM = createTargetMachine(Inv, Err);
+  return TM.get();
+}
+
+/// \brief Sets target CPU and features of \c TM as attributes of all
+/// functions defined in \c M.
+///
+/// Optimizations consult the attributes rather than the target machine,
+/// e.g. vectorizers use them to pick available instructions and their cost.
+static void setFunctionAttributes(llvm::TargetMachine &TM, llvm::Module &M) {
+  auto CPU = TM.getTargetCPU();
+  auto Features = TM.getTargetFeatureString();
+  for (auto &F : M) {
+    if (F.isDeclaration())
+      continue;
+    F.addFnAttr("target-cpu", CPU);
+    if (!Features.empty())
+      F.addFnAttr("target-features", Features);
+  }
+}
+
+/// Returns name of the IR unit \c IR, which a pass of the optimization
+/// pipeline runs on.
+static std::string getIRUnitName(llvm::Any IR) {
+  if (llvm::any_isa<const llvm::Module *>(IR))
+    return llvm::any_cast<const llvm::Module *>(IR)->getName().str();
+  if (llvm::any_isa<const llvm::Function *>(IR))
+    return llvm::any_cast<const llvm::Function *>(IR)->getName().str();
+  if (llvm::any_isa<const llvm::Loop *>(IR))
+    return llvm::any_cast<const llvm::Loop *>(IR)
+        ->getHeader()
+        ->getParent()
+        ->getName()
+        .str();
+  return "";
+}
 
-  if (!Target) {
-    llvm::errs() << Err;
+/// \brief Records a time trace scope of every pass run by a pass builder
+/// \c PIC is registered with.
+///
+/// Passes deleting the loop they run on are not reported as finished, their
+/// scopes are closed along with the enclosing pass.
+static void registerTimeTraceCallbacks(llvm::PassInstrumentationCallbacks &PIC,
+                                       std::vector<std::string> &Passes) {
+  PIC.registerBeforePassCallback([&Passes](StringRef P, llvm::Any IR) {
+    Passes.push_back(P.str());
+    timeTraceBegin(P, getIRUnitName(IR));
+    return true;
+  });
+  PIC.registerAfterPassCallback([&Passes](StringRef P, llvm::Any IR) {
+    while (!Passes.empty()) {
+      auto Name = std::move(Passes.back());
+      Passes.pop_back();
+      timeTraceEnd();
+      if (Name == P)
+        break;
+    }
+  });
+}
+
+/// \brief Runs the default optimization pipeline of level \c L on \c M.
+///
+/// Does nothing at \c OptLevel::O0, the module is passed to code generation
+/// as emitted.
+static void optimizeModule(llvm::TargetMachine &TM, llvm::Module &M,
+                           OptLevel L) {
+  llvm::PassBuilder::OptimizationLevel Level;
+  switch (L) {
+  case OptLevel::O0:
     return;
+  case OptLevel::O1:
+    Level = llvm::PassBuilder::OptimizationLevel::O1;
+    break;
+  case OptLevel::O2:
+    Level = llvm::PassBuilder::OptimizationLevel::O2;
+    break;
+  case OptLevel::O3:
+    Level = llvm::PassBuilder::OptimizationLevel::O3;
+    break;
+  case OptLevel::Os:
+    Level = llvm::PassBuilder::OptimizationLevel::Os;
+    break;
   }
 
-  auto CPU = "generic";
-  auto Features = "";
-  llvm::TargetOptions Opt;
-  auto RM = Optional<llvm::Reloc::Model>();
-  auto TargetMachine = Target->createTargetMachine(Invocation.getTargetTriple(),
-                                                   CPU, Features, Opt, RM);
+  TimeTraceScope Trace("Optimize", M.getName());
+  llvm::PassInstrumentationCallbacks PIC;
+  std::vector<std::string> Passes;
+  if (isTimeTraceEnabled())
+    registerTimeTraceCallbacks(PIC, Passes);
+
+  llvm::PassBuilder PB(&TM, llvm::None, &PIC);
+  llvm::LoopAnalysisManager LAM;
+  llvm::FunctionAnalysisManager FAM;
+  llvm::CGSCCAnalysisManager CGAM;
+  llvm::ModuleAnalysisManager MAM;
+  PB.registerModuleAnalyses(MAM);
+  PB.registerCGSCCAnalyses(CGAM);
+  PB.registerFunctionAnalyses(FAM);
+  PB.registerLoopAnalyses(LAM);
+  PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
 
-  M->setDataLayout(TargetMachine->createDataLayout());
-  M->setTargetTriple(Invocation.getTargetTriple());
+  auto MPM = PB.buildPerModuleDefaultPipeline(Level);
+  MPM.run(M, MAM);
+
+  // Close scopes of passes whose end was not reported.
+  for (; !Passes.empty(); Passes.pop_back())
+    timeTraceEnd();
+}
+
+/// Returns textual IR of \c M.
+static std::string printModule(llvm::Module &M) {
+  std::string IR;
+  llvm::raw_string_ostream IROS(IR);
+  M.print(IROS, nullptr);
+  IROS << "\n";
+  return IROS.str();
+}
+
+/// \brief Prepares module \c M with data layout \c DL for code generation.
+///
+/// Sets up the target of the module, verifies and optimizes it for \c TM
+/// according to \c Inv. Diagnostics and the optimized IR, if requested, are
+/// reported into \c OS.
+static void prepareModule(llvm::TargetMachine &TM, const llvm::DataLayout &DL,
+                          llvm::Module &M, const CompilerInvocation &Inv,
+                          raw_ostream &OS) {
+  M.setDataLayout(DL);
+  M.setTargetTriple(Inv.getTargetTriple());
+  if (!Inv.isQuiet())
+    llvm::verifyModule(M, &OS);
+  setFunctionAttributes(TM, M);
+  optimizeModule(TM, M, Inv.getOptLevel());
+  if (Inv.printIR())
+    OS << printModule(M);
+}
+
+/// Prepares module \c M for code generation by \c TM.
+static void prepareModule(llvm::TargetMachine &TM, llvm::Module &M,
+                          const CompilerInvocation &Inv, raw_ostream &OS) {
+  prepareModule(TM, TM.createDataLayout(), M, Inv, OS);
+}
+
+/// Emits an object file of \c M into \c Dest using target machine \c TM.
+static bool emitObject(llvm::TargetMachine &TM, llvm::Module &M,
+                       llvm::raw_pwrite_stream &Dest, raw_ostream &OS) {
+  TimeTraceScope Trace("EmitObject", M.getName());
+  llvm::legacy::PassManager pass;
+  auto FileType = llvm::TargetMachine::CGFT_ObjectFile;
+  if (TM.addPassesToEmitFile(pass, Dest, nullptr, FileType)) {
+    OS << "TargetMachine can't emit a file of this type";
+    return false;
+  }
+  pass.run(M);
+  return true;
+}
+
+/// Creates a temporary file for a partial object, whose path is appended
+/// to \c Parts. Returns \c nullptr on failure.
+static std::unique_ptr<llvm::raw_fd_ostream>
+createPartialObjectFile(std::vector<std::string> &Parts, raw_ostream &OS) {
+  int FD;
+  SmallString<128> Path;
+  if (auto EC = llvm::sys::fs::createTemporaryFile("dusk", "o", FD, Path)) {
+    OS << "Could not create partial object file: " << EC.message();
+    return nullptr;
+  }
+  Parts.push_back(Path.str().str());
+  return std::make_unique<llvm::raw_fd_ostream>(FD, true);
+}
+
+/// Closes a partial object file \c S, returns \c true on success.
+static bool closePartialObjectFile(llvm::raw_fd_ostream &S, raw_ostream &OS) {
+  S.close();
+  if (!S.has_error())
+    return true;
+  OS << "Could not write partial object file: " << S.error().message();
+  S.clear_error();
+  return false;
+}
+
+bool CompilerInstance::emitObjectFile(std::unique_ptr<llvm::Module> M) {
+  std::string Err;
+  auto TargetMachine = getTargetMachine(Invocation, Err);
+  if (!TargetMachine) {
+    OS << Err;
+    return false;
+  }
+  prepareModule(*TargetMachine, *M, Invocation, OS);
+
+  auto Filename = Invocation.getObjectFile();
+  if (Invocation.getCodegenJobs() > 1)
+    return emitObjectFileParallel(std::move(M), Filename);
 
   // Open output file
-  auto Filename = Invocation.getInputFile()->file() + ".o";
   std::error_code EC;
   llvm::raw_fd_ostream dest(Filename, EC, llvm::sys::fs::F_None);
 
   if (EC) {
-    llvm::errs() << "Could not open file '" << Filename
-                 << "': " << EC.message();
+    OS << "Could not open file '" << Filename << "': " << EC.message();
+    return false;
+  }
+
+  if (!emitObject(*TargetMachine, *M, dest, OS))
+    return false;
+  dest.flush();
+  return true;
+}
+
+bool CompilerInstance::emitObjectFileParallel(std::unique_ptr<llvm::Module> M,
+                                              StringRef Filename) {
+  auto NumParts = Invocation.getCodegenJobs();
+  std::vector<std::string> Parts;
+  std::vector<std::unique_ptr<llvm::raw_fd_ostream>> Streams;
+  SmallVector<llvm::raw_pwrite_stream *, 16> OSs;
+
+  // Removes all partial object files when leaving the scope.
+  auto Cleanup = llvm::make_scope_exit([&] {
+    Streams.clear();
+    for (auto &P : Parts)
+      llvm::sys::fs::remove(P);
+  });
+
+  for (unsigned i = 0; i < NumParts; i++) {
+    auto S = createPartialObjectFile(Parts, OS);
+    if (!S)
+      return false;
+    OSs.push_back(S.get());
+    Streams.push_back(std::move(S));
+  }
+
+  // Each partition is compiled on its own thread with its own target
+  // machine, because target machines are not thread-safe. The machines are
+  // created upfront, since the code generator cannot handle a failure of
+  // the factory, which it calls once per partition.
+  std::vector<std::unique_ptr<llvm::TargetMachine>> Machines;
+  for (unsigned i = 0; i < NumParts; i++) {
+    std::string Err;
+    auto TM = createTargetMachine(Invocation, Err);
+    if (!TM) {
+      OS << Err;
+      return false;
+    }
+    Machines.push_back(std::move(TM));
+  }
+  std::mutex MachinesMutex;
+  auto TMFactory = [&] {
+    std::lock_guard<std::mutex> Lock(MachinesMutex);
+    auto TM = std::move(Machines.back());
+    Machines.pop_back();
+    return TM;
+  };
+
+  // Internal globals referenced from multiple partitions would be
+  // externalized under their source names, which may clash with other
+  // symbols of the program, e.g. a global 'stdin' with the one of libc.
+  // They get the symbols of partial modules instead, so that functions
+  // sharing a global can still be placed into different partitions.
+  irgen::exportGlobals(*M);
+  TimeTraceScope Trace("EmitObject", M->getName());
+  llvm::splitCodeGen(std::move(M), OSs, {}, TMFactory,
+                     llvm::TargetMachine::CGFT_ObjectFile,
+                     /*PreserveLocals=*/false);
+
+  for (auto &S : Streams)
+    if (!closePartialObjectFile(*S, OS))
+      return false;
+  return mergeObjectFiles(Parts, Filename, OS);
+}
+
+/// Maximum number of functions emitted into a single partial module.
+static const unsigned MaxFuncsPerUnit = 64;
+
+/// Maximum number of instructions of a partial module emitted in streaming
+/// mode. The module is passed to code generation once it is exceeded.
+static const unsigned MaxInstsPerUnit = 16384;
+
+namespace {
+
+/// \brief Optimizes and compiles partial modules into partial object files
+/// on background threads.
+///
+/// At most one queued unit per thread is kept in memory, \c emit blocks
+/// while the code generation threads are busy.
+class PartialObjectEmitter {
+  /// A unit waiting for code generation.
+  struct PendingUnit {
+    irgen::IRGenUnit Unit;
+    std::unique_ptr<llvm::raw_fd_ostream> Dest;
+  };
+
+  ASTContext &Ctx;
+  const CompilerInvocation &Inv;
+
+  BoundedQueue<PendingUnit> Units;
+  std::vector<std::thread> Threads;
+
+  std::mutex OutputLock;
+  std::string Output;
+  std::vector<std::string> Parts;
+  std::atomic<bool> IsFailed;
+
+public:
+  PartialObjectEmitter(ASTContext &Ctx, const CompilerInvocation &Inv)
+      : Ctx(Ctx), Inv(Inv), Units(std::max(1u, Inv.getCodegenJobs())),
+        IsFailed(false) {
+    for (unsigned i = 0, e = std::max(1u, Inv.getCodegenJobs()); i < e; i++)
+      Threads.emplace_back([this] { run(); });
+  }
+
+  ~PartialObjectEmitter() {
+    finish();
+    for (auto &P : Parts)
+      llvm::sys::fs::remove(P);
+  }
+
+  /// \brief Queues unit \c U for code generation.
+  ///
+  /// \return Path of the partial object file the unit is emitted into, or
+  ///   an empty string on failure.
+  std::string emit(irgen::IRGenUnit U) {
+    std::string Msg;
+    llvm::raw_string_ostream MsgOS(Msg);
+    PendingUnit P{std::move(U), nullptr};
+    std::string Path;
+    {
+      std::lock_guard<std::mutex> Guard(OutputLock);
+      P.Dest = createPartialObjectFile(Parts, MsgOS);
+      if (P.Dest)
+        Path = Parts.back();
+    }
+    if (!P.Dest) {
+      IsFailed = true;
+      addOutput(MsgOS.str());
+      return "";
+    }
+    Units.push(std::move(P));
+    return Path;
+  }
+
+  /// \brief Waits for all queued units to be compiled and reports their
+  /// output into \c OS.
+  ///
+  /// \return \c true if all units were compiled successfully.
+  bool finish(raw_ostream &OS) {
+    finish();
+    OS << Output;
+    Output.clear();
+    return !IsFailed;
+  }
+
+  /// Combines all partial object files into object file \c Filename.
+  bool merge(StringRef Filename, raw_ostream &OS) {
+    return mergeObjectFiles(Parts, Filename, OS);
+  }
+
+private:
+  /// Reports \c Str once all units are compiled.
+  void addOutput(StringRef Str) {
+    std::lock_guard<std::mutex> Guard(OutputLock);
+    Output += Str;
+  }
+
+  void finish() {
+    Units.close();
+    for (auto &T : Threads)
+      T.join();
+    Threads.clear();
+  }
+
+  void run() {
+    PendingUnit P;
+    while (Units.pop(P)) {
+      // Keep draining the queue, so that the producer never blocks.
+      if (IsFailed || Ctx.isError()) {
+        P = PendingUnit();
+        continue;
+      }
+
+      std::string Msg;
+      llvm::raw_string_ostream MsgOS(Msg);
+      std::string Err;
+      auto TM = getTargetMachine(Inv, Err);
+      if (!TM) {
+        MsgOS << Err << "\n";
+        IsFailed = true;
+      } else {
+        // Each unit is optimized on its own, there is no inlining across
+        // units.
+        prepareModule(*TM, *P.Unit.Module, Inv, MsgOS);
+        if (!emitObject(*TM, *P.Unit.Module, *P.Dest, MsgOS) ||
+            !closePartialObjectFile(*P.Dest, MsgOS))
+          IsFailed = true;
+      }
+      // Release the unit before waiting for the next one.
+      P = PendingUnit();
+      addOutput(MsgOS.str());
+    }
+  }
+};
+
+} // anonymous namespace
+
+void CompilerInstance::performPipelinedCompilation() {
+  performParseOnly();
+  if (Context->isError())
+    return;
+  getFuncs(*Context);
+
+  std::string Err;
+  if (!getTargetMachine(Invocation, Err)) {
+    OS << Err;
+    Context->setError();
     return;
   }
 
-  // Emit pass
-  llvm::legacy::PassManager pass;
-  auto FileType = llvm::TargetMachine::CGFT_ObjectFile;
-  if (TargetMachine->addPassesToEmitFile(pass, dest, nullptr, FileType)) {
-    llvm::errs() << "TargetMachine can't emit a file of this type";
+  BoundedQueue<FuncStmt *> Checked(MaxFuncsPerUnit);
+  PartialObjectEmitter Emitter(*Context, Invocation);
+
+  // IR generation stage. Functions are batched into a unit as long as more
+  // of them are ready, a unit is passed on once the stage would wait.
+  std::thread IRGen([&] {
+    irgen::PartialIRGenerator Gen(*Context);
+    auto PassUnit = [&] { Emitter.emit(Gen.takeUnit()); };
+
+    FuncStmt *FS;
+    while (Checked.pop(FS)) {
+      Gen.emitFunc(FS);
+      if (Gen.getNumFuncs() >= MaxFuncsPerUnit || Checked.empty())
+        PassUnit();
+    }
+    // Initializers of globals are valid only if the whole module is.
+    if (!Context->isError()) {
+      Gen.emitGlobals();
+      PassUnit();
+    }
+  });
+
+  // Type checking runs on this thread, feeding the pipeline.
+  sema::Sema S(*Context, Diag, Invocation.getSemaJobs());
+  setUpModuleLoader(S);
+  S.setFuncCheckedCallback([&Checked](FuncStmt *FS) { Checked.push(FS); });
+  S.perform();
+  Checked.close();
+  IRGen.join();
+
+  auto IsEmitted = Emitter.finish(OS);
+  if (Context->isError())
+    return;
+  if (!IsEmitted ||
+      !Emitter.merge(Invocation.getObjectFile(), OS))
+    Context->setError();
+}
+
+void CompilerInstance::performStreamingCompilation() {
+  Loader.reset();
+  Context = std::make_unique<ASTContext>();
+  auto InputFile = Invocation.getInputFile();
+  std::unique_ptr<TokenStream> Tokens;
+  if (Invocation.getLexingMode() != LexingMode::OnDemand)
+    Tokens = std::make_unique<TokenStream>(
+        SourceManager, InputFile->bufferID(),
+        Invocation.getLexingMode() == LexingMode::Threaded);
+  Parser P(*Context, SourceManager, *InputFile, Diag, InputFile->bufferID(),
+           Tokens.get());
+
+  // Only prototypes of functions are parsed up front.
+  P.setDelayFuncBodies(true);
+  MainModule = P.parseModule();
+  Context->setRootModule(MainModule);
+  if (Context->isError())
+    return;
+  getFuncs(*Context);
+
+  sema::Sema S(*Context, Diag);
+  setUpModuleLoader(S);
+  S.performDeclarations();
+  if (Context->isError())
+    return;
+
+  std::string Err;
+  if (!getTargetMachine(Invocation, Err)) {
+    OS << Err;
+    Context->setError();
     return;
   }
-  if (!Invocation.isQuiet())
-    llvm::verifyModule(*M, &llvm::errs());
-  
-  pass.run(*M);
-  dest.flush();
+
+  PartialObjectEmitter Emitter(*Context, Invocation);
+  irgen::PartialIRGenerator Gen(*Context);
+  auto PassUnit = [&] { Emitter.emit(Gen.takeUnit()); };
+
+  // Each body lives in its own arena only until it is emitted.
+  llvm::BumpPtrAllocator Arena;
+  for (auto N : MainModule->getContents()) {
+    auto FS = dynamic_cast<FuncStmt *>(N);
+    if (!FS || !FS->hasDelayedBody())
+      continue;
+
+    Context->setArena(&Arena);
+    if (P.parseDelayedFuncBody(FS))
+      S.typeCheckFuncBody(FS);
+    Context->setArena(nullptr);
+
+    if (!Context->isError()) {
+      Gen.emitFunc(FS);
+      if (Gen.getNumFuncs() >= MaxFuncsPerUnit ||
+          Gen.getNumInstructions() >= MaxInstsPerUnit)
+        PassUnit();
+    }
+    FS->setBody(nullptr);
+    Arena.Reset();
+  }
+
+  if (!Context->isError()) {
+    Gen.emitGlobals();
+    PassUnit();
+  }
+  auto IsEmitted = Emitter.finish(OS);
+  if (Context->isError())
+    return;
+  if (!IsEmitted ||
+      !Emitter.merge(Invocation.getObjectFile(), OS))
+    Context->setError();
 }
 
+void CompilerInstance::performIncrementalCompilation() {
+  performSema();
+  if (Context->isError())
+    return;
+
+  std::string Err;
+  if (!getTargetMachine(Invocation, Err)) {
+    OS << Err;
+    Context->setError();
+    return;
+  }
+
+  CompilationCache Cache(Invocation.getCachePath(),
+                         Invocation.getCacheSizeLimit());
+  ModuleCacheKeys Keys(Invocation, MainModule);
+
+  // Cached objects are copied out first, the cache may evict them while
+  // the rest of the module is compiled.
+  std::vector<std::string> Parts;
+  auto RemoveParts = llvm::make_scope_exit([&Parts] {
+    for (auto &P : Parts)
+      llvm::sys::fs::remove(P);
+  });
+  auto LookupPart = [&](StringRef Key) {
+    int FD;
+    SmallString<128> Path;
+    if (llvm::sys::fs::createTemporaryFile("dusk", "o", FD, Path))
+      return false;
+    llvm::sys::fs::closeFile(FD);
+    Parts.push_back(Path.str().str());
+    if (Cache.lookup(Key, Path))
+      return true;
+    llvm::sys::fs::remove(Path);
+    Parts.pop_back();
+    return false;
+  };
+
+  // Pairs of a key and a partial object file, which is stored under it.
+  std::vector<std::pair<std::string, std::string>> Emitted;
+  PartialObjectEmitter Emitter(*Context, Invocation);
+  irgen::PartialIRGenerator Gen(*Context);
+  auto PassUnit = [&](std::string Key) {
+    auto Path = Emitter.emit(Gen.takeUnit());
+    if (!Path.empty())
+      Emitted.emplace_back(std::move(Key), std::move(Path));
+  };
+
+  for (auto N : MainModule->getContents()) {
+    auto FS = dynamic_cast<FuncStmt *>(N);
+    if (!FS)
+      continue;
+    auto Key = Keys.getFuncKey(FS);
+    if (LookupPart(Key))
+      continue;
+    Gen.emitFunc(FS);
+    PassUnit(std::move(Key));
+  }
+  auto GlobalsKey = Keys.getGlobalsKey();
+  if (!LookupPart(GlobalsKey)) {
+    Gen.emitGlobals();
+    PassUnit(std::move(GlobalsKey));
+  }
+
+  if (!Emitter.finish(OS)) {
+    Context->setError();
+    return;
+  }
+  // Emitted parts are owned by the emitter, which removes them.
+  SmallVector<std::string, 16> AllParts(Parts.begin(), Parts.end());
+  for (auto &E : Emitted) {
+    Cache.store(E.first, E.second);
+    AllParts.push_back(E.second);
+  }
+  if (!mergeObjectFiles(AllParts, Invocation.getObjectFile(), OS))
+    Context->setError();
+}
+
+int CompilerInstance::performRun() {
+  performSema();
+  if (Context->isError())
+    return 1;
+
+  // The target machine only optimizes the module, code is generated by
+  // the JIT itself.
+  DuskJIT::setUpInvocation(Invocation);
+  auto JIT = DuskJIT::create(Invocation);
+  if (!JIT) {
+    OS << toString(JIT.takeError()) << "\n";
+    Context->setError();
+    return 1;
+  }
+
+  std::string Err;
+  auto TargetMachine = getTargetMachine(Invocation, Err);
+  if (!TargetMachine) {
+    OS << Err;
+    Context->setError();
+    return 1;
+  }
+
+  for (auto &Obj : getImportedObjectFiles())
+    if (auto E = (*JIT)->addObjectFile(Obj)) {
+      OS << toString(std::move(E)) << "\n";
+      Context->setError();
+      return 1;
+    }
+
+  irgen::IRGenerator Gen(*Context);
+  auto Unit = Gen.performUnit();
+  prepareModule(*TargetMachine, (*JIT)->getDataLayout(), *Unit.Module,
+                Invocation, OS);
+
+  if (auto E = (*JIT)->addModule(std::move(Unit.Module),
+                                 std::move(Unit.Context))) {
+    OS << toString(std::move(E)) << "\n";
+    Context->setError();
+    return 1;
+  }
+
+  auto ExitCode = (*JIT)->runMain();
+  if (!ExitCode) {
+    OS << toString(ExitCode.takeError()) << "\n";
+    Context->setError();
+    return 1;
+  }
+  return *ExitCode;
+}
+
+int CompilerInstance::performInterpret() {
+  performSema();
+  if (Context->isError())
+    return 1;
+
+  interp::BytecodeGenerator Gen(*Context, OS);
+  auto Bytecode = Gen.perform();
+  if (!Bytecode) {
+    Context->setError();
+    return 1;
+  }
+  if (Invocation.printIR())
+    Bytecode->print(OS);
+
+  return interp::Interpreter(*Bytecode, OS).run();
+}
+
+std::unique_ptr<llvm::MemoryBuffer>
+CompilerInstance::performInMemoryCompilation() {
+  performSema();
+  if (Context->isError())
+    return nullptr;
+
+  // The object is added to a JIT rather than linked into an executable.
+  DuskJIT::setUpInvocation(Invocation);
+
+  // Type checking is cheap compared to code generation, so it is not skipped
+  // even on a hit. Programs importing modules are never cached, since the key
+  // does not cover interfaces of the modules.
+  std::unique_ptr<CompilationCache> Cache;
+  std::string Key;
+  if (!Invocation.getCachePath().empty() && !Loader->hasLoadedModules()) {
+    Cache = std::make_unique<CompilationCache>(Invocation.getCachePath(),
+                                               Invocation.getCacheSizeLimit());
+    Key = CompilationCache::computeKey(Invocation);
+    if (auto Object = Cache->lookup(Key))
+      return Object;
+  }
+
+  std::string Err;
+  auto TargetMachine = getTargetMachine(Invocation, Err);
+  if (!TargetMachine) {
+    OS << Err;
+    Context->setError();
+    return nullptr;
+  }
+
+  irgen::IRGenerator Gen(*Context);
+  auto Unit = Gen.performUnit();
+  prepareModule(*TargetMachine, *Unit.Module, Invocation, OS);
+
+  llvm::SmallVector<char, 0> Object;
+  llvm::raw_svector_ostream ObjectOS(Object);
+  if (!emitObject(*TargetMachine, *Unit.Module, ObjectOS, OS)) {
+    Context->setError();
+    return nullptr;
+  }
+
+  auto Buffer =
+      std::make_unique<llvm::SmallVectorMemoryBuffer>(std::move(Object));
+  if (Cache)
+    Cache->store(Key, Buffer->getMemBufferRef());
+  return std::move(Buffer);
+}
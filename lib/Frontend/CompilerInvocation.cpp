@@ -10,24 +10,32 @@
 #include "dusk/Frontend/CompilerInvocation.h"
 
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringMap.h"
 #include "llvm/ADT/Triple.h"
+#include "llvm/MC/SubtargetFeature.h"
 #include "llvm/Option/Arg.h"
 #include "llvm/Option/ArgList.h"
 #include "llvm/Option/Option.h"
 #include "llvm/Support/SMLoc.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
 #include "llvm/Support/LineIterator.h"
 #include "llvm/Support/Path.h"
 
 using namespace dusk;
 
 CompilerInvocation::CompilerInvocation()
-    : Target(llvm::sys::getDefaultTargetTriple()), OutputName("a.out") {}
+    : Target(llvm::sys::getDefaultTargetTriple()), OutputName("a.out"),
+      IsQuiet(false), PrintIR(false), LexMode(LexingMode::OnDemand),
+      SemaJobs(1), CodegenJobs(1), IsPipelined(false),
+      IsStreaming(false), OptLvl(OptLevel::O0), TargetCPU("generic"),
+      CacheSizeLimit(0), IsIncremental(false) {}
 
 void CompilerInvocation::setArgs(SourceMgr &SM, DiagnosticEngine &Diag,
                                  StringRef InFile, StringRef OutFile,
                                  bool IsQ, bool PIR) {
   OutputName = OutFile;
+  ObjectFile = (InFile + ".o").str();
   IsQuiet = IsQ;
   PrintIR = PIR;
   
@@ -39,3 +47,38 @@ void CompilerInvocation::setArgs(SourceMgr &SM, DiagnosticEngine &Diag,
     InputFile = std::make_unique<SourceFile>(BuffID, BuffPtr, InFile);
   }
 }
+
+void CompilerInvocation::setInputBuffer(SourceMgr &SM, StringRef Name,
+                                        StringRef Source) {
+  ObjectFile = (Name + ".o").str();
+  auto Buff = llvm::MemoryBuffer::getMemBufferCopy(Source, Name);
+  auto L = SMLoc::getFromPointer(Buff->getBufferStart());
+  auto BuffPtr = Buff.get();
+  auto BuffID = SM.AddNewSourceBuffer(std::move(Buff), L);
+  InputFile = std::make_unique<SourceFile>(BuffID, BuffPtr, Name);
+}
+
+void CompilerInvocation::setTargetCPU(StringRef CPU) {
+  if (CPU != "native") {
+    TargetCPU = CPU;
+    return;
+  }
+
+  TargetCPU = llvm::sys::getHostCPUName();
+  llvm::StringMap<bool> HostFeatures;
+  if (!llvm::sys::getHostCPUFeatures(HostFeatures))
+    return;
+  llvm::SubtargetFeatures Features;
+  for (auto &F : HostFeatures)
+    Features.AddFeature(F.first(), F.second);
+  // Explicitly requested features take precedence over the host ones.
+  for (auto &F : llvm::SubtargetFeatures(TargetFeatures).getFeatures())
+    Features.AddFeature(F);
+  TargetFeatures = Features.getString();
+}
+
+void CompilerInvocation::addTargetFeature(StringRef Feature) {
+  llvm::SubtargetFeatures Features(TargetFeatures);
+  Features.AddFeature(Feature);
+  TargetFeatures = Features.getString();
+}
@@ -0,0 +1,141 @@
+//===--- DuskJIT.cpp ------------------------------------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Frontend/DuskJIT.h"
+#include "dusk/Frontend/CompilerInvocation.h"
+#include "llvm/ExecutionEngine/JITSymbol.h"
+#include "llvm/ExecutionEngine/Orc/Core.h"
+#include "llvm/ExecutionEngine/Orc/ThreadSafeModule.h"
+#include "llvm/MC/SubtargetFeature.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/TargetSelect.h"
+
+#include "runtime/io.h"
+#include "runtime/iter.h"
+
+using namespace dusk;
+
+void DuskJIT::setUpInvocation(CompilerInvocation &Inv) {
+  Inv.setRelocModel(llvm::Reloc::PIC_);
+  Inv.setCodeModel(llvm::CodeModel::Large);
+}
+
+llvm::Expected<llvm::orc::JITTargetMachineBuilder>
+DuskJIT::createTargetMachineBuilder(const CompilerInvocation &Inv) {
+  llvm::InitializeNativeTarget();
+  llvm::InitializeNativeTargetAsmPrinter();
+
+  auto JTMB = llvm::orc::JITTargetMachineBuilder::detectHost();
+  if (!JTMB)
+    return JTMB.takeError();
+  JTMB->setCPU(Inv.getTargetCPU().str());
+  llvm::SubtargetFeatures Features(Inv.getTargetFeatures());
+  JTMB->addFeatures(Features.getFeatures());
+  JTMB->setRelocationModel(Inv.getRelocModel());
+  JTMB->setCodeModel(Inv.getCodeModel());
+  switch (Inv.getOptLevel()) {
+  case OptLevel::O0:
+    JTMB->setCodeGenOptLevel(llvm::CodeGenOpt::None);
+    break;
+  case OptLevel::O1:
+    JTMB->setCodeGenOptLevel(llvm::CodeGenOpt::Less);
+    break;
+  case OptLevel::O2:
+  case OptLevel::Os:
+    JTMB->setCodeGenOptLevel(llvm::CodeGenOpt::Default);
+    break;
+  case OptLevel::O3:
+    JTMB->setCodeGenOptLevel(llvm::CodeGenOpt::Aggressive);
+    break;
+  }
+  return JTMB;
+}
+
+llvm::Expected<std::unique_ptr<DuskJIT>>
+DuskJIT::create(const CompilerInvocation &Inv) {
+  auto JTMB = createTargetMachineBuilder(Inv);
+  if (!JTMB)
+    return JTMB.takeError();
+
+  auto DL = JTMB->getDefaultDataLayoutForTarget();
+  if (!DL)
+    return DL.takeError();
+  auto J = llvm::orc::LLJIT::Create(std::move(*JTMB), std::move(*DL));
+  if (!J)
+    return J.takeError();
+
+  std::unique_ptr<DuskJIT> Result(new DuskJIT(std::move(*J)));
+  if (auto Err = Result->defineRuntime())
+    return std::move(Err);
+  return std::move(Result);
+}
+
+llvm::Error DuskJIT::defineRuntime() {
+  llvm::orc::MangleAndInterner Mangle(JIT->getExecutionSession(),
+                                      JIT->getDataLayout());
+  auto Exported = llvm::JITSymbolFlags::Exported;
+  auto Symbol = [Exported](auto *Fn) {
+    return llvm::JITEvaluatedSymbol(llvm::pointerToJITTargetAddress(Fn),
+                                    Exported);
+  };
+
+  llvm::orc::SymbolMap Runtime;
+  Runtime[Mangle("println")] = Symbol(&println);
+  Runtime[Mangle("readln")] = Symbol(&readln);
+  Runtime[Mangle("__iter_range")] = Symbol(&__iter_range);
+  Runtime[Mangle("__iter_step")] = Symbol(&__iter_step);
+  return JIT->getMainJITDylib().define(
+      llvm::orc::absoluteSymbols(std::move(Runtime)));
+}
+
+llvm::Error DuskJIT::addModule(std::unique_ptr<llvm::Module> M,
+                               std::unique_ptr<llvm::LLVMContext> Ctx) {
+  return JIT->addIRModule(
+      llvm::orc::ThreadSafeModule(std::move(M), std::move(Ctx)));
+}
+
+llvm::Error DuskJIT::addObjectFile(StringRef Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path);
+  if (!Buffer)
+    return llvm::createFileError(Path,
+                                 llvm::errorCodeToError(Buffer.getError()));
+  return addObject(std::move(*Buffer));
+}
+
+llvm::Error DuskJIT::addObject(std::unique_ptr<llvm::MemoryBuffer> Object) {
+  return JIT->addObjectFile(std::move(Object));
+}
+
+llvm::Error DuskJIT::defineSymbol(StringRef Name, llvm::JITTargetAddress Addr) {
+  llvm::orc::MangleAndInterner Mangle(JIT->getExecutionSession(),
+                                      JIT->getDataLayout());
+  llvm::orc::SymbolMap Symbols;
+  Symbols[Mangle(Name)] =
+      llvm::JITEvaluatedSymbol(Addr, llvm::JITSymbolFlags::Exported);
+  return JIT->getMainJITDylib().define(
+      llvm::orc::absoluteSymbols(std::move(Symbols)));
+}
+
+llvm::Expected<llvm::JITTargetAddress> DuskJIT::lookup(StringRef Name) {
+  auto Symbol = JIT->lookup(Name);
+  if (!Symbol)
+    return Symbol.takeError();
+  return Symbol->getAddress();
+}
+
+llvm::Expected<int> DuskJIT::runMain() {
+  auto Main = lookup("main");
+  if (!Main)
+    return Main.takeError();
+
+  // Dusk's main takes no arguments and returns no value.
+  auto Fn = llvm::jitTargetAddressToPointer<void (*)()>(*Main);
+  Fn();
+  return 0;
+}
@@ -0,0 +1,330 @@
+//===--- IncrementalDocument.cpp ------------------------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Frontend/IncrementalDocument.h"
+
+#include "dusk/AST/ASTContext.h"
+#include "dusk/AST/Decl.h"
+#include "dusk/AST/Stmt.h"
+#include "dusk/Basic/SourceManager.h"
+#include "dusk/Frontend/SourceFile.h"
+#include "dusk/Parse/Lexer.h"
+#include "dusk/Parse/Parser.h"
+#include "dusk/Runtime/RuntimeFuncs.h"
+#include "dusk/Sema/Sema.h"
+#include "dusk/Serialization/SerializedModuleLoader.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <tuple>
+
+using namespace dusk;
+
+/// Edited bodies are added to the source manager as new buffers, which are
+/// released only by a rebuild. Bounds memory of a long editing session.
+static const size_t MaxBufferedBytes = 64 * 1024 * 1024;
+
+/// Returns \c true if buffer \c BufferID consists of a single block, i.e.
+/// an edit did not change extent of the function body.
+static bool isSingleBlock(const llvm::SourceMgr &SM, unsigned BufferID) {
+  Lexer L(SM, BufferID);
+  Token T;
+  L.lex(T);
+  if (T.isNot(tok::l_brace))
+    return false;
+
+  unsigned Depth = 1;
+  while (Depth > 0) {
+    L.lex(T);
+    if (T.is(tok::eof))
+      return false;
+    if (T.is(tok::l_brace))
+      Depth++;
+    if (T.is(tok::r_brace))
+      Depth--;
+  }
+  L.lex(T);
+  return T.is(tok::eof);
+}
+
+IncrementalDocument::IncrementalDocument(StringRef Filename, StringRef Text,
+                                         std::vector<std::string> ImportPaths)
+    : Filename(Filename), Text(Text), ImportPaths(std::move(ImportPaths)) {
+  computeLineStarts();
+}
+
+IncrementalDocument::~IncrementalDocument() { resetState(); }
+
+void IncrementalDocument::resetState() {
+  Sema.reset();
+  Loader.reset();
+  Context.reset();
+  File.reset();
+  Diag.reset();
+  SourceManager.reset();
+  MainBufferStart = nullptr;
+}
+
+void IncrementalDocument::setText(StringRef NewText) {
+  Text = NewText;
+  computeLineStarts();
+  NeedsRebuild = true;
+}
+
+void IncrementalDocument::computeLineStarts() {
+  LineStarts.clear();
+  LineStarts.push_back(0);
+  const char *Start = Text.data();
+  const char *End = Start + Text.size();
+  for (const char *P = Start; (P = static_cast<const char *>(std::memchr(
+                                  P, '\n', End - P))) != nullptr;)
+    LineStarts.push_back(++P - Start);
+}
+
+size_t IncrementalDocument::getOffset(unsigned Line, unsigned Column) const {
+  if (Line >= LineStarts.size())
+    return Text.size();
+  auto LineEnd =
+      Line + 1 < LineStarts.size() ? LineStarts[Line + 1] - 1 : Text.size();
+  return std::min(LineStarts[Line] + Column, LineEnd);
+}
+
+// MARK: - Edits
+
+IncrementalDocument::FuncEntry *IncrementalDocument::findFunc(size_t Begin,
+                                                              size_t End) {
+  auto It = std::upper_bound(
+      Funcs.begin(), Funcs.end(), Begin,
+      [](size_t Offset, const FuncEntry &F) { return Offset <= F.Begin; });
+  if (It == Funcs.begin())
+    return nullptr;
+  --It;
+  // Braces delimit the extent of the body, they must stay intact.
+  if (Begin > It->Begin && End < It->End)
+    return &*It;
+  return nullptr;
+}
+
+void IncrementalDocument::edit(size_t Offset, size_t Length,
+                               StringRef NewText) {
+  Offset = std::min(Offset, Text.size());
+  Length = std::min(Length, Text.size() - Offset);
+  Text.replace(Offset, Length, NewText.data(), NewText.size());
+  computeLineStarts();
+  if (NeedsRebuild)
+    return;
+
+  auto F = IsGlobalScopeValid ? findFunc(Offset, Offset + Length) : nullptr;
+  if (!F) {
+    NeedsRebuild = true;
+    return;
+  }
+
+  // Functions following the edited one only move.
+  auto Delta = int64_t(NewText.size()) - int64_t(Length);
+  F->End += Delta;
+  F->IsDirty = true;
+  for (auto It = F + 1, E = Funcs.data() + Funcs.size(); It != E; ++It) {
+    It->Begin += Delta;
+    It->End += Delta;
+  }
+}
+
+bool IncrementalDocument::update() {
+  if (NeedsRebuild || BufferedBytes > MaxBufferedBytes) {
+    rebuild();
+    return true;
+  }
+
+  for (auto &F : Funcs) {
+    if (!F.IsDirty)
+      continue;
+    if (!recheck(F)) {
+      rebuild();
+      return true;
+    }
+  }
+  return false;
+}
+
+// MARK: - Checking
+
+void IncrementalDocument::rebuild() {
+  resetState();
+  Funcs.clear();
+  GlobalDiags.clear();
+  NeedsRebuild = false;
+  IsGlobalScopeValid = false;
+  BufferedBytes = 0;
+  NumRebuilds++;
+
+  SourceManager = std::make_unique<dusk::SourceManager>();
+  auto Buffer = llvm::MemoryBuffer::getMemBufferCopy(Text, Filename);
+  auto BufferPtr = Buffer.get();
+  MainBufferStart = BufferPtr->getBufferStart();
+  MainBufferID = SourceManager->AddNewSourceBuffer(std::move(Buffer), SMLoc());
+  Diag = std::make_unique<DiagnosticEngine>(*SourceManager);
+  Diag->addConsumer(this);
+  File = std::make_unique<SourceFile>(MainBufferID, BufferPtr, Filename);
+  Context = std::make_unique<ASTContext>();
+
+  // Only prototypes of functions are parsed up front, bodies are parsed and
+  // checked one by one, so that their diagnostics can be told apart.
+  Parser P(*Context, *SourceManager, *File, *Diag, MainBufferID);
+  P.setDelayFuncBodies(true);
+  auto M = P.parseModule();
+  Context->setRootModule(M);
+  if (Context->isError())
+    return;
+  getFuncs(*Context);
+
+  std::vector<std::string> Paths;
+  Paths.push_back(llvm::sys::path::parent_path(Filename).str());
+  if (Paths.back().empty())
+    Paths.back() = ".";
+  Paths.insert(Paths.end(), ImportPaths.begin(), ImportPaths.end());
+  Loader = std::make_unique<SerializedModuleLoader>(*Context, std::move(Paths));
+  Sema = std::make_unique<sema::Sema>(*Context, *Diag);
+  Sema->setModuleLoader(Loader.get());
+  Sema->performDeclarations();
+  if (Context->isError())
+    return;
+  IsGlobalScopeValid = true;
+
+  for (auto N : M->getContents()) {
+    auto FS = dynamic_cast<FuncStmt *>(N);
+    if (!FS || !FS->hasDelayedBody())
+      continue;
+    auto R = FS->getDelayedBodyRange();
+    FuncEntry F;
+    F.FS = FS;
+    F.OrigBegin = F.Begin = R.Start.getPointer() - MainBufferStart;
+    F.OrigEnd = F.End = R.End.getPointer() - MainBufferStart + 1;
+    Funcs.push_back(std::move(F));
+  }
+
+  for (auto &F : Funcs) {
+    CurrentFunc = &F;
+    Context->clearError();
+    Context->setArena(&BodyArena);
+    auto IsParsed = P.parseDelayedFuncBody(F.FS) && !Context->isError();
+    checkBody(F, IsParsed);
+  }
+}
+
+bool IncrementalDocument::recheck(FuncEntry &F) {
+  auto Body = StringRef(Text).slice(F.Begin, F.End);
+  auto Buffer = llvm::MemoryBuffer::getMemBufferCopy(Body, Filename);
+  auto Start = Buffer->getBufferStart();
+  auto ID = SourceManager->AddNewSourceBuffer(std::move(Buffer), SMLoc());
+  BufferedBytes += Body.size();
+  if (!isSingleBlock(*SourceManager, ID))
+    return false;
+
+  F.Diags.clear();
+  CurrentFunc = &F;
+  CurrentBody = StringRef(Start, Body.size());
+  Context->clearError();
+  Context->setArena(&BodyArena);
+  {
+    Parser P(*Context, *SourceManager, *File, *Diag, ID);
+    auto IsParsed = P.parseFuncBody(F.FS) && !Context->isError();
+    checkBody(F, IsParsed);
+  }
+  CurrentBody = StringRef();
+  NumRechecks++;
+  return true;
+}
+
+void IncrementalDocument::checkBody(FuncEntry &F, bool IsParsed) {
+  if (IsParsed)
+    Sema->typeCheckFuncBody(F.FS);
+
+  // Nothing but diagnostics of the body is kept.
+  Context->setArena(nullptr);
+  F.FS->setBody(nullptr);
+  BodyArena.Reset();
+  Context->clearError();
+  F.IsDirty = false;
+  CurrentFunc = nullptr;
+}
+
+// MARK: - Diagnostics
+
+void IncrementalDocument::consume(SMDiagnostic &Diagnostic) {
+  StoredDiagnostic D{Diagnostic.getKind(), Diagnostic.getMessage().str(), 0};
+  auto Ptr = Diagnostic.getLoc().getPointer();
+  auto MainSize = SourceManager->getMemoryBuffer(MainBufferID)->getBufferSize();
+  bool IsMain = Ptr >= MainBufferStart && Ptr <= MainBufferStart + MainSize;
+  size_t MainOffset = IsMain ? Ptr - MainBufferStart : 0;
+
+  if (!CurrentFunc) {
+    D.Offset = MainOffset;
+    GlobalDiags.push_back(std::move(D));
+    return;
+  }
+
+  auto &F = *CurrentFunc;
+  if (!CurrentBody.empty() && Ptr >= CurrentBody.begin() &&
+      Ptr <= CurrentBody.end())
+    D.Offset = Ptr - CurrentBody.begin();
+  else if (CurrentBody.empty() && MainOffset >= F.OrigBegin &&
+           MainOffset < F.OrigEnd)
+    D.Offset = int64_t(MainOffset) - int64_t(F.OrigBegin);
+  else
+    // Refers to a declaration outside of the body.
+    D.Offset = int64_t(mapMainOffset(MainOffset)) - int64_t(F.Begin);
+  F.Diags.push_back(std::move(D));
+}
+
+size_t IncrementalDocument::mapMainOffset(size_t Offset) const {
+  // Text outside of function bodies is not edited between rebuilds, it only
+  // moves by the edits of preceding bodies.
+  auto It = std::upper_bound(
+      Funcs.begin(), Funcs.end(), Offset,
+      [](size_t O, const FuncEntry &F) { return O < F.OrigEnd; });
+  if (It == Funcs.begin())
+    return Offset;
+  --It;
+  return Offset + It->End - It->OrigEnd;
+}
+
+DocumentDiagnostic
+IncrementalDocument::resolve(const StoredDiagnostic &D, int64_t Offset) const {
+  auto O = size_t(std::max<int64_t>(
+      0, std::min<int64_t>(Offset, int64_t(Text.size()))));
+  auto It = std::upper_bound(LineStarts.begin(), LineStarts.end(), O);
+  unsigned Line = It - LineStarts.begin() - 1;
+
+  auto isIdentChar = [](char C) {
+    return std::isalnum(static_cast<unsigned char>(C)) || C == '_';
+  };
+  auto End = O;
+  while (End < Text.size() && isIdentChar(Text[End]))
+    End++;
+  return {D.Kind, D.Message, Line, unsigned(O - LineStarts[Line]),
+          unsigned(std::max<size_t>(End - O, 1))};
+}
+
+std::vector<DocumentDiagnostic> IncrementalDocument::getDiagnostics() const {
+  std::vector<DocumentDiagnostic> Ret;
+  for (auto &D : GlobalDiags)
+    Ret.push_back(resolve(D, mapMainOffset(D.Offset)));
+  for (auto &F : Funcs)
+    for (auto &D : F.Diags)
+      Ret.push_back(resolve(D, int64_t(F.Begin) + D.Offset));
+
+  using DD = DocumentDiagnostic;
+  std::stable_sort(Ret.begin(), Ret.end(), [](const DD &L, const DD &R) {
+    return std::tie(L.Line, L.Column) < std::tie(R.Line, R.Column);
+  });
+  return Ret;
+}
@@ -0,0 +1,229 @@
+//===--- Linker.cpp -------------------------------------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Frontend/Linker.h"
+#include "dusk/Basic/TimeTrace.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+#ifdef DUSK_HAVE_LLD
+#include "lld/Common/Driver.h"
+#endif
+
+using namespace dusk;
+
+/// Returns directory containing the standard library, or an empty string
+/// if it should be found in the default search paths.
+static std::string getStdlibPath() {
+  if (auto P = std::getenv("DUSK_STDLIB_PATH"))
+    return P;
+#ifdef DUSK_STDLIB_DIR
+  return DUSK_STDLIB_DIR;
+#else
+  return "";
+#endif
+}
+
+/// Links \c ObjFiles into \c Out using the system \c clang++ driver.
+static bool linkWithDriver(ArrayRef<std::string> ObjFiles, StringRef Out,
+                           raw_ostream &OS) {
+  auto Clang = llvm::sys::findProgramByName("clang++");
+  if (!Clang) {
+    OS << "duskc: error: unable to find 'clang++' to link '" << Out << "'\n";
+    return false;
+  }
+
+  std::string LibPath;
+  auto Stdlib = getStdlibPath();
+  if (!Stdlib.empty())
+    LibPath = "-L" + Stdlib;
+
+  SmallVector<StringRef, 8> Args{*Clang};
+  Args.append(ObjFiles.begin(), ObjFiles.end());
+  if (!LibPath.empty())
+    Args.push_back(LibPath);
+  Args.append({"-lstddusk", "-o", Out});
+
+  std::string Err;
+  if (llvm::sys::ExecuteAndWait(*Clang, Args, llvm::None, {}, 0, 0, &Err) !=
+      0) {
+    OS << "duskc: error: linking of '" << Out << "' failed";
+    if (!Err.empty())
+      OS << ": " << Err;
+    OS << "\n";
+    return false;
+  }
+  return true;
+}
+
+/// Combines \c Parts into \c Out using the system \c ld.
+static bool mergeWithDriver(ArrayRef<std::string> Parts, StringRef Out,
+                            raw_ostream &OS) {
+  auto Linker = llvm::sys::findProgramByName("ld");
+  if (!Linker) {
+    OS << "Could not find 'ld' to combine partial object files.\n";
+    return false;
+  }
+
+  SmallVector<StringRef, 16> Args{*Linker, "-r", "-o", Out};
+  Args.append(Parts.begin(), Parts.end());
+
+  std::string Err;
+  if (llvm::sys::ExecuteAndWait(*Linker, Args, llvm::None, {}, 0, 0,
+                                &Err) != 0) {
+    OS << "Could not combine partial object files into '" << Out << "'";
+    if (!Err.empty())
+      OS << ": " << Err;
+    OS << "\n";
+    return false;
+  }
+  return true;
+}
+
+#ifdef DUSK_HAVE_LLD
+
+/// lld keeps its state in globals, only a single link may run at a time.
+static std::mutex LLDLock;
+
+/// Returns path of the C runtime file \c Name in \c Dir.
+static std::string getCRTFile(StringRef Dir, StringRef Name) {
+  SmallString<128> Path(Dir);
+  llvm::sys::path::append(Path, Name);
+  return Path.str().str();
+}
+
+/// \brief Links \c ObjFiles into \c Out by lld running in the compiler
+/// process.
+///
+/// \return \c false, if the host is not supported, files of the C runtime
+///   are not found where expected or the link fails. Errors of the link are
+///   reported into \c OS.
+static bool linkWithLLD(ArrayRef<std::string> ObjFiles, StringRef Out,
+                        raw_ostream &OS) {
+  llvm::Triple Host(llvm::sys::getProcessTriple());
+  StringRef Emulation, DynamicLinker;
+  if (!Host.isOSLinux() || !Host.isGNUEnvironment())
+    return false;
+  switch (Host.getArch()) {
+  case llvm::Triple::x86_64:
+    Emulation = "elf_x86_64";
+    DynamicLinker = "/lib64/ld-linux-x86-64.so.2";
+    break;
+  case llvm::Triple::aarch64:
+    Emulation = "aarch64linux";
+    DynamicLinker = "/lib/ld-linux-aarch64.so.1";
+    break;
+  default:
+    return false;
+  }
+
+  auto Crt1 = getCRTFile(DUSK_CRT_DIR, "crt1.o");
+  auto Crti = getCRTFile(DUSK_CRT_DIR, "crti.o");
+  auto Crtn = getCRTFile(DUSK_CRT_DIR, "crtn.o");
+  auto CrtBegin = getCRTFile(DUSK_GCC_CRT_DIR, "crtbegin.o");
+  auto CrtEnd = getCRTFile(DUSK_GCC_CRT_DIR, "crtend.o");
+  // Layout of the C runtime differs between distributions, e.g. the dynamic
+  // linker of merged /usr systems, the driver knows better where to look.
+  for (auto &F : {DynamicLinker.str(), Crt1, Crti, Crtn, CrtBegin, CrtEnd})
+    if (!llvm::sys::fs::exists(F))
+      return false;
+  auto Output = Out.str();
+  auto Stdlib = getStdlibPath();
+
+  SmallVector<const char *, 32> Args{"ld.lld",
+                                     "--eh-frame-hdr",
+                                     "-m",
+                                     Emulation.data(),
+                                     "-dynamic-linker",
+                                     DynamicLinker.data(),
+                                     "-o",
+                                     Output.c_str(),
+                                     Crt1.c_str(),
+                                     Crti.c_str(),
+                                     CrtBegin.c_str()};
+  for (auto &Obj : ObjFiles)
+    Args.push_back(Obj.c_str());
+  if (!Stdlib.empty())
+    Args.append({"-L", Stdlib.c_str()});
+  // Runtime is linked statically, the executable depends only on libc.
+  Args.append({"-l:libstddusk.a", "-L", DUSK_CRT_DIR, "-lc", CrtEnd.c_str(),
+               Crtn.c_str()});
+
+  std::lock_guard<std::mutex> Guard(LLDLock);
+  if (!lld::elf::link(Args, /*CanExitEarly=*/false, OS)) {
+    OS << "duskc: error: linking of '" << Out << "' by lld failed\n";
+    return false;
+  }
+  return true;
+}
+
+/// Combines \c Parts into \c Out by a relocatable link of lld running in
+/// the compiler process. Errors of the link are reported into \c OS.
+static bool mergeWithLLD(ArrayRef<std::string> Parts, StringRef Out,
+                         raw_ostream &OS) {
+  // The target is taken from the partial objects, no emulation is needed.
+  auto Output = Out.str();
+  SmallVector<const char *, 16> Args{"ld.lld", "-r", "-o", Output.c_str()};
+  for (auto &P : Parts)
+    Args.push_back(P.c_str());
+
+  std::lock_guard<std::mutex> Guard(LLDLock);
+  if (!lld::elf::link(Args, /*CanExitEarly=*/false, OS)) {
+    OS << "Could not combine partial object files into '" << Out
+       << "' by lld\n";
+    return false;
+  }
+  return true;
+}
+
+#endif
+
+bool dusk::linkExecutable(ArrayRef<std::string> ObjFiles, StringRef Out,
+                          raw_ostream &OS) {
+  TimeTraceScope Trace("Link", Out);
+#ifdef DUSK_HAVE_LLD
+  // Errors of lld are reported only if the system driver fails as well.
+  std::string Errors;
+  llvm::raw_string_ostream ErrorsOS(Errors);
+  if (linkWithLLD(ObjFiles, Out, ErrorsOS))
+    return true;
+  if (linkWithDriver(ObjFiles, Out, OS))
+    return true;
+  OS << ErrorsOS.str();
+  return false;
+#else
+  return linkWithDriver(ObjFiles, Out, OS);
+#endif
+}
+
+bool dusk::mergeObjectFiles(ArrayRef<std::string> Parts, StringRef Out,
+                            raw_ostream &OS) {
+  TimeTraceScope Trace("MergeObjects", Out);
+#ifdef DUSK_HAVE_LLD
+  // Errors of lld are reported only if the system linker fails as well.
+  std::string Errors;
+  llvm::raw_string_ostream ErrorsOS(Errors);
+  if (mergeWithLLD(Parts, Out, ErrorsOS))
+    return true;
+  if (mergeWithDriver(Parts, Out, OS))
+    return true;
+  OS << ErrorsOS.str();
+  return false;
+#else
+  return mergeWithDriver(Parts, Out, OS);
+#endif
+}
@@ -57,7 +57,7 @@ static void initLocal(IRGenModule &IRGM, Decl *DD, IntType *Ty) {
   auto D = dynamic_cast<ValDecl *>(DD);
   if (!D || !D->hasValue())
     return;
-  auto Addr = IRGM.getVal(D->getName());
+  auto Addr = IRGM.getVal(D);
   if (D->hasValue())
     IRGM.Builder.CreateStore(IRGM.emitRValue(D->getValue()), Addr);
   else
@@ -68,7 +68,7 @@ static void initLocal(IRGenModule &IRGM, Decl *DD, ArrayType *Ty) {
   auto D = dynamic_cast<ValDecl *>(DD);
   if (!D || !D->hasValue())
     return;
-  auto Addr = IRGM.getVal(D->getName());
+  auto Addr = IRGM.getVal(D);
   auto Val = IRGM.emitRValue(D->getValue());
   IRGM.Builder.CreateStore(Val, Addr);
 }
@@ -94,6 +94,33 @@ Address irgen::codegenDeclGlobal(IRGenModule &IRGM, Decl *D) {
   return GV;
 }
 
+Address irgen::codegenDeclExternal(IRGenModule &IRGM, Decl *D) {
+  assert(IRGM.Vals.count(D) == 0 && "Redeclaration of value");
+  auto GV = new llvm::GlobalVariable(
+      *IRGM.Module, codegenGlobalType(IRGM, D), false,
+      llvm::GlobalValue::ExternalLinkage, nullptr, getGlobalSymbolName(D));
+  GV->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  IRGM.Vals[D] = GV;
+  return GV;
+}
+
+llvm::Type *irgen::codegenGlobalType(IRGenModule &IRGM, Decl *D) {
+  auto Ty = codegenType(IRGM, D->getType());
+  if (D->getType()->isRefType())
+    Ty = llvm::PointerType::get(Ty, 0);
+  return Ty;
+}
+
+std::string irgen::getGlobalSymbolName(Decl *D) {
+  return getGlobalSymbolName(D->getName());
+}
+
+std::string irgen::getGlobalSymbolName(StringRef Name) {
+  // Prefixed, so that globals do not clash with functions or runtime symbols
+  // once they are visible to the linker.
+  return ("__dusk_global." + Name).str();
+}
+
 Address irgen::codegenDeclLocal(IRGenModule &IRGM, Decl *D) {
   auto Addr = codegenAlloca(IRGM, D->getType());
   IRGM.Vals[D] = Addr;
@@ -102,11 +129,6 @@ Address irgen::codegenDeclLocal(IRGenModule &IRGM, Decl *D) {
 }
 
 Address irgen::codegenDecl(IRGenModule &IRGM, Decl *D) {
-  assert(IRGM.Lookup.declareVar(D) && "Redeclaration of value");
-
-  if (IRGM.Lookup.getDepth() == 0) {
-    return codegenDeclGlobal(IRGM, D);
-  } else {
-    return codegenDeclLocal(IRGM, D);
-  }
+  assert(IRGM.Vals.count(D) == 0 && "Redeclaration of value");
+  return codegenDeclLocal(IRGM, D);
 }
@@ -11,8 +11,10 @@
 #define DUSK_IRGEN_GEN_DECL_H
 
 #include "Address.h"
+#include <string>
 
 namespace llvm {
+class Type;
 class Value;
 }
 
@@ -27,6 +29,16 @@ namespace irgen {
 class IRGenModule;
 
 Address codegenDeclGlobal(IRGenModule &IRGM, Decl *D);
+Address codegenDeclExternal(IRGenModule &IRGM, Decl *D);
+
+/// Returns type of the storage of a global value \c D.
+llvm::Type *codegenGlobalType(IRGenModule &IRGM, Decl *D);
+
+/// Returns symbol name of a global value \c D shared between partial modules.
+std::string getGlobalSymbolName(Decl *D);
+/// Returns symbol name of a global value named \c Name shared between
+/// partial modules.
+std::string getGlobalSymbolName(StringRef Name);
 Address codegenDeclLocal(IRGenModule &IRGM, Decl *D);
 Address codegenDecl(IRGenModule &IRGM, Decl *D);
 
@@ -135,7 +135,6 @@ public:
   GenFunc(IRGenFunc &IRGF) : IRGF(IRGF) {}
 
   Address declareValDecl(ValDecl *D) {
-    IRGF.IRGM.Lookup.declareVar(D);
     auto Ty = codegenType(IRGF.IRGM, D->getType());
     auto Addr = IRGF.IRGM.Builder.CreateAlloca(Ty);
 
@@ -209,20 +208,16 @@ public:
 
     // Emit Then branch
     IRGF.Builder.SetInsertPoint(ThenBB);
-    IRGF.IRGM.Lookup.push();
     if (!super::visit(S->getThen()))
       return false;
-    IRGF.IRGM.Lookup.pop();
     if (IRGF.Builder.GetInsertBlock()->getTerminator() == nullptr)
       IRGF.Builder.CreateBr(ContBB);
 
     // Emit else branch
     if (S->hasElseBlock()) {
       IRGF.Builder.SetInsertPoint(ElseBB);
-      IRGF.IRGM.Lookup.push();
       if (!super::visit(S->getElse()))
         return false;
-      IRGF.IRGM.Lookup.pop();
       if (IRGF.Builder.GetInsertBlock()->getTerminator() == nullptr)
         IRGF.Builder.CreateBr(ContBB);
     } else {
@@ -241,7 +236,6 @@ public:
     auto BodyBlock =
         llvm::BasicBlock::Create(IRGF.IRGM.LLVMContext, "loop.body");
     auto EndBlock = llvm::BasicBlock::Create(IRGF.IRGM.LLVMContext, "loop.end");
-    IRGF.IRGM.Lookup.push();
     LoopInfoRAII Push(IRGF.LoopStack, HeaderBlock, EndBlock);
 
     // Add block to function.
@@ -263,7 +257,6 @@ public:
       IRGF.Builder.CreateBr(HeaderBlock);
 
     IRGF.Builder.SetInsertPoint(EndBlock);
-    IRGF.IRGM.Lookup.pop();
     return true;
   }
                                   
@@ -274,7 +267,6 @@ public:
     auto BodyBlock =
         llvm::BasicBlock::Create(IRGF.IRGM.LLVMContext, "loop.body");
     auto EndBlock = llvm::BasicBlock::Create(IRGF.IRGM.LLVMContext, "loop.end");
-    IRGF.IRGM.Lookup.push();
     LoopInfoRAII Push(IRGF.LoopStack, HeaderBlock, EndBlock);
 
     // Add block to function.
@@ -301,7 +293,6 @@ public:
     IRGF.IRGM.Builder.CreateBr(HeaderBlock);
 
     IRGF.Builder.SetInsertPoint(EndBlock);
-    IRGF.IRGM.Lookup.pop();
     return true;
   }
 
@@ -311,6 +302,7 @@ public:
   bool visitExternStmt(ExternStmt *S) { return true; }
   bool visitFuncDecl(FuncDecl *S) { return true; }
   bool visitModuleDecl(ModuleDecl *D) { return true; }
+  bool visitImportDecl(ImportDecl *D) { return true; }
   bool visitParamDecl(ParamDecl *D) { return true; }
 
 #define EXPR(CLASS, PARENT)                                                    \
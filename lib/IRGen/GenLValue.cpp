@@ -31,7 +31,7 @@ public:
 
 private:
   LValue visitIdentifierExpr(IdentifierExpr *E) {
-    auto Addr = IRGM.getVal(E->getName());
+    auto Addr = IRGM.getVal(E->getDecl());
     return LValue::getVal(E->getType(), Addr.getAddress());
   }
   
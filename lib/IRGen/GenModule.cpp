@@ -14,12 +14,14 @@
 #include "dusk/AST/Stmt.h"
 #include "dusk/AST/Type.h"
 #include "dusk/AST/ASTWalker.h"
+#include "dusk/Basic/TimeTrace.h"
 
 #include "IRGenModule.h"
 #include "IRGenFunc.h"
 #include "GenFunc.h"
 #include "GenExpr.h"
 #include "GenType.h"
+#include "GenDecl.h"
 
 using namespace dusk;
 using namespace irgen;
@@ -72,15 +74,24 @@ public:
 } // anonymous namespace
 
 static void codegenValDecl(IRGenModule &IRGM, ValDecl *D) {
-  // Decalare variable
-  IRGM.Lookup.declareVar(D);
   // Get LLVM type and create a global variable object
-  auto Ty = codegenType(IRGM, D->getType());
-  if (D->getType()->isRefType())
-    Ty = llvm::PointerType::get(Ty, 0);
-  auto GV = new llvm::GlobalVariable(*IRGM.Module, Ty, false,
-                                     llvm::GlobalValue::InternalLinkage,
-                                     nullptr, D->getName());
+  auto Ty = codegenGlobalType(IRGM, D);
+  llvm::GlobalVariable *GV;
+  if (IRGM.IsPartial) {
+    // Global is referenced from other parts of the program. Functions of
+    // the same unit may have already declared it.
+    auto Name = getGlobalSymbolName(D);
+    GV = IRGM.Module->getGlobalVariable(Name);
+    if (!GV)
+      GV = new llvm::GlobalVariable(*IRGM.Module, Ty, false,
+                                    llvm::GlobalValue::ExternalLinkage,
+                                    nullptr, Name);
+    GV->setVisibility(llvm::GlobalValue::HiddenVisibility);
+  } else {
+    GV = new llvm::GlobalVariable(*IRGM.Module, Ty, false,
+                                  llvm::GlobalValue::InternalLinkage, nullptr,
+                                  D->getName());
+  }
   // Get initial value
   llvm::Value *Val;
   if (D->hasValue())
@@ -93,8 +104,9 @@ static void codegenValDecl(IRGenModule &IRGM, ValDecl *D) {
 }
 
 static void codegenFuncStmt(IRGenModule &IRGM, FuncStmt *S) {
-  auto FnName = S->getPrototype()->getName();
-  IRGenFunc IRGF(IRGM, IRGM.Builder, IRGM.getFunc(FnName), S);
+  auto Fn = static_cast<FuncDecl *>(S->getPrototype());
+  TimeTraceScope Trace("IRGenFunction", Fn->getName());
+  IRGenFunc IRGF(IRGM, IRGM.Builder, IRGM.getFunc(Fn), S);
   genFunc(IRGF, S);
 }
 
@@ -106,6 +118,9 @@ static void codegenModule(IRGenModule &IRGM, ModuleDecl *D) {
       codegenFuncStmt(IRGM, S);
     else if (auto S = dynamic_cast<ExternStmt *>(N))
       continue;
+    // Imported declarations are emitted on their first use.
+    else if (auto I = dynamic_cast<ImportDecl *>(N))
+      continue;
     else
       llvm_unreachable("Unexpected node in module scope");
   }
@@ -117,3 +132,20 @@ void irgen::genModule(IRGenModule &IRGM) {
   Module->walk(FnDecl);
   codegenModule(IRGM, Module);
 }
+
+void irgen::genGlobals(IRGenModule &IRGM) {
+  assert(IRGM.IsPartial && "Globals are emitted with the whole module.");
+  for (auto N : IRGM.Context.getRootModule()->getContents())
+    if (auto D = dynamic_cast<ValDecl *>(N))
+      codegenValDecl(IRGM, D);
+}
+
+void irgen::genFuncDefinition(IRGenModule &IRGM, FuncStmt *S) {
+  assert(IRGM.IsPartial && "Functions are emitted with the whole module.");
+  codegenFuncStmt(IRGM, S);
+
+  // Forget locals of the function, its body may be released once emitted.
+  for (auto It = IRGM.Vals.begin(), E = IRGM.Vals.end(); It != E; ++It)
+    if (!llvm::isa<llvm::GlobalValue>(It->second.getAddress()))
+      IRGM.Vals.erase(It);
+}
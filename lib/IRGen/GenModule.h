@@ -15,11 +15,20 @@
 #include "IRGenValue.h"
 
 namespace dusk {
+class FuncStmt;
+
 namespace irgen {
 class IRGenModule;
 
+/// Emits the whole program into a single module.
 void genModule(IRGenModule &IRGM);
 
+/// Emits definitions of all global values into a partial module.
+void genGlobals(IRGenModule &IRGM);
+
+/// Emits definition of a single function into a partial module.
+void genFuncDefinition(IRGenModule &IRGM, FuncStmt *S);
+
 } // namesapce irgen
 } // namespace dusk
 
@@ -97,7 +97,7 @@ private:
   }
 
   RValue visitIdentifierExpr(IdentifierExpr *E) {
-    auto Addr = IRGM.getVal(E->getName());
+    auto Addr = IRGM.getVal(E->getDecl());
     auto Value = IRGM.Builder.CreateLoad(Addr, E->getName() + ".load");
     return RValue::get(E->getType(), Value);
   }
@@ -231,7 +231,7 @@ private:
 
   RValue visitCallExpr(CallExpr *E) {
     // Extract callee and arguments
-    auto Callee = IRGM.getFunc(E->getCallee()->getIdentifierExpr()->getName());
+    auto Callee = IRGM.getFunc(E->getCalleeDecl());
     auto ArgsPttrn = E->getArgs()->getExprPattern();
 
     // Emit values for arguments
@@ -15,7 +15,6 @@
 #include "dusk/AST/Pattern.h"
 #include "dusk/AST/Type.h"
 #include "dusk/AST/Decl.h"
-#include "dusk/AST/NameLookup.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/IRBuilder.h"
@@ -46,7 +45,6 @@ IRGenFunc::IRGenFunc(IRGenModule &IRGM, llvm::IRBuilder<> &B, llvm::Function *F,
 IRGenFunc::~IRGenFunc() { emitRet(); }
 
 void IRGenFunc::emitHeader() {
-  IRGM.Lookup.push();
   Builder.SetInsertPoint(HeaderBlock);
 
   // Create a return value if necessary
@@ -56,7 +54,6 @@ void IRGenFunc::emitHeader() {
   unsigned idx = 0;
   auto Args = Proto->getArgs()->getVars();
   for (auto &Arg : Fn->args()) {
-    IRGM.Lookup.declareVar(Args[idx]);
     auto Ty = codegenType(IRGM, Args[idx]->getType());
 
     // Reference type
@@ -88,13 +85,12 @@ void IRGenFunc::emitRet() {
   } else {
     Builder.CreateRetVoid();
   }
-  IRGM.Lookup.pop();
 }
 
 void IRGenFunc::setRetVal(llvm::Value *V) { Builder.CreateStore(V, RetValue); }
 
 Address IRGenFunc::declare(Decl *N) { return IRGM.declareVal(N); }
 
-Address IRGenFunc::getVal(StringRef N) { return IRGM.getVal(N); }
+Address IRGenFunc::getVal(Decl *D) { return IRGM.getVal(D); }
 
-llvm::Function *IRGenFunc::getFunc(StringRef N) { return IRGM.getFunc(N); }
+llvm::Function *IRGenFunc::getFunc(FuncDecl *D) { return IRGM.getFunc(D); }
@@ -86,9 +86,9 @@ public:
 
   Address declare(Decl *N);
 
-  Address getVal(StringRef N);
+  Address getVal(Decl *D);
 
-  llvm::Function *getFunc(StringRef N);
+  llvm::Function *getFunc(FuncDecl *D);
 
 private:
   /// Emits function header block.
@@ -30,13 +30,14 @@ using namespace dusk;
 using namespace irgen;
 
 IRGenModule::IRGenModule(ASTContext &Ctx, llvm::LLVMContext &LLVMCtx,
-                         llvm::Module *M, llvm::IRBuilder<> &B)
-    : Context(Ctx), LLVMContext(LLVMCtx), Module(M), Builder(B) {}
+                         llvm::Module *M, llvm::IRBuilder<> &B, bool IsPartial)
+    : Context(Ctx), LLVMContext(LLVMCtx), Module(M), Builder(B),
+      IsPartial(IsPartial) {}
 
 Address IRGenModule::declareVal(Decl *D) { return codegenDecl(*this, D); }
 
 Address IRGenModule::declareFunc(FuncDecl *D) {
-  if (Lookup.contains(D->getName()))
+  if (Funcs.count(D) != 0)
     llvm_unreachable("Redefinition of a function");
 
   auto FnTy = static_cast<FunctionType *>(D->getType());
@@ -56,14 +57,36 @@ Address IRGenModule::declareFunc(FuncDecl *D) {
   auto Proto = llvm::FunctionType::get(RetTy, Args, false);
   auto Fn = llvm::Function::Create(Proto, llvm::Function::ExternalLinkage,
                                    D->getName(), Module);
-  Lookup.declareFunc(D);
+  Funcs[D] = Fn;
   return Fn;
 }
 
-Address IRGenModule::getVal(StringRef N) {
-  if (auto Val = Vals[Lookup.getVal(N)])
-    return Val;
-  return Module->getGlobalVariable(N, true);
+Address IRGenModule::declareExternalVal(Decl *D) {
+  return codegenDeclExternal(*this, D);
+}
+
+Address IRGenModule::getVal(Decl *D) {
+  auto It = Vals.find(D);
+  if (It != Vals.end())
+    return It->second;
+  // Constants of imported modules are not exported by them, each user gets
+  // its own copy.
+  if (D->isImported())
+    return codegenDeclGlobal(*this, D);
+  // Local values are always declared before use, this must be a global
+  // defined by another part of the program.
+  assert(IsPartial && "Use of undeclared value");
+  return declareExternalVal(D);
+}
+
+llvm::Function *IRGenModule::getFunc(FuncDecl *D) {
+  auto It = Funcs.find(D);
+  if (It != Funcs.end())
+    return It->second;
+  // Functions of other parts of the program and of imported modules are
+  // declared on the first use.
+  assert((IsPartial || D->isImported()) && "Use of undeclared function");
+  return llvm::cast<llvm::Function>(declareFunc(D).getAddress());
 }
 
 llvm::Function *IRGenModule::getFunc(StringRef N) {
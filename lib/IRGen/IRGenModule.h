@@ -11,7 +11,6 @@
 #define DUSK_IRGEN_IRGEN_MODULE_H
 
 #include "dusk/Basic/LLVM.h"
-#include "dusk/AST/NameLookup.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/IR/IRBuilder.h"
 
@@ -43,20 +42,34 @@ public:
   llvm::Module *Module;
   llvm::IRBuilder<> &Builder;
 
-  NameLookup Lookup;
   llvm::DenseMap<Decl *, Address> Vals;
 
+  /// Functions declared in the module.
+  llvm::DenseMap<FuncDecl *, llvm::Function *> Funcs;
+
+  /// \brief \c true if the module holds only a part of the program.
+  ///
+  /// Global values of a partial module are visible to other modules.
+  /// Functions and global values defined by other modules are declared on
+  /// their first use.
+  bool IsPartial;
+
   IRGenModule(ASTContext &Ctx, llvm::LLVMContext &LLVMCtx, llvm::Module *M,
-              llvm::IRBuilder<> &B);
+              llvm::IRBuilder<> &B, bool IsPartial = false);
 
-  /// Declares a global variable
+  /// Declares a local variable of the function being emitted.
   Address declareVal(Decl *D);
   /// Decalres a fuction.
   Address declareFunc(FuncDecl *D);
 
+  /// Declares a global value defined in another module.
+  Address declareExternalVal(Decl *D);
+
   /// Returns value of declared variable.
-  Address getVal(StringRef N);
+  Address getVal(Decl *D);
   /// Returns declared function.
+  llvm::Function *getFunc(FuncDecl *D);
+  /// Returns declared runtime function.
   llvm::Function *getFunc(StringRef N);
 
   /// Emits an R value.
@@ -9,10 +9,11 @@
 
 #include "dusk/AST/ASTVisitor.h"
 #include "dusk/AST/Scope.h"
-#include "dusk/AST/NameLookup.h"
+#include "dusk/Basic/TimeTrace.h"
 #include "dusk/IRGen/IRGenerator.h"
 #include "llvm/IR/BasicBlock.h"
 
+#include "GenDecl.h"
 #include "GenExpr.h"
 #include "IRGenModule.h"
 #include "GenModule.h"
@@ -26,9 +27,80 @@ IRGenerator::IRGenerator(ASTContext &C)
 IRGenerator::~IRGenerator() {}
 
 llvm::Module *IRGenerator::perform() {
+  TimeTraceScope Trace("IRGen");
   auto M = Context.getRootModule();
   Module = std::make_unique<llvm::Module>(M->getName(), LLVMContext);
   IRGenModule IRGM(Context, LLVMContext, Module.get(), Builder);
   genModule(IRGM);
   return Module.release();
 }
+
+IRGenUnit IRGenerator::performUnit() {
+  TimeTraceScope Trace("IRGen");
+  auto M = Context.getRootModule();
+  IRGenUnit Unit;
+  Unit.Context = std::make_unique<llvm::LLVMContext>();
+  Unit.Module = std::make_unique<llvm::Module>(M->getName(), *Unit.Context);
+  llvm::IRBuilder<> B(*Unit.Context);
+  IRGenModule IRGM(Context, *Unit.Context, Unit.Module.get(), B);
+  genModule(IRGM);
+  return Unit;
+}
+
+PartialIRGenerator::PartialIRGenerator(ASTContext &Ctx)
+    : Context(Ctx), NumFuncs(0), NumUnits(0) {
+  for (auto N : Context.getRootModule()->getContents())
+    if (auto S = dynamic_cast<ExternStmt *>(N))
+      Externs.push_back(static_cast<FuncDecl *>(S->getPrototype()));
+}
+
+PartialIRGenerator::~PartialIRGenerator() {}
+
+void PartialIRGenerator::startUnit() {
+  auto ModuleName = Context.getRootModule()->getName();
+  auto Name = (ModuleName + "." + Twine(NumUnits)).str();
+  LLVMContext = std::make_unique<llvm::LLVMContext>();
+  Module = std::make_unique<llvm::Module>(Name, *LLVMContext);
+  Builder = std::make_unique<llvm::IRBuilder<>>(*LLVMContext);
+  IRGM = std::make_unique<IRGenModule>(Context, *LLVMContext, Module.get(),
+                                       *Builder, /*IsPartial=*/true);
+  for (auto Fn : Externs)
+    IRGM->declareFunc(Fn);
+}
+
+void PartialIRGenerator::emitFunc(FuncStmt *S) {
+  if (!IRGM)
+    startUnit();
+  genFuncDefinition(*IRGM, S);
+  NumFuncs++;
+}
+
+void PartialIRGenerator::emitGlobals() {
+  if (!IRGM)
+    startUnit();
+  genGlobals(*IRGM);
+}
+
+IRGenUnit PartialIRGenerator::takeUnit() {
+  if (!IRGM)
+    startUnit();
+  // Module must not outlive its context.
+  IRGM.reset();
+  Builder.reset();
+  IRGenUnit Unit;
+  Unit.Context = std::move(LLVMContext);
+  Unit.Module = std::move(Module);
+  NumUnits++;
+  NumFuncs = 0;
+  return Unit;
+}
+
+void irgen::exportGlobals(llvm::Module &M) {
+  for (auto &GV : M.globals()) {
+    if (!GV.hasLocalLinkage())
+      continue;
+    GV.setName(getGlobalSymbolName(GV.getName()));
+    GV.setLinkage(llvm::GlobalValue::ExternalLinkage);
+    GV.setVisibility(llvm::GlobalValue::HiddenVisibility);
+  }
+}
@@ -0,0 +1,112 @@
+//===--- Bytecode.cpp - Dusk interpreter bytecode -------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Interpreter/Bytecode.h"
+
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+using namespace dusk;
+using namespace interp;
+
+namespace {
+
+enum class OperandFormat { N, A, AB, ABC, ABI, AI, AK, AG, AJ, J };
+
+} // anonymous namespace
+
+static OperandFormat getFormat(Opcode Op) {
+  switch (Op) {
+#define OPCODE(Id, Format)                                                     \
+  case Opcode::Id:                                                             \
+    return OperandFormat::Format;
+#include "dusk/Interpreter/Opcodes.def"
+  }
+  llvm_unreachable("All cases handeled");
+}
+
+StringRef interp::getOpcodeName(Opcode Op) {
+  switch (Op) {
+#define OPCODE(Id, Format)                                                     \
+  case Opcode::Id:                                                             \
+    return #Id;
+#include "dusk/Interpreter/Opcodes.def"
+  }
+  llvm_unreachable("All cases handeled");
+}
+
+static void printInstruction(raw_ostream &OS, const BytecodeModule &M,
+                             const Instruction &I) {
+  if (getFormat(I.Op) == OperandFormat::N) {
+    OS << getOpcodeName(I.Op) << "\n";
+    return;
+  }
+  OS << llvm::left_justify(getOpcodeName(I.Op), 12);
+  switch (getFormat(I.Op)) {
+  case OperandFormat::N:
+    break;
+  case OperandFormat::A:
+    OS << "r" << I.A;
+    break;
+  case OperandFormat::AB:
+    OS << "r" << I.A << ", r" << I.B;
+    break;
+  case OperandFormat::ABC:
+    if (I.Op == Opcode::Call)
+      OS << "r" << I.A << ", " << M.Functions[I.B].Name << ", r" << I.C;
+    else if (I.Op == Opcode::CallNative)
+      OS << "r" << I.A << ", " << M.Natives[I.B].Name << ", r" << I.C;
+    else
+      OS << "r" << I.A << ", r" << I.B << ", r" << I.C;
+    break;
+  case OperandFormat::ABI:
+    OS << "r" << I.A << ", r" << I.B << ", " << int16_t(I.C);
+    break;
+  case OperandFormat::AI:
+    OS << "r" << I.A << ", " << I.getImm();
+    break;
+  case OperandFormat::AK:
+    OS << "r" << I.A << ", k" << I.getImm();
+    break;
+  case OperandFormat::AG:
+    OS << "r" << I.A << ", g" << I.getImm();
+    break;
+  case OperandFormat::AJ:
+    OS << "r" << I.A << ", @" << I.getImm();
+    break;
+  case OperandFormat::J:
+    OS << "@" << I.getImm();
+    break;
+  }
+  OS << "\n";
+}
+
+int64_t *BytecodeModule::allocateArray(size_t Size) {
+  Storage.emplace_back(new int64_t[Size ? Size : 1]());
+  return Storage.back().get();
+}
+
+void BytecodeModule::print(raw_ostream &OS) const {
+  for (size_t i = 0; i < Globals.size(); i++)
+    OS << "g" << i << " = " << Globals[i] << "\n";
+  for (auto &N : Natives)
+    OS << "native " << N.Name << "(" << N.NumParams << ")\n";
+
+  for (auto &F : Functions) {
+    OS << "\nfunc " << F.Name << "(" << F.NumParams << "): " << F.NumRegs
+       << " registers, " << F.FrameSize << " cells\n";
+    for (size_t i = 0; i < F.Constants.size(); i++)
+      OS << "  k" << i << " = " << F.Constants[i] << "\n";
+    for (size_t i = 0; i < F.Code.size(); i++) {
+      OS << llvm::format("  %4zu  ", i);
+      printInstruction(OS, *this, F.Code[i]);
+    }
+  }
+}
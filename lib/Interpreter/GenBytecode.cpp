@@ -0,0 +1,830 @@
+//===--- GenBytecode.cpp - Lowering of AST into bytecode ------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Interpreter/Interpreter.h"
+
+#include "dusk/AST/ASTContext.h"
+#include "dusk/AST/ASTVisitor.h"
+#include "dusk/AST/Decl.h"
+#include "dusk/AST/Expr.h"
+#include "dusk/AST/Pattern.h"
+#include "dusk/AST/Stmt.h"
+#include "dusk/AST/Type.h"
+#include "dusk/Basic/TimeTrace.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+using namespace dusk;
+using namespace interp;
+
+/// Returns number of cells occupied by a value of type \c Ty stored in
+/// an array.
+static size_t getNumCells(Type *Ty) {
+  switch (Ty->getKind()) {
+  case TypeKind::Array:
+    return Ty->getArrayType()->getSize() *
+           getNumCells(Ty->getArrayType()->getBaseType());
+  case TypeKind::InOut:
+    return getNumCells(Ty->getInOutType()->getBaseType());
+  default:
+    return 1;
+  }
+}
+
+static Type *getRetType(FuncDecl *D) {
+  return static_cast<FunctionType *>(D->getType())->getRetType();
+}
+
+/// Returns \c true if evaluation of \c E may assign a value to a variable.
+static bool hasAssign(Expr *E) {
+  if (!E)
+    return false;
+  if (dynamic_cast<AssignExpr *>(E))
+    return true;
+  if (auto I = dynamic_cast<InfixExpr *>(E))
+    return hasAssign(I->getLHS()) || hasAssign(I->getRHS());
+  if (auto P = dynamic_cast<PrefixExpr *>(E))
+    return hasAssign(P->getDest());
+  if (auto P = dynamic_cast<ParenExpr *>(E))
+    return hasAssign(P->getExpr());
+  if (auto IO = dynamic_cast<InOutExpr *>(E))
+    return hasAssign(IO->getBase());
+  if (auto S = dynamic_cast<SubscriptExpr *>(E))
+    return hasAssign(S->getBase()) ||
+           hasAssign(S->getSubscript()->getSubscriptStmt()->getValue());
+  if (auto C = dynamic_cast<CallExpr *>(E))
+    return llvm::any_of(C->getArgs()->getExprPattern()->getValues(), hasAssign);
+  if (auto L = dynamic_cast<ArrayLiteralExpr *>(E))
+    return llvm::any_of(L->getValues()->getExprPattern()->getValues(),
+                        hasAssign);
+  return false;
+}
+
+/// Evaluates \c E if it's a constant expression.
+static bool evaluateConstant(Expr *E, int64_t &Value) {
+  if (auto N = dynamic_cast<NumberLiteralExpr *>(E)) {
+    Value = N->getValue();
+    return true;
+  }
+  if (auto P = dynamic_cast<ParenExpr *>(E))
+    return evaluateConstant(P->getExpr(), Value);
+
+  if (auto P = dynamic_cast<PrefixExpr *>(E)) {
+    if (!evaluateConstant(P->getDest(), Value))
+      return false;
+    // Wraps around the same way as the generated code.
+    Value = P->getOp().is(tok::minus) ? int64_t(0 - uint64_t(Value)) : ~Value;
+    return true;
+  }
+
+  auto I = dynamic_cast<InfixExpr *>(E);
+  int64_t L, R;
+  // True is represented by all bits set, the same as in the generated code.
+  if (!I || !evaluateConstant(I->getLHS(), L) ||
+      !evaluateConstant(I->getRHS(), R))
+    return false;
+  switch (I->getOp().getKind()) {
+  case tok::plus:
+    Value = int64_t(uint64_t(L) + uint64_t(R));
+    return true;
+  case tok::minus:
+    Value = int64_t(uint64_t(L) - uint64_t(R));
+    return true;
+  case tok::multipy:
+    Value = int64_t(uint64_t(L) * uint64_t(R));
+    return true;
+  case tok::divide:
+  case tok::mod:
+    // Left for the run time, which reports the division by zero.
+    if (R == 0 || (L == std::numeric_limits<int64_t>::min() && R == -1))
+      return false;
+    Value = I->getOp().is(tok::divide) ? L / R : L % R;
+    return true;
+  case tok::lnot:
+  case tok::land:
+    Value = -int64_t(L != 0 && R != 0);
+    return true;
+  case tok::lor:
+    Value = -int64_t(L != 0 || R != 0);
+    return true;
+  case tok::equals:
+    Value = -int64_t(L == R);
+    return true;
+  case tok::nequals:
+    Value = -int64_t(L != R);
+    return true;
+  case tok::greater:
+    Value = -int64_t(L > R);
+    return true;
+  case tok::greater_eq:
+    Value = -int64_t(L >= R);
+    return true;
+  case tok::less:
+    Value = -int64_t(L < R);
+    return true;
+  case tok::less_eq:
+    Value = -int64_t(L <= R);
+    return true;
+  default:
+    return false;
+  }
+}
+
+static int64_t toCell(const int64_t *Ptr) {
+  return static_cast<int64_t>(reinterpret_cast<intptr_t>(Ptr));
+}
+
+namespace {
+
+/// Static storage of an array literal.
+struct LiteralStorage {
+  int64_t *Cells;
+
+  /// \c true if all elements are constant and the storage is therefore
+  /// initialized only once.
+  bool IsConstant;
+};
+
+/// State of the lowering shared by all functions of a module.
+class ModuleLowering {
+public:
+  raw_ostream &OS;
+  BytecodeModule &Module;
+
+  llvm::DenseMap<Decl *, unsigned> Functions;
+  llvm::DenseMap<Decl *, unsigned> Natives;
+  llvm::DenseMap<Decl *, unsigned> Globals;
+  llvm::DenseMap<Expr *, LiteralStorage> Literals;
+  bool IsError = false;
+
+  ModuleLowering(raw_ostream &OS, BytecodeModule &M) : OS(OS), Module(M) {}
+
+  void error(const Twine &Msg) {
+    OS << "duskc: error: " << Msg << "\n";
+    IsError = true;
+  }
+
+  /// Writes constant elements of literal \c E into \c Cells.
+  ///
+  /// \return \c true if all elements of the literal are constant.
+  bool initLiteral(ArrayLiteralExpr *E, int64_t *Cells) {
+    auto Values = E->getValues()->getExprPattern()->getValues();
+    auto Size = getNumCells(E->getType()->getArrayType()->getBaseType());
+    auto IsConstant = true;
+    for (size_t i = 0; i < Values.size(); i++) {
+      if (auto L = dynamic_cast<ArrayLiteralExpr *>(Values[i])) {
+        IsConstant &= initLiteral(L, Cells + i * Size);
+        continue;
+      }
+      int64_t Value;
+      if (Size == 1 && evaluateConstant(Values[i], Value))
+        Cells[i] = Value;
+      else
+        IsConstant = false;
+    }
+    return IsConstant;
+  }
+
+  /// Returns storage of literal \c E, which is shared by all its
+  /// evaluations, the same as a global of the generated code.
+  LiteralStorage getLiteral(ArrayLiteralExpr *E) {
+    auto It = Literals.find(E);
+    if (It != Literals.end())
+      return It->second;
+    auto Cells = Module.allocateArray(getNumCells(E->getType()));
+    LiteralStorage S{Cells, initLiteral(E, Cells)};
+    Literals[E] = S;
+    return S;
+  }
+
+  /// Defines a global value, which is initialized the same way as by
+  /// the generated code, i.e. only by a literal.
+  unsigned declareGlobal(ValDecl *D) {
+    int64_t Value = 0;
+    if (D->getType()->getKind() == TypeKind::Array) {
+      auto Cells = Module.allocateArray(getNumCells(D->getType()));
+      if (auto L = dynamic_cast<ArrayLiteralExpr *>(D->getValue()))
+        initLiteral(L, Cells);
+      Value = toCell(Cells);
+    } else if (auto N = dynamic_cast<NumberLiteralExpr *>(D->getValue())) {
+      Value = N->getValue();
+    }
+    auto Idx = static_cast<unsigned>(Module.Globals.size());
+    Module.Globals.push_back(Value);
+    Globals[D] = Idx;
+    return Idx;
+  }
+
+  /// Returns index of a global, constants of imported modules are copied
+  /// on the first use.
+  unsigned getGlobal(ValDecl *D) {
+    auto It = Globals.find(D);
+    if (It != Globals.end())
+      return It->second;
+    return declareGlobal(D);
+  }
+
+  void declareFunction(FuncDecl *D) {
+    BytecodeFunction Fn;
+    Fn.Name = D->getName().str();
+    Fn.NumParams = D->getArgs()->getVars().size();
+    Fn.ReturnsValue = !getRetType(D)->isVoidType();
+    Functions[D] = Module.Functions.size();
+    if (D->getName() == "main")
+      Module.Main = Module.Functions.size();
+    Module.Functions.push_back(std::move(Fn));
+  }
+
+  /// Returns index of native function \c D.
+  unsigned getNative(FuncDecl *D) {
+    auto It = Natives.find(D);
+    if (It != Natives.end())
+      return It->second;
+    NativeFunction Fn;
+    Fn.Name = D->getName().str();
+    Fn.NumParams = D->getArgs()->getVars().size();
+    Fn.ReturnsValue = !getRetType(D)->isVoidType();
+    auto Idx = static_cast<unsigned>(Module.Natives.size());
+    Module.Natives.push_back(std::move(Fn));
+    Natives[D] = Idx;
+    return Idx;
+  }
+};
+
+/// Lowers a single function.
+///
+/// Parameters and local values live in registers for the whole scope of
+/// their declaration, temporaries only until the end of the statement.
+class FunctionLowering : public ASTVisitor<FunctionLowering,
+                                           /* Decl */ bool,
+                                           /* Expr */ unsigned,
+                                           /* Stmt */ bool,
+                                           /* Pattern */ bool,
+                                           /* TypeRepr */ bool> {
+  typedef ASTVisitor super;
+
+  friend super;
+
+  /// Marks an unspecified result register.
+  static const int NoReg = -1;
+
+  ModuleLowering &ML;
+  BytecodeFunction &Fn;
+  llvm::DenseMap<Decl *, unsigned> Locals;
+
+  /// First register not occupied by a local value.
+  unsigned LocalsTop = 0;
+
+  /// First free register.
+  unsigned NextReg = 0;
+
+  /// Register requested for the result of the expression being lowered.
+  int ResultHint = NoReg;
+
+  /// Unresolved jumps of \c break statements of enclosing loops.
+  std::vector<std::vector<size_t>> Breaks;
+
+  llvm::DenseMap<int64_t, unsigned> ConstantIdxs;
+
+  /// Number of cells of local arrays.
+  uint32_t ArrayCells = 0;
+
+  bool IsTooLarge = false;
+
+public:
+  FunctionLowering(ModuleLowering &ML, BytecodeFunction &Fn)
+      : ML(ML), Fn(Fn) {}
+
+  void lower(FuncStmt *S) {
+    auto D = static_cast<FuncDecl *>(S->getPrototype());
+    for (auto P : D->getArgs()->getVars())
+      Locals[P] = allocReg();
+    LocalsTop = NextReg;
+    super::visit(S->getBody());
+
+    // Function without a return statement at its end.
+    if (Fn.ReturnsValue) {
+      auto R = allocReg();
+      emit(Instruction::getWithImm(Opcode::LoadI, R, 0));
+      emit({Opcode::Ret, uint16_t(R)});
+    } else {
+      emit({Opcode::RetVoid});
+    }
+
+    // Local arrays are placed right after registers.
+    for (auto &A : Fn.Arrays)
+      A.Offset += Fn.NumRegs;
+    Fn.FrameSize = Fn.NumRegs + ArrayCells;
+  }
+
+private:
+  // MARK: - Emission helpers
+
+  unsigned allocReg() {
+    if (NextReg > std::numeric_limits<uint16_t>::max()) {
+      if (!IsTooLarge)
+        ML.error("function '" + Fn.Name + "' is too large to be interpreted");
+      IsTooLarge = true;
+      return 0;
+    }
+    auto R = NextReg++;
+    Fn.NumRegs = std::max(Fn.NumRegs, NextReg);
+    return R;
+  }
+
+  /// Allocates register of a local value.
+  unsigned allocLocal() {
+    NextReg = LocalsTop;
+    auto R = allocReg();
+    LocalsTop = NextReg;
+    return R;
+  }
+
+  /// Returns register requested for the result of the expression, or
+  /// a new temporary.
+  unsigned getResultReg(int Hint) { return Hint != NoReg ? Hint : allocReg(); }
+
+  /// Returns the register requested for the result and clears the request.
+  int takeHint() {
+    auto Hint = ResultHint;
+    ResultHint = NoReg;
+    return Hint;
+  }
+
+  size_t emit(Instruction I) {
+    Fn.Code.push_back(I);
+    return Fn.Code.size() - 1;
+  }
+
+  int32_t getLabel() const { return static_cast<int32_t>(Fn.Code.size()); }
+
+  /// Emits a jump, which is resolved later by \c resolveJump.
+  size_t emitJump(Opcode Op, unsigned A = 0) {
+    return emit(Instruction::getWithImm(Op, A, -1));
+  }
+
+  /// Resolves jump \c J to the next emitted instruction.
+  void resolveJump(size_t J) { Fn.Code[J].setImm(getLabel()); }
+
+  void emitConstant(unsigned R, int64_t Value) {
+    if (Value >= std::numeric_limits<int32_t>::min() &&
+        Value <= std::numeric_limits<int32_t>::max()) {
+      emit(Instruction::getWithImm(Opcode::LoadI, R, int32_t(Value)));
+      return;
+    }
+    auto It = ConstantIdxs.find(Value);
+    if (It == ConstantIdxs.end()) {
+      It = ConstantIdxs.insert({Value, unsigned(Fn.Constants.size())}).first;
+      Fn.Constants.push_back(Value);
+    }
+    emit(Instruction::getWithImm(Opcode::LoadK, R, It->second));
+  }
+
+  /// Emits \c E and returns register holding its value, which is \c Dest if
+  /// specified.
+  unsigned emitExpr(Expr *E, int Dest = NoReg) {
+    ResultHint = Dest;
+    auto R = super::visit(E);
+    if (Dest != NoReg && R != unsigned(Dest)) {
+      emit({Opcode::Mov, uint16_t(Dest), uint16_t(R)});
+      return Dest;
+    }
+    return R;
+  }
+
+  /// Emits an operand, which is evaluated before \c Next and \c Last.
+  /// Local value is copied if they may assign to it, since the operand must
+  /// keep its original value.
+  unsigned emitOperand(Expr *E, Expr *Next, Expr *Last = nullptr) {
+    auto R = emitExpr(E);
+    if (R < LocalsTop && (hasAssign(Next) || hasAssign(Last))) {
+      auto Tmp = allocReg();
+      emit({Opcode::Mov, uint16_t(Tmp), uint16_t(R)});
+      return Tmp;
+    }
+    return R;
+  }
+
+  /// Emits address of element \c Idx of array \c Base with elements of
+  /// \c Size cells.
+  void emitElemAddr(unsigned R, unsigned Base, unsigned Idx, size_t Size) {
+    if (Size != 1) {
+      auto Scaled = allocReg();
+      emitConstant(Scaled, Size);
+      emit({Opcode::Mul, uint16_t(Scaled), uint16_t(Idx), uint16_t(Scaled)});
+      Idx = Scaled;
+    }
+    emit({Opcode::ElemAddr, uint16_t(R), uint16_t(Base), uint16_t(Idx)});
+  }
+
+  /// Emits copy of an array of \c Size cells.
+  void emitCopy(unsigned Dest, unsigned Src, size_t Size) {
+    auto Count = allocReg();
+    emitConstant(Count, Size);
+    emit({Opcode::Copy, uint16_t(Dest), uint16_t(Src), uint16_t(Count)});
+  }
+
+  // MARK: - Declarations
+
+  bool declareLocal(ValDecl *D) {
+    auto R = allocLocal();
+    if (D->hasValue()) {
+      emitExpr(D->getValue(), R);
+    } else if (D->getType()->getKind() == TypeKind::Array) {
+      FrameArray A{ArrayCells, uint32_t(getNumCells(D->getType()))};
+      ArrayCells += A.Size;
+      emit(Instruction::getWithImm(Opcode::FrameArray, R, Fn.Arrays.size()));
+      Fn.Arrays.push_back(A);
+    } else {
+      emit(Instruction::getWithImm(Opcode::LoadI, R, 0));
+    }
+    Locals[D] = R;
+    return true;
+  }
+
+  bool visitVarDecl(VarDecl *D) { return declareLocal(D); }
+  bool visitParamDecl(ParamDecl *D) { return true; }
+  bool visitFuncDecl(FuncDecl *D) { return true; }
+  bool visitImportDecl(ImportDecl *D) { return true; }
+  bool visitModuleDecl(ModuleDecl *D) { return true; }
+
+  // MARK: - Statements
+
+  void visitNode(ASTNode *N) {
+    if (auto D = dynamic_cast<Decl *>(N))
+      super::visit(D);
+    else if (auto E = dynamic_cast<Expr *>(N))
+      emitExpr(E);
+    else if (auto S = dynamic_cast<Stmt *>(N))
+      super::visit(S);
+    else
+      llvm_unreachable("Unexpected node.");
+    // Temporaries do not outlive the statement.
+    NextReg = LocalsTop;
+  }
+
+  bool visitBlockStmt(BlockStmt *S) {
+    auto Top = LocalsTop;
+    for (auto N : S->getNodes())
+      visitNode(N);
+    LocalsTop = NextReg = Top;
+    return true;
+  }
+
+  bool visitBreakStmt(BreakStmt *S) {
+    Breaks.back().push_back(emitJump(Opcode::Jmp));
+    return true;
+  }
+
+  bool visitReturnStmt(ReturnStmt *S) {
+    if (!Fn.ReturnsValue) {
+      emit({Opcode::RetVoid});
+      return true;
+    }
+    unsigned R;
+    if (S->getValue()) {
+      R = emitExpr(S->getValue());
+    } else {
+      R = allocReg();
+      emit(Instruction::getWithImm(Opcode::LoadI, R, 0));
+    }
+    emit({Opcode::Ret, uint16_t(R)});
+    return true;
+  }
+
+  bool visitIfStmt(IfStmt *S) {
+    auto Cond = emitExpr(S->getCond());
+    auto ToElse = emitJump(Opcode::JmpIfNot, Cond);
+    super::visit(S->getThen());
+    if (!S->hasElseBlock()) {
+      resolveJump(ToElse);
+      return true;
+    }
+    auto ToCont = emitJump(Opcode::Jmp);
+    resolveJump(ToElse);
+    super::visit(S->getElse());
+    resolveJump(ToCont);
+    return true;
+  }
+
+  bool visitWhileStmt(WhileStmt *S) {
+    // Condition is placed after the body, so that each iteration executes
+    // a single jump.
+    auto ToCond = emitJump(Opcode::Jmp);
+    auto Body = getLabel();
+    Breaks.emplace_back();
+    super::visit(S->getBody());
+
+    resolveJump(ToCond);
+    auto Cond = emitExpr(S->getCond());
+    emit(Instruction::getWithImm(Opcode::JmpIf, Cond, Body));
+    NextReg = LocalsTop;
+    for (auto J : Breaks.back())
+      resolveJump(J);
+    Breaks.pop_back();
+    return true;
+  }
+
+  bool visitForStmt(ForStmt *S) {
+    auto Top = LocalsTop;
+    auto Range = S->getRange()->getRangeStmt();
+    // Counter, size, step and the iterator occupy consecutive registers.
+    auto Loop = allocLocal();
+    for (unsigned i = 0; i < 3; i++)
+      allocLocal();
+    auto Start = emitExpr(Range->getStart());
+    auto End = emitExpr(Range->getEnd());
+    emit({Opcode::ForPrep, uint16_t(Loop), uint16_t(Start), uint16_t(End)});
+    if (Range->isInclusive())
+      emit({Opcode::AddI, uint16_t(Loop + 1), uint16_t(Loop + 1), 1});
+    Locals[S->getIter()] = Loop + 3;
+    NextReg = LocalsTop;
+
+    auto ToEnd = emitJump(Opcode::ForTest, Loop);
+    auto Body = getLabel();
+    Breaks.emplace_back();
+    super::visit(S->getBody());
+    emit(Instruction::getWithImm(Opcode::ForLoop, Loop, Body));
+
+    resolveJump(ToEnd);
+    for (auto J : Breaks.back())
+      resolveJump(J);
+    Breaks.pop_back();
+    LocalsTop = NextReg = Top;
+    return true;
+  }
+
+  bool visitFuncStmt(FuncStmt *S) { return true; }
+  bool visitRangeStmt(RangeStmt *S) { return true; }
+  bool visitSubscriptStmt(SubscriptStmt *S) { return true; }
+  bool visitExternStmt(ExternStmt *S) { return true; }
+
+  // MARK: - Expressions
+
+  unsigned visitNumberLiteralExpr(NumberLiteralExpr *E) {
+    auto R = getResultReg(takeHint());
+    emitConstant(R, E->getValue());
+    return R;
+  }
+
+  unsigned visitArrayLiteralExpr(ArrayLiteralExpr *E) {
+    auto Hint = takeHint();
+    auto Storage = ML.getLiteral(E);
+    // Elements may refer to the value the literal is assigned to.
+    auto R = Storage.IsConstant ? getResultReg(Hint) : allocReg();
+    emitConstant(R, toCell(Storage.Cells));
+    if (Storage.IsConstant)
+      return R;
+
+    // Elements, which are not constant, are stored on every evaluation.
+    auto Values = E->getValues()->getExprPattern()->getValues();
+    auto Size = getNumCells(E->getType()->getArrayType()->getBaseType());
+    for (size_t i = 0; i < Values.size(); i++) {
+      int64_t Value;
+      if (Size == 1 && evaluateConstant(Values[i], Value))
+        continue;
+      auto L = dynamic_cast<ArrayLiteralExpr *>(Values[i]);
+      if (L && ML.getLiteral(L).IsConstant)
+        continue;
+
+      auto Idx = allocReg();
+      emitConstant(Idx, i);
+      auto V = emitExpr(Values[i]);
+      if (Size == 1) {
+        emit({Opcode::Store, uint16_t(R), uint16_t(Idx), uint16_t(V)});
+      } else {
+        auto Addr = allocReg();
+        emitElemAddr(Addr, R, Idx, Size);
+        emitCopy(Addr, V, Size);
+      }
+    }
+    return R;
+  }
+
+  unsigned visitIdentifierExpr(IdentifierExpr *E) {
+    auto Hint = takeHint();
+    auto D = E->getDecl();
+    auto It = Locals.find(D);
+    if (It != Locals.end())
+      return It->second;
+
+    auto R = getResultReg(Hint);
+    auto G = ML.getGlobal(static_cast<ValDecl *>(D));
+    emit(Instruction::getWithImm(Opcode::LoadGlobal, R, G));
+    return R;
+  }
+
+  unsigned visitAssignExpr(AssignExpr *E) {
+    takeHint();
+    auto Dest = E->getDest();
+    if (auto P = dynamic_cast<ParenExpr *>(Dest))
+      Dest = P->getExpr();
+
+    if (auto I = dynamic_cast<IdentifierExpr *>(Dest)) {
+      auto It = Locals.find(I->getDecl());
+      if (It != Locals.end())
+        return emitExpr(E->getSource(), It->second);
+      auto G = ML.getGlobal(static_cast<ValDecl *>(I->getDecl()));
+      auto V = emitExpr(E->getSource());
+      emit(Instruction::getWithImm(Opcode::StoreGlobal, V, G));
+      return V;
+    }
+
+    auto S = static_cast<SubscriptExpr *>(Dest);
+    auto IdxExpr = S->getSubscript()->getSubscriptStmt()->getValue();
+    auto Base = emitOperand(S->getBase(), IdxExpr, E->getSource());
+    auto Idx = emitOperand(IdxExpr, E->getSource());
+    auto V = emitExpr(E->getSource());
+    auto Size = getNumCells(S->getType());
+    if (Size == 1) {
+      emit({Opcode::Store, uint16_t(Base), uint16_t(Idx), uint16_t(V)});
+    } else {
+      auto Addr = allocReg();
+      emitElemAddr(Addr, Base, Idx, Size);
+      emitCopy(Addr, V, Size);
+    }
+    return V;
+  }
+
+  unsigned visitInfixExpr(InfixExpr *E) {
+    auto Hint = takeHint();
+    Opcode Op;
+    switch (E->getOp().getKind()) {
+    case tok::plus:
+      Op = Opcode::Add;
+      break;
+    case tok::minus:
+      Op = Opcode::Sub;
+      break;
+    case tok::multipy:
+      Op = Opcode::Mul;
+      break;
+    case tok::divide:
+      Op = Opcode::Div;
+      break;
+    case tok::mod:
+      Op = Opcode::Rem;
+      break;
+    case tok::lnot:
+    case tok::land:
+      Op = Opcode::And;
+      break;
+    case tok::lor:
+      Op = Opcode::Or;
+      break;
+    case tok::equals:
+      Op = Opcode::Eq;
+      break;
+    case tok::nequals:
+      Op = Opcode::Ne;
+      break;
+    case tok::greater:
+      Op = Opcode::Gt;
+      break;
+    case tok::greater_eq:
+      Op = Opcode::Ge;
+      break;
+    case tok::less:
+      Op = Opcode::Lt;
+      break;
+    case tok::less_eq:
+      Op = Opcode::Le;
+      break;
+    default:
+      llvm_unreachable("Invalid infix operand");
+    }
+
+    // Addition of a small constant, e.g. `n - 1`, does not need
+    // a register for the constant.
+    int64_t Imm;
+    if ((Op == Opcode::Add || Op == Opcode::Sub) &&
+        evaluateConstant(E->getRHS(), Imm)) {
+      if (Op == Opcode::Sub)
+        Imm = -Imm;
+      if (Imm >= std::numeric_limits<int16_t>::min() &&
+          Imm <= std::numeric_limits<int16_t>::max()) {
+        auto L = emitExpr(E->getLHS());
+        auto R = getResultReg(Hint);
+        emit({Opcode::AddI, uint16_t(R), uint16_t(L), uint16_t(Imm)});
+        return R;
+      }
+    }
+
+    auto L = emitOperand(E->getLHS(), E->getRHS());
+    auto RHS = emitExpr(E->getRHS());
+    auto R = getResultReg(Hint);
+    emit({Op, uint16_t(R), uint16_t(L), uint16_t(RHS)});
+    return R;
+  }
+
+  unsigned visitPrefixExpr(PrefixExpr *E) {
+    auto Hint = takeHint();
+    auto V = emitExpr(E->getDest());
+    auto R = getResultReg(Hint);
+    switch (E->getOp().getKind()) {
+    case tok::lnot:
+      emit({Opcode::Not, uint16_t(R), uint16_t(V)});
+      break;
+    case tok::minus:
+      emit({Opcode::Neg, uint16_t(R), uint16_t(V)});
+      break;
+    default:
+      llvm_unreachable("Invalid prefix operand");
+    }
+    return R;
+  }
+
+  unsigned visitCallExpr(CallExpr *E) {
+    auto Hint = takeHint();
+    auto Callee = E->getCalleeDecl();
+    auto Args = E->getArgs()->getExprPattern()->getValues();
+
+    // Arguments are passed in consecutive registers.
+    auto First = NextReg;
+    for (size_t i = 0; i < Args.size(); i++)
+      allocReg();
+    for (size_t i = 0; i < Args.size(); i++)
+      emitExpr(Args[i], First + i);
+
+    unsigned R = Hint != NoReg ? Hint : First;
+    if (Hint == NoReg && !getRetType(Callee)->isVoidType())
+      R = allocReg();
+
+    auto It = ML.Functions.find(Callee);
+    if (It != ML.Functions.end()) {
+      emit({Opcode::Call, uint16_t(R), uint16_t(It->second), uint16_t(First)});
+    } else if (Callee->isImported()) {
+      ML.error("cannot interpret call of function '" + Callee->getName() +
+               "' of an imported module");
+    } else {
+      auto N = ML.getNative(Callee);
+      emit({Opcode::CallNative, uint16_t(R), uint16_t(N), uint16_t(First)});
+    }
+    return R;
+  }
+
+  unsigned visitSubscriptExpr(SubscriptExpr *E) {
+    auto Hint = takeHint();
+    auto IdxExpr = E->getSubscript()->getSubscriptStmt()->getValue();
+    auto Base = emitOperand(E->getBase(), IdxExpr);
+    auto Idx = emitExpr(IdxExpr);
+    auto R = getResultReg(Hint);
+    if (E->getType()->isRefType())
+      emitElemAddr(R, Base, Idx, getNumCells(E->getType()));
+    else
+      emit({Opcode::Load, uint16_t(R), uint16_t(Base), uint16_t(Idx)});
+    return R;
+  }
+
+  unsigned visitInOutExpr(InOutExpr *E) {
+    return emitExpr(E->getBase(), takeHint());
+  }
+
+  unsigned visitParenExpr(ParenExpr *E) {
+    return emitExpr(E->getExpr(), takeHint());
+  }
+};
+
+} // anonymous namespace
+
+BytecodeGenerator::BytecodeGenerator(ASTContext &Ctx, raw_ostream &OS)
+    : Context(Ctx), OS(OS) {}
+
+std::unique_ptr<BytecodeModule> BytecodeGenerator::perform() {
+  TimeTraceScope Trace("GenBytecode");
+  auto M = std::make_unique<BytecodeModule>();
+  ModuleLowering ML(OS, *M);
+
+  // Functions are declared first, since they may be called before their
+  // definition.
+  auto Contents = Context.getRootModule()->getContents();
+  for (auto N : Contents)
+    if (auto D = dynamic_cast<ValDecl *>(N))
+      ML.declareGlobal(D);
+    else if (auto S = dynamic_cast<FuncStmt *>(N))
+      ML.declareFunction(static_cast<FuncDecl *>(S->getPrototype()));
+
+  for (auto N : Contents)
+    if (auto S = dynamic_cast<FuncStmt *>(N)) {
+      auto Idx = ML.Functions[S->getPrototype()];
+      FunctionLowering(ML, M->Functions[Idx]).lower(S);
+    }
+
+  if (M->Functions.size() > std::numeric_limits<uint16_t>::max() ||
+      M->Natives.size() > std::numeric_limits<uint16_t>::max())
+    ML.error("program has too many functions to be interpreted");
+  if (ML.IsError)
+    return nullptr;
+  return M;
+}
@@ -0,0 +1,390 @@
+//===--- Interpreter.cpp - Dusk bytecode interpreter ----------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Interpreter/Interpreter.h"
+
+#include "llvm/ADT/StringSwitch.h"
+#include "llvm/Support/DynamicLibrary.h"
+#include "llvm/Support/raw_ostream.h"
+#include "runtime/io.h"
+#include "runtime/iter.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+// Instructions are dispatched by computed gotos where available, which lets
+// the branch predictor follow each instruction separately.
+#if defined(__GNUC__)
+#define DUSK_THREADED_DISPATCH 1
+#endif
+
+using namespace dusk;
+using namespace interp;
+
+static int64_t *toPtr(int64_t Cell) {
+  return reinterpret_cast<int64_t *>(static_cast<intptr_t>(Cell));
+}
+
+static int64_t toCell(int64_t *Ptr) {
+  return static_cast<int64_t>(reinterpret_cast<intptr_t>(Ptr));
+}
+
+/// Calls native function \c Addr with \c NumParams arguments \c Args.
+template <typename RetTy>
+static RetTy callNative(void *Addr, unsigned NumParams, const int64_t *Args) {
+  typedef int64_t I;
+  switch (NumParams) {
+  case 0:
+    return reinterpret_cast<RetTy (*)()>(Addr)();
+  case 1:
+    return reinterpret_cast<RetTy (*)(I)>(Addr)(Args[0]);
+  case 2:
+    return reinterpret_cast<RetTy (*)(I, I)>(Addr)(Args[0], Args[1]);
+  case 3:
+    return reinterpret_cast<RetTy (*)(I, I, I)>(Addr)(Args[0], Args[1],
+                                                      Args[2]);
+  case 4:
+    return reinterpret_cast<RetTy (*)(I, I, I, I)>(Addr)(Args[0], Args[1],
+                                                         Args[2], Args[3]);
+  case 5:
+    return reinterpret_cast<RetTy (*)(I, I, I, I, I)>(Addr)(
+        Args[0], Args[1], Args[2], Args[3], Args[4]);
+  case 6:
+    return reinterpret_cast<RetTy (*)(I, I, I, I, I, I)>(Addr)(
+        Args[0], Args[1], Args[2], Args[3], Args[4], Args[5]);
+  default:
+    llvm_unreachable("Arity is checked when the module is linked");
+  }
+}
+
+Interpreter::Interpreter(BytecodeModule &M, raw_ostream &OS)
+    : Module(M), OS(OS) {}
+
+int Interpreter::run() {
+  if (Module.Main < 0) {
+    OS << "duskc: error: program does not define function 'main'\n";
+    return 1;
+  }
+  if (!link() || !execute(Module.Main))
+    return 1;
+  return 0;
+}
+
+bool Interpreter::link() {
+  // Functions of the host process are available to extern declarations,
+  // the same as to the compiled program.
+  llvm::sys::DynamicLibrary::LoadLibraryPermanently(nullptr);
+
+  Natives.clear();
+  for (auto &N : Module.Natives) {
+    auto Addr = llvm::StringSwitch<void *>(N.Name)
+                    .Case("println", reinterpret_cast<void *>(&println))
+                    .Case("readln", reinterpret_cast<void *>(&readln))
+                    .Case("__iter_range", reinterpret_cast<void *>(&__iter_range))
+                    .Case("__iter_step", reinterpret_cast<void *>(&__iter_step))
+                    .Default(nullptr);
+    if (!Addr)
+      Addr = llvm::sys::DynamicLibrary::SearchForAddressOfSymbol(N.Name);
+    if (!Addr) {
+      OS << "duskc: error: undefined function '" << N.Name << "'\n";
+      return false;
+    }
+    if (N.NumParams > MaxNativeParams) {
+      OS << "duskc: error: function '" << N.Name << "' has more than "
+         << MaxNativeParams << " parameters\n";
+      return false;
+    }
+    Natives.push_back(Addr);
+  }
+  return true;
+}
+
+namespace {
+
+/// Saved state of a caller.
+struct CallFrame {
+  const Instruction *PC;
+  int64_t *Regs;
+  const BytecodeFunction *Fn;
+
+  /// Register of the caller receiving the returned value.
+  uint16_t Dest;
+};
+
+} // anonymous namespace
+
+bool Interpreter::execute(unsigned Entry) {
+  std::unique_ptr<int64_t[]> Stack(new int64_t[StackSize]);
+  const int64_t *StackEnd = Stack.get() + StackSize;
+  std::vector<CallFrame> Frames;
+  Frames.reserve(1024);
+
+  auto Functions = Module.Functions.data();
+  auto NativeInfos = Module.Natives.data();
+  auto Globals = Module.Globals.data();
+
+  const BytecodeFunction *Fn = &Functions[Entry];
+  int64_t *Regs = Stack.get();
+  const Instruction *Code = Fn->Code.data();
+  const Instruction *PC = Code;
+  const int64_t *Consts = Fn->Constants.data();
+  const Instruction *I;
+  const char *Error = "invalid instruction";
+
+  if (Fn->FrameSize > StackSize) {
+    Error = "stack overflow";
+    goto Fail;
+  }
+  std::fill_n(Regs, Fn->NumParams, 0);
+
+#define R(X) Regs[I->X]
+
+#ifdef DUSK_THREADED_DISPATCH
+  static const void *DispatchTable[] = {
+#define OPCODE(Id, Format) &&Op_##Id,
+#include "dusk/Interpreter/Opcodes.def"
+  };
+#define DISPATCH()                                                             \
+  do {                                                                         \
+    I = PC++;                                                                  \
+    goto *DispatchTable[static_cast<unsigned>(I->Op)];                         \
+  } while (0)
+#define CASE(Id) Op_##Id:
+  DISPATCH();
+#else
+#define DISPATCH() goto Dispatch
+#define CASE(Id) case Opcode::Id:
+Dispatch:
+  I = PC++;
+  switch (I->Op) {
+#endif
+
+  CASE(Mov) {
+    R(A) = R(B);
+    DISPATCH();
+  }
+  CASE(LoadI) {
+    R(A) = I->getImm();
+    DISPATCH();
+  }
+  CASE(LoadK) {
+    R(A) = Consts[I->getImm()];
+    DISPATCH();
+  }
+  CASE(LoadGlobal) {
+    R(A) = Globals[I->getImm()];
+    DISPATCH();
+  }
+  CASE(StoreGlobal) {
+    Globals[I->getImm()] = R(A);
+    DISPATCH();
+  }
+  CASE(FrameArray) {
+    auto &Arr = Fn->Arrays[I->getImm()];
+    std::fill_n(Regs + Arr.Offset, Arr.Size, 0);
+    R(A) = toCell(Regs + Arr.Offset);
+    DISPATCH();
+  }
+
+  // Arithmetic wraps around, the same as the generated code.
+  CASE(Add) {
+    R(A) = int64_t(uint64_t(R(B)) + uint64_t(R(C)));
+    DISPATCH();
+  }
+  CASE(AddI) {
+    R(A) = int64_t(uint64_t(R(B)) + uint64_t(int64_t(int16_t(I->C))));
+    DISPATCH();
+  }
+  CASE(Sub) {
+    R(A) = int64_t(uint64_t(R(B)) - uint64_t(R(C)));
+    DISPATCH();
+  }
+  CASE(Mul) {
+    R(A) = int64_t(uint64_t(R(B)) * uint64_t(R(C)));
+    DISPATCH();
+  }
+  CASE(Div) {
+    if (R(C) == 0) {
+      Error = "division by zero";
+      goto Fail;
+    }
+    R(A) = R(C) == -1 ? int64_t(0 - uint64_t(R(B))) : R(B) / R(C);
+    DISPATCH();
+  }
+  CASE(Rem) {
+    if (R(C) == 0) {
+      Error = "division by zero";
+      goto Fail;
+    }
+    R(A) = R(C) == -1 ? 0 : R(B) % R(C);
+    DISPATCH();
+  }
+  CASE(Neg) {
+    R(A) = int64_t(0 - uint64_t(R(B)));
+    DISPATCH();
+  }
+  CASE(Not) {
+    R(A) = ~R(B);
+    DISPATCH();
+  }
+
+  // True is represented by all bits set, the same as in the generated code.
+  CASE(And) {
+    R(A) = -int64_t(R(B) != 0 && R(C) != 0);
+    DISPATCH();
+  }
+  CASE(Or) {
+    R(A) = -int64_t(R(B) != 0 || R(C) != 0);
+    DISPATCH();
+  }
+  CASE(Eq) {
+    R(A) = -int64_t(R(B) == R(C));
+    DISPATCH();
+  }
+  CASE(Ne) {
+    R(A) = -int64_t(R(B) != R(C));
+    DISPATCH();
+  }
+  CASE(Lt) {
+    R(A) = -int64_t(R(B) < R(C));
+    DISPATCH();
+  }
+  CASE(Le) {
+    R(A) = -int64_t(R(B) <= R(C));
+    DISPATCH();
+  }
+  CASE(Gt) {
+    R(A) = -int64_t(R(B) > R(C));
+    DISPATCH();
+  }
+  CASE(Ge) {
+    R(A) = -int64_t(R(B) >= R(C));
+    DISPATCH();
+  }
+
+  CASE(Load) {
+    R(A) = toPtr(R(B))[R(C)];
+    DISPATCH();
+  }
+  CASE(Store) {
+    toPtr(R(A))[R(B)] = R(C);
+    DISPATCH();
+  }
+  CASE(ElemAddr) {
+    R(A) = toCell(toPtr(R(B)) + R(C));
+    DISPATCH();
+  }
+  CASE(Copy) {
+    if (R(C) > 0)
+      std::memmove(toPtr(R(A)), toPtr(R(B)), R(C) * sizeof(int64_t));
+    DISPATCH();
+  }
+
+  CASE(Jmp) {
+    PC = Code + I->getImm();
+    DISPATCH();
+  }
+  CASE(JmpIf) {
+    if (R(A) != 0)
+      PC = Code + I->getImm();
+    DISPATCH();
+  }
+  CASE(JmpIfNot) {
+    if (R(A) == 0)
+      PC = Code + I->getImm();
+    DISPATCH();
+  }
+
+  CASE(ForPrep) {
+    auto Start = R(B);
+    auto End = R(C);
+    auto Loop = Regs + I->A;
+    Loop[0] = 0;
+    Loop[1] = __iter_range(Start, End);
+    Loop[2] = __iter_step(Start, End);
+    Loop[3] = Start;
+    DISPATCH();
+  }
+  CASE(ForTest) {
+    auto Loop = Regs + I->A;
+    if (Loop[0] >= Loop[1])
+      PC = Code + I->getImm();
+    DISPATCH();
+  }
+  CASE(ForLoop) {
+    auto Loop = Regs + I->A;
+    Loop[3] = int64_t(uint64_t(Loop[3]) + uint64_t(Loop[2]));
+    if (++Loop[0] < Loop[1])
+      PC = Code + I->getImm();
+    DISPATCH();
+  }
+
+  CASE(Call) {
+    auto Callee = &Functions[I->B];
+    auto CalleeRegs = Regs + Fn->FrameSize;
+    if (Callee->FrameSize > size_t(StackEnd - CalleeRegs) ||
+        Frames.size() == MaxCallDepth) {
+      Error = "stack overflow";
+      goto Fail;
+    }
+    std::copy_n(Regs + I->C, Callee->NumParams, CalleeRegs);
+    Frames.push_back({PC, Regs, Fn, I->A});
+    Fn = Callee;
+    Regs = CalleeRegs;
+    Code = PC = Fn->Code.data();
+    Consts = Fn->Constants.data();
+    DISPATCH();
+  }
+  CASE(CallNative) {
+    auto &Info = NativeInfos[I->B];
+    if (Info.ReturnsValue)
+      R(A) = callNative<int64_t>(Natives[I->B], Info.NumParams, Regs + I->C);
+    else
+      callNative<void>(Natives[I->B], Info.NumParams, Regs + I->C);
+    DISPATCH();
+  }
+  CASE(Ret) {
+    auto Value = R(A);
+    if (Frames.empty())
+      return true;
+    auto &Caller = Frames.back();
+    PC = Caller.PC;
+    Regs = Caller.Regs;
+    Fn = Caller.Fn;
+    Code = Fn->Code.data();
+    Consts = Fn->Constants.data();
+    Regs[Caller.Dest] = Value;
+    Frames.pop_back();
+    DISPATCH();
+  }
+  CASE(RetVoid) {
+    if (Frames.empty())
+      return true;
+    auto &Caller = Frames.back();
+    PC = Caller.PC;
+    Regs = Caller.Regs;
+    Fn = Caller.Fn;
+    Code = Fn->Code.data();
+    Consts = Fn->Constants.data();
+    Frames.pop_back();
+    DISPATCH();
+  }
+
+#ifndef DUSK_THREADED_DISPATCH
+  }
+#endif
+#undef CASE
+#undef DISPATCH
+#undef R
+
+Fail:
+  OS << "duskc: error: " << Error << " in function '" << Fn->Name << "'\n";
+  return false;
+}
@@ -10,59 +10,85 @@
 #include "dusk/Parse/Lexer.h"
 #include "dusk/Basic/SourceManager.h"
 #include "llvm/ADT/StringRef.h"
-#include "llvm/ADT/StringSwitch.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/MathExtras.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_os_ostream.h"
 #include "llvm/TableGen/Error.h"
+#include <array>
 #include <cctype>
-#include <functional>
+#include <cstdint>
+#include <cstring>
 
-using namespace dusk;
-
-/// Returns start of line containing a given \c currPtr.
-static const char *getStartOfLine(const char *buffStart, const char *currPtr) {
-  while (buffStart != currPtr) {
-    if (*currPtr == '\n' || *currPtr == '\r') {
-      currPtr++;
-      break;
-    }
-    currPtr--;
-  }
-  return currPtr;
-}
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define DUSK_LEXER_USE_SSE2 1
+#endif
 
-// MARK: - Validation functions
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DUSK_LEXER_USE_AVX2 1
+#endif
 
-static bool isValidIdentifierStart(const char *c) {
-  return std::isalpha(*c) || *c == '_';
-}
+using namespace dusk;
 
-static bool isValidIdentifierCont(const char *c) {
-  return std::isalnum(*c) || *c == '_';
+// MARK: - Character classification
+
+namespace {
+
+/// Classes of characters, which the lexer is interested in.
+enum CharClass : uint8_t {
+  CC_Whitespace = 1 << 0,
+  CC_IdentifierStart = 1 << 1,
+  CC_IdentifierCont = 1 << 2,
+  CC_DecDigit = 1 << 3,
+  CC_HexDigit = 1 << 4,
+  CC_OctDigit = 1 << 5,
+  CC_BinDigit = 1 << 6
+};
+
+} // anonymous namespace
+
+static constexpr std::array<uint8_t, 256> buildCharClassTable() {
+  std::array<uint8_t, 256> Table{};
+  for (unsigned C = 0; C < Table.size(); C++) {
+    bool IsAlpha = (C >= 'a' && C <= 'z') || (C >= 'A' && C <= 'Z');
+    bool IsDigit = C >= '0' && C <= '9';
+    uint8_t Class = 0;
+
+    if (C == ' ' || C == '\t' || C == '\v' || C == '\n' || C == '\r')
+      Class |= CC_Whitespace;
+    if (IsAlpha || C == '_')
+      Class |= CC_IdentifierStart | CC_IdentifierCont;
+    if (IsDigit)
+      Class |= CC_IdentifierCont | CC_DecDigit | CC_HexDigit;
+    if ((C >= 'a' && C <= 'f') || (C >= 'A' && C <= 'F'))
+      Class |= CC_HexDigit;
+    if (C >= '0' && C <= '7')
+      Class |= CC_OctDigit;
+    if (C == '0' || C == '1')
+      Class |= CC_BinDigit;
+
+    Table[C] = Class;
+  }
+  return Table;
 }
 
-static bool isValidDecDigit(const char *c) { return std::isdigit(*c); }
-
-static bool isValidBinDigit(const char *c) { return *c == '0' || *c == '1'; }
+/// Character classes of all possible byte values.
+static constexpr std::array<uint8_t, 256> CharClasses = buildCharClassTable();
 
-static bool isValidOctDigit(const char *c) { return *c >= '0' && *c <= '7'; }
-
-static bool isValidHexDigit(const char *c) {
-  return std::isdigit(*c) ||
-         (*c >= 'a' && *c <= 'f') | (*c >= 'A' && *c <= 'F');
+static inline bool hasClass(char C, uint8_t Class) {
+  return (CharClasses[static_cast<unsigned char>(C)] & Class) != 0;
 }
 
 // MARK: - Contitional character consumtion functions
 
-/// \brief Consumes a character if provided predicate returns \c true
+/// \brief Consumes a character if it belongs to any of given classes.
 ///
 /// \return \c true, if function consumes a character, \c false otherwise.
-static bool consumeIf(const char *&ptr,
-                      std::function<bool(const char *)> pred) {
-  const char *c = ptr;
-  if (pred(c)) {
+static inline bool consumeIf(const char *&ptr, uint8_t Class) {
+  if (hasClass(*ptr, Class)) {
     ptr++;
     return true;
   }
@@ -70,29 +96,210 @@ static bool consumeIf(const char *&ptr,
 }
 
 static bool consumeIfValidIdentifierStart(const char *&ptr) {
-  return consumeIf(ptr, isValidIdentifierStart);
-}
-
-static bool consumeIfValidIdentifierCont(const char *&ptr) {
-  return consumeIf(ptr, isValidIdentifierCont);
+  return consumeIf(ptr, CC_IdentifierStart);
 }
 
 static bool consumeIfValidDecDigit(const char *&ptr) {
-  return consumeIf(ptr, isValidDecDigit);
+  return consumeIf(ptr, CC_DecDigit);
 }
 
 static bool consumeIfValidBinDigit(const char *&ptr) {
-  return consumeIf(ptr, isValidBinDigit);
+  return consumeIf(ptr, CC_BinDigit);
 }
 
 static bool consumeIfValidOctDigit(const char *&ptr) {
-  return consumeIf(ptr, isValidOctDigit);
+  return consumeIf(ptr, CC_OctDigit);
 }
 
 static bool consumeIfValidHexDigit(const char *&ptr) {
-  return consumeIf(ptr, isValidHexDigit);
+  return consumeIf(ptr, CC_HexDigit);
+}
+
+// MARK: - Bulk scanning functions
+//
+// Following functions scan the buffer 16 bytes at a time when SSE2 is
+// available, and 32 bytes at a time when AVX2 is enabled as well, e.g. by
+// building with -march=native. Vector loads never reach past the \c End
+// pointer, the rest of the buffer is scanned using the character class
+// table.
+
+#if DUSK_LEXER_USE_AVX2
+static inline __m256i loadBlock32(const char *Ptr) {
+  return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(Ptr));
+}
+
+/// Returns mask of bytes in \c Block, which lie in the range [Lo, Hi].
+///
+/// \note Only valid for ASCII bounds, bytes above 0x7f never match.
+static inline __m256i matchRange(__m256i Block, char Lo, char Hi) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(Block, _mm256_set1_epi8(Lo - 1)),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8(Hi + 1), Block));
+}
+
+/// Returns index of the first byte not set in a 32-bit \c Mask, or 32.
+static inline unsigned firstUnset32(unsigned Mask) {
+  return llvm::countTrailingZeros(~Mask);
+}
+#endif
+
+#if DUSK_LEXER_USE_SSE2
+static inline __m128i loadBlock(const char *Ptr) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i *>(Ptr));
 }
 
+/// Returns mask of bytes in \c Block, which lie in the range [Lo, Hi].
+///
+/// \note Only valid for ASCII bounds, bytes above 0x7f never match.
+static inline __m128i matchRange(__m128i Block, char Lo, char Hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(Block, _mm_set1_epi8(Lo - 1)),
+                       _mm_cmplt_epi8(Block, _mm_set1_epi8(Hi + 1)));
+}
+
+/// Returns index of the first byte not set in a 16-bit \c Mask, or 16.
+static inline unsigned firstUnset(unsigned Mask) {
+  return llvm::countTrailingZeros(~Mask | 0x10000u);
+}
+#endif
+
+/// Returns pointer to the first non-whitespace character in [Ptr, End).
+static const char *skipWhitespace(const char *Ptr, const char *End) {
+#if DUSK_LEXER_USE_AVX2
+  while (End - Ptr >= 32) {
+    auto Block = loadBlock32(Ptr);
+    auto Match = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(Block, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(Block, _mm256_set1_epi8('\r'))),
+        matchRange(Block, '\t', '\v'));
+    auto Idx = firstUnset32(_mm256_movemask_epi8(Match));
+    if (Idx != 32)
+      return Ptr + Idx;
+    Ptr += 32;
+  }
+#endif
+#if DUSK_LEXER_USE_SSE2
+  while (End - Ptr >= 16) {
+    auto Block = loadBlock(Ptr);
+    // ' ', '\r' and '\t', '\n', '\v' which form a continuous range.
+    auto Match = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(Block, _mm_set1_epi8(' ')),
+                     _mm_cmpeq_epi8(Block, _mm_set1_epi8('\r'))),
+        matchRange(Block, '\t', '\v'));
+    auto Idx = firstUnset(_mm_movemask_epi8(Match));
+    if (Idx != 16)
+      return Ptr + Idx;
+    Ptr += 16;
+  }
+#endif
+  while (Ptr != End && hasClass(*Ptr, CC_Whitespace))
+    Ptr++;
+  return Ptr;
+}
+
+/// Returns pointer to the first character in [Ptr, End), which cannot be
+/// a part of an identifier.
+static const char *skipIdentifierBody(const char *Ptr, const char *End) {
+#if DUSK_LEXER_USE_AVX2
+  while (End - Ptr >= 32) {
+    auto Block = loadBlock32(Ptr);
+    auto Folded = _mm256_or_si256(Block, _mm256_set1_epi8(0x20));
+    auto Match = _mm256_or_si256(
+        _mm256_or_si256(matchRange(Folded, 'a', 'z'),
+                        matchRange(Block, '0', '9')),
+        _mm256_cmpeq_epi8(Block, _mm256_set1_epi8('_')));
+    auto Idx = firstUnset32(_mm256_movemask_epi8(Match));
+    if (Idx != 32)
+      return Ptr + Idx;
+    Ptr += 32;
+  }
+#endif
+#if DUSK_LEXER_USE_SSE2
+  while (End - Ptr >= 16) {
+    auto Block = loadBlock(Ptr);
+    // Fold upper case letters to lower case ones.
+    auto Folded = _mm_or_si128(Block, _mm_set1_epi8(0x20));
+    auto Match = _mm_or_si128(
+        _mm_or_si128(matchRange(Folded, 'a', 'z'), matchRange(Block, '0', '9')),
+        _mm_cmpeq_epi8(Block, _mm_set1_epi8('_')));
+    auto Idx = firstUnset(_mm_movemask_epi8(Match));
+    if (Idx != 16)
+      return Ptr + Idx;
+    Ptr += 16;
+  }
+#endif
+  while (Ptr != End && hasClass(*Ptr, CC_IdentifierCont))
+    Ptr++;
+  return Ptr;
+}
+
+/// Returns pointer to the first occurence of any of \c Cs in [Ptr, End),
+/// or \c End if there is none.
+template <char... Cs>
+static const char *findFirstOf(const char *Ptr, const char *End) {
+#if DUSK_LEXER_USE_AVX2
+  while (End - Ptr >= 32) {
+    auto Block = loadBlock32(Ptr);
+    auto Match = _mm256_setzero_si256();
+    ((Match = _mm256_or_si256(Match,
+                              _mm256_cmpeq_epi8(Block, _mm256_set1_epi8(Cs)))),
+     ...);
+    if (auto Mask = _mm256_movemask_epi8(Match))
+      return Ptr + llvm::countTrailingZeros(static_cast<unsigned>(Mask));
+    Ptr += 32;
+  }
+#endif
+#if DUSK_LEXER_USE_SSE2
+  while (End - Ptr >= 16) {
+    auto Block = loadBlock(Ptr);
+    auto Match = _mm_setzero_si128();
+    ((Match = _mm_or_si128(Match, _mm_cmpeq_epi8(Block, _mm_set1_epi8(Cs)))),
+     ...);
+    if (auto Mask = _mm_movemask_epi8(Match))
+      return Ptr + llvm::countTrailingZeros(static_cast<unsigned>(Mask));
+    Ptr += 16;
+  }
+#endif
+  while (Ptr != End && !((*Ptr == Cs) || ...))
+    Ptr++;
+  return Ptr;
+}
+
+// MARK: - Keywords
+
+namespace {
+
+struct KeywordInfo {
+  const char *Spelling = nullptr;
+  size_t Length = 0;
+  tok Kind = tok::identifier;
+};
+
+} // anonymous namespace
+
+/// Perfect hash of all of the keywords.
+///
+/// \note Combination of the first and the last character and the length is
+/// unique for every keyword, when new keyword is added, the function may need
+/// to be updated.
+static constexpr unsigned hashKeyword(const char *Str, size_t Length) {
+  return (static_cast<unsigned char>(Str[0]) +
+          9 * static_cast<unsigned char>(Str[Length - 1]) + 5 * Length) & 31;
+}
+
+static constexpr std::array<KeywordInfo, 32> buildKeywordTable() {
+  std::array<KeywordInfo, 32> Table{};
+#define KEYWORD(kw)                                                            \
+  {                                                                            \
+    auto &Entry = Table[hashKeyword(#kw, sizeof(#kw) - 1)];                    \
+    if (Entry.Spelling != nullptr)                                             \
+      throw "Keyword hash collision";                                          \
+    Entry = {#kw, sizeof(#kw) - 1, tok::kw_##kw};                              \
+  }
+#include "dusk/Basic/TokenDefinitions.def"
+  return Table;
+}
+
+static constexpr std::array<KeywordInfo, 32> Keywords = buildKeywordTable();
+
 // MARK: - Lexer
 Lexer::Lexer(const llvm::SourceMgr &SM, unsigned BufferID,
              DiagnosticEngine *Engine, bool KeepComments)
@@ -138,6 +345,7 @@ void Lexer::lexToken() {
     case '\v':
     case '\n':
     case '\r':
+      CurPtr = skipWhitespace(CurPtr, BufferEnd);
       break;
 
     case '=': {
@@ -282,14 +490,20 @@ void Lexer::lexToken() {
 void Lexer::diagnose(diag::DiagID ID) { diagnose(NextToken, ID); }
 
 void Lexer::diagnose(Token T, diag::DiagID ID) {
-  if (Engine == nullptr)
-    return;
+  if (DeferredDiags != nullptr)
+    DeferredDiags->emplace_back(T.getLoc(), ID);
+  else if (Engine != nullptr)
+    emitDiagnostic(*Engine, T.getLoc(), ID);
+}
+
+void Lexer::emitDiagnostic(DiagnosticEngine &Engine, SMLoc Loc,
+                           diag::DiagID ID) {
   switch (ID) {
   case diag::DiagID::lex_unexpected_symbol:
-    Engine->diagnose(T.getLoc(), ID);
+    Engine.diagnose(Loc, ID);
     break;
   case diag::DiagID::lex_unterminated_multiline_comment:
-    Engine->diagnose(T.getLoc(), ID).fixItAfter("*/", T.getLoc());
+    Engine.diagnose(Loc, ID).fixItAfter("*/", Loc);
     break;
 
   default:
@@ -300,83 +514,49 @@ void Lexer::diagnose(Token T, diag::DiagID ID) {
 // MARK: - Static methods
 
 tok Lexer::kindOfIdentifier(StringRef Str) {
-  return llvm::StringSwitch<tok>(Str)
-      .Case("var", tok::kw_var)
-      .Case("let", tok::kw_let)
-      .Case("break", tok::kw_break)
-      .Case("return", tok::kw_return)
-      .Case("if", tok::kw_if)
-      .Case("else", tok::kw_else)
-      .Case("while", tok::kw_while)
-      .Case("for", tok::kw_for)
-      .Case("in", tok::kw_in)
-      .Case("func", tok::kw_func)
-      .Case("inout", tok::kw_inout)
-      .Case("extern", tok::kw_extern)
-      .Default(tok::identifier);
-}
-
-Token Lexer::getTokenAtLocation(const llvm::SourceMgr &SM, SMLoc Loc) {
+  if (Str.empty())
+    return tok::identifier;
+
+  auto &Entry = Keywords[hashKeyword(Str.data(), Str.size())];
+  if (Entry.Length == Str.size() &&
+      std::memcmp(Entry.Spelling, Str.data(), Str.size()) == 0)
+    return Entry.Kind;
+  return tok::identifier;
+}
+
+Token Lexer::getTokenAtLocation(const dusk::SourceManager &SM, SMLoc Loc) {
   // Invalid address
   if (!Loc.isValid())
     return Token();
 
-  auto BufferID = getBufferForLoc(SM, Loc);
-  // Buffer not found in currently opened buffers
-  if (BufferID > SM.getNumBuffers())
-    return Token();
+  auto BufferID = SM.getBufferForLoc(Loc);
   Lexer L(SM, BufferID);
   L.setState(Loc);
   return L.peekNextToken();
 }
 
-SMLoc Lexer::getLocForEndOfToken(const llvm::SourceMgr &SM, SMLoc Loc) {
+SMLoc Lexer::getLocForEndOfToken(const dusk::SourceManager &SM, SMLoc Loc) {
   auto Tok = getTokenAtLocation(SM, Loc);
   return Tok.getRange().End;
 }
 
-SMLoc Lexer::getLocForStartOfLine(const llvm::SourceMgr &SM, SMLoc Loc) {
-  // Invalid address
-  if (!Loc.isValid())
-    return Loc;
-
-  auto BufferID = getBufferForLoc(SM, Loc);
-  // Buffer not found in currently opened buffers
-  if (BufferID > SM.getNumBuffers())
-    return SMLoc();
-
-  auto B = SM.getMemoryBuffer(BufferID);
-  auto BuffStart = B->getBufferStart();
-  auto CurPtr = Loc.getPointer();
-  auto StartLoc = getStartOfLine(BuffStart, CurPtr);
-  return getSourceLoc(StartLoc);
+SMLoc Lexer::getLocForStartOfLine(const dusk::SourceManager &SM, SMLoc Loc) {
+  return SM.getLocForStartOfLine(Loc);
 }
 
-SMLoc Lexer::getLocForEndOfLine(const llvm::SourceMgr &SM, SMLoc Loc) {
-  // Invalid address
-  if (!Loc.isValid())
-    return Loc;
-
-  auto BufferID = getBufferForLoc(SM, Loc);
-  // Buffer not found in currently opened buffers
-  if (BufferID > SM.getNumBuffers())
-    return SMLoc();
-  Lexer L(SM, BufferID);
-  L.setState(Loc);
-  L.skipToEndOfLine(/*ConsumeNewLine: */ true);
-  return getSourceLoc(L.CurPtr);
+SMLoc Lexer::getLocForEndOfLine(const dusk::SourceManager &SM, SMLoc Loc) {
+  return SM.getLocForEndOfLine(Loc);
 }
 
-StringRef Lexer::getLineForLoc(const llvm::SourceMgr &SM, SMLoc Loc) {
-  auto S = getLocForStartOfLine(SM, Loc);
-  auto E = getLocForEndOfLine(SM, Loc);
-  return {S.getPointer(), (size_t)(E.getPointer() - S.getPointer())};
+StringRef Lexer::getLineForLoc(const dusk::SourceManager &SM, SMLoc Loc) {
+  return SM.getLineForLoc(Loc);
 }
 
 // MARK: - Private methods
 
 void Lexer::skipToEndOfLine(bool ConsumeNewline) {
   while (true) {
+    CurPtr = findFirstOf<'\n', '\r', '\0'>(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     // Consume next character
     default:
@@ -398,8 +578,6 @@ void Lexer::skipToEndOfLine(bool ConsumeNewline) {
       return;
     }
   }
-  while (*CurPtr != '\n')
-    CurPtr++;
 }
 
 void Lexer::skipLineComment(bool ConsumeNewLine) {
@@ -415,6 +593,7 @@ void Lexer::skipMultilineComment() {
 
   CurPtr++;
   while (true) {
+    CurPtr = findFirstOf<'*', '\0'>(CurPtr, BufferEnd);
     switch (*CurPtr++) {
     // Consume next character
     default:
@@ -472,8 +651,7 @@ void Lexer::lexIdentifier() {
   assert(didStart && "Unexpected start of identifier");
 
   // Continue moving until invalid character or buffer end found
-  while (consumeIfValidIdentifierCont(CurPtr))
-    ;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
 
   // Construct token
   auto TokenText = StringRef{TokStart, (size_t)(CurPtr - TokStart)};
@@ -483,14 +661,14 @@ void Lexer::lexIdentifier() {
 
 void Lexer::lexNumber() {
   // Validate start of number
-  assert(isValidDecDigit(CurPtr - 1) && "Unexpected begining of number");
+  assert(hasClass(CurPtr[-1], CC_DecDigit) && "Unexpected begining of number");
 
   // Check if non-decadic type
-  if (CurPtr[-1] == '0' && std::tolower(CurPtr[0]) == 'x')
+  if (CurPtr[-1] == '0' && (CurPtr[0] | 0x20) == 'x')
     return lexHexNumber();
-  else if (CurPtr[-1] == '0' && std::tolower(CurPtr[0]) == 'b')
+  else if (CurPtr[-1] == '0' && (CurPtr[0] | 0x20) == 'b')
     return lexBinNumber();
-  else if (CurPtr[-1] == '0' && std::tolower(CurPtr[0]) == 'o')
+  else if (CurPtr[-1] == '0' && (CurPtr[0] | 0x20) == 'o')
     return lexOctNumber();
   // Lex decadic number
   else
@@ -507,8 +685,7 @@ void Lexer::lexHexNumber() {
 
   // Consume [0-9][a-z][A-Z] character to get token string.
   // We'll validate it later.
-  while (consumeIfValidIdentifierCont(CurPtr))
-    ;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
 
   const char *TokEnd = CurPtr;
   CurPtr = TokStart + 2; // skip `0x` prefix
@@ -535,8 +712,7 @@ void Lexer::lexBinNumber() {
 
   // Consume [0-9][a-z][A-Z] character to get token string.
   // We'll validate it later.
-  while (consumeIfValidIdentifierCont(CurPtr))
-    ;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
 
   const char *TokEnd = CurPtr;
   CurPtr = TokStart + 2; // skip `0b` prefix
@@ -563,8 +739,7 @@ void Lexer::lexOctNumber() {
 
   // Consume [0-9][a-z][A-Z] character to get token string.
   // We'll validate it later.
-  while (consumeIfValidIdentifierCont(CurPtr))
-    ;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
 
   const char *TokEnd = CurPtr;
   CurPtr = TokStart + 2; // skip `0o` prefix
@@ -586,12 +761,11 @@ void Lexer::lexDecNumber() {
   const char *TokStart = CurPtr - 1;
 
   // Validate start of number
-  assert(isValidDecDigit(TokStart) && "Not a number literal");
+  assert(hasClass(*TokStart, CC_DecDigit) && "Not a number literal");
 
   // Consume [0-9][a-z][A-Z] character to get token string.
   // We'll validate it later.
-  while (consumeIfValidIdentifierCont(CurPtr))
-    ;
+  CurPtr = skipIdentifierBody(CurPtr, BufferEnd);
 
   const char *TokEnd = CurPtr;
   CurPtr = TokEnd;
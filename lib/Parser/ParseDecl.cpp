@@ -19,6 +19,8 @@ Decl *Parser::parseDecl() {
     return parseVarDecl();
   case tok::kw_func:
     return parseFuncDecl();
+  case tok::kw_import:
+    return parseImportDecl();
 
   default:
     return nullptr;
@@ -45,8 +47,9 @@ Decl *Parser::parseLetDecl() {
   if (Tok.is(tok::colon))
     if ((TR = parseValDeclType()) == nullptr)
       return nullptr;
-  return new (Context) VarDecl(VarDecl::Specifier::Let, ID.getText(),
-                               ID.getLoc(), L, parseDeclValue(), TR);
+  return new (Context)
+      VarDecl(VarDecl::Specifier::Let, Context.getIdentifier(ID.getText()),
+              ID.getLoc(), L, parseDeclValue(), TR);
 }
 
 /// Var declaration
@@ -71,8 +74,32 @@ Decl *Parser::parseVarDecl() {
     if ((TR = parseValDeclType()) == nullptr)
       return nullptr;
 
-  return new (Context) VarDecl(ValDecl::Specifier::Var, ID.getText(),
-                               ID.getLoc(), L, parseDeclValue(), TR);
+  return new (Context)
+      VarDecl(ValDecl::Specifier::Var, Context.getIdentifier(ID.getText()),
+              ID.getLoc(), L, parseDeclValue(), TR);
+}
+
+/// Import declaration
+///
+/// ImportDecl ::=
+///     'import' identifier ';'
+Decl *Parser::parseImportDecl() {
+  assert(Tok.is(tok::kw_import) && "Invalid parsing method.");
+
+  auto L = consumeToken();
+  auto ID = Tok;
+  if (!consumeIf(tok::identifier)) {
+    diagnose(Tok.getLoc(), diag::DiagID::expected_identifier);
+    return nullptr;
+  }
+
+  if (!consumeIf(tok::semi)) {
+    diagnose(Tok.getLoc(), diag::DiagID::expected_semicolon)
+        .fixItAfter(";", Tok.getLoc());
+    return nullptr;
+  }
+  return new (Context)
+      ImportDecl(Context.getIdentifier(ID.getText()), ID.getLoc(), L);
 }
 
 /// DeclVal ::=
@@ -115,7 +142,8 @@ Decl *Parser::parseFuncDecl() {
 
   auto Args = static_cast<VarPattern *>(parseVarPattern());
   auto RetTy = parseFuncDeclType();
-  return new (Context) FuncDecl(ID.getText(), ID.getLoc(), FL, Args, RetTy);
+  return new (Context) FuncDecl(Context.getIdentifier(ID.getText()),
+                                ID.getLoc(), FL, Args, RetTy);
 }
 
 /// Value decl type
@@ -169,6 +197,7 @@ Decl *Parser::parseParamDecl() {
     return nullptr;
   }
   if (auto TR = parseTypeRepr())
-    return new (Context) ParamDecl(Spec, ID.getText(), ID.getLoc(), TR);
+    return new (Context) ParamDecl(Spec, Context.getIdentifier(ID.getText()),
+                                     ID.getLoc(), TR);
   return nullptr;
 }
@@ -107,7 +107,7 @@ Expr *Parser::parseIdentifierExpr() {
   // Validate that we really have an identifier to parse
   assert(Tok.is(tok::identifier) && "Invalid parsing method.");
 
-  auto Name = Tok.getText();
+  auto Name = Context.getIdentifier(Tok.getText());
   auto Loc = consumeToken();
   return new (Context) IdentifierExpr(Name, Loc);
 }
@@ -204,6 +204,6 @@ Expr *Parser::parseNumberLiteralExpr() {
 
   consumeToken();
   auto NL = new (Context) NumberLiteralExpr(Value, R);
-  NL->setType(new (Context) IntType());
+  NL->setType(Context.getIntType());
   return NL;
 }
@@ -40,6 +40,9 @@ ASTNode *Parser::parseStatement() {
     case tok::kw_func:
       return parseFuncStmt();
 
+    case tok::kw_extern:
+      return parseExterStmt();
+
     case tok::kw_for:
       return parseForStmt();
 
@@ -170,6 +173,31 @@ Stmt *Parser::parseBlock() {
 
 ASTNode *Parser::parseBlockBody() { return nullptr; }
 
+SMLoc Parser::skipBlock() {
+  // Validate `l_brace` token
+  assert(Tok.is(tok::l_brace) && "Invalid parse method.");
+  consumeToken();
+
+  unsigned Depth = 1;
+  while (Tok.isNot(tok::eof)) {
+    if (Tok.is(tok::unknown)) {
+      // Diagnosed by lexer, the body would not be parsed anyway.
+      Context.setError();
+      consumeToken();
+      return SMLoc();
+    }
+    if (Tok.is(tok::l_brace))
+      Depth++;
+    if (Tok.is(tok::r_brace) && --Depth == 0)
+      return consumeToken();
+    consumeToken();
+  }
+
+  diagnose(Tok.getLoc(), diag::DiagID::expected_r_brace)
+      .fixItBefore("}", Tok.getLoc());
+  return SMLoc();
+}
+
 /// ExternStmt ::=
 ///     'extern' 'func' indentifier
 Stmt *Parser::parseExterStmt() {
@@ -197,6 +225,16 @@ Stmt *Parser::parseFuncStmt() {
   // Validate `func` keyword
   assert(Tok.is(tok::kw_func) && "Invalid parse method");
   auto D = parseFuncDecl();
+  if (Tok.is(tok::l_brace) && DelayFuncBodies) {
+    auto Pos = getParserPosition();
+    auto L = Tok.getLoc();
+    auto R = skipBlock();
+    if (!R.isValid())
+      return nullptr;
+    auto S = new (Context) FuncStmt(D, SMRange{L, R});
+    DelayedBodies[S] = Pos;
+    return S;
+  }
   if (Tok.is(tok::l_brace))
     return new (Context) FuncStmt(D, parseBlock());
 
@@ -218,7 +256,8 @@ Stmt *Parser::parseForStmt() {
   }
 
   auto Spec = ValDecl::Specifier::Let;
-  auto Var = new (Context) ParamDecl(Spec, Ident.getText(), Ident.getLoc());
+  auto Name = Context.getIdentifier(Ident.getText());
+  auto Var = new (Context) ParamDecl(Spec, Name, Ident.getLoc());
   if (!consumeIf(tok::kw_in)) {
     diagnose(Tok.getLoc(), diag::DiagID::expected_in_kw)
         .fixItBefore("in", Tok.getLoc());
@@ -10,6 +10,7 @@
 
 #include "dusk/Parse/Parser.h"
 #include "dusk/Basic/SourceManager.h"
+#include "dusk/Basic/TimeTrace.h"
 #include "llvm/ADT/SmallVector.h"
 #include <vector>
 
@@ -18,22 +19,49 @@ using namespace dusk;
 // MARK: - Parser
 
 Parser::Parser(ASTContext &C, llvm::SourceMgr &SM, SourceFile &SF,
-               DiagnosticEngine &Diag, unsigned BufferID)
+               DiagnosticEngine &Diag, unsigned BufferID, TokenStream *Tokens)
     : Context(C), SourceManager(SM), SF(SF), Diag(Diag),
-      L(new Lexer(SM, BufferID, &Diag)) {}
+      L(Tokens ? nullptr : new Lexer(SM, BufferID, &Diag)), Tokens(Tokens),
+      TokIdx(0) {}
 
 Parser::~Parser() { delete L; }
 
-const Token &Parser::peekToken() const { return L->peekNextToken(); }
+Token Parser::peekToken(unsigned N) const {
+  assert(N > 0 && "Use Tok to access the current token.");
+  if (Tokens)
+    return (*Tokens)[TokIdx + N - 1];
+  assert(N == 1 && "Lexer provides only a single token lookahead.");
+  return L->peekNextToken();
+}
 
 SMLoc Parser::consumeToken() {
   PreviousLoc = Tok.getLoc();
   assert(Tok.isNot(tok::eof) && "Lexing past EOF.");
 
-  L->lex(Tok);
+  if (!Tokens) {
+    L->lex(Tok);
+    return PreviousLoc;
+  }
+
+  Tok = (*Tokens)[TokIdx++];
+  // Emit lexer diagnostics at the same point the lexer would, i.e. once
+  // the following token is lexed.
+  Tokens->diagnoseUpTo(Diag, (*Tokens)[TokIdx].getLoc());
   return PreviousLoc;
 }
 
+void Parser::backtrackToPosition(ParserPosition Pos) {
+  assert(Pos.isValid() && "Invalid parser position.");
+  PreviousLoc = Pos.PreviousLoc;
+  if (Tokens) {
+    TokIdx = Pos.TokIdx;
+    Tok = Pos.Tok;
+    return;
+  }
+  L->setState(Pos.Tok.getLoc());
+  L->lex(Tok);
+}
+
 SMLoc Parser::consumeToken(tok T) {
   assert(Tok.is(T) && "Consumption of invalid token kind.");
   return consumeToken();
@@ -53,12 +81,42 @@ DiagnosticRef Parser::diagnose(SMLoc Loc, diag::DiagID ID) {
 // MARK: - Main parsing loop
 
 ModuleDecl *Parser::parseModule() {
+  TimeTraceScope Trace("Parse", SF.file());
   std::vector<ASTNode *> Nodes;
   consumeToken();
   while (Tok.isNot(tok::eof) && !Context.isError())
     Nodes.push_back(parse());
 
-  return new (Context) ModuleDecl(SF.file(), std::move(Nodes));
+  return new (Context) ModuleDecl(Context.getIdentifier(SF.file()),
+                                  std::move(Nodes));
+}
+
+Stmt *Parser::parseDelayedFuncBody(FuncStmt *FS) {
+  auto It = DelayedBodies.find(FS);
+  assert(It != DelayedBodies.end() && "Function body was not delayed.");
+  auto Pos = It->second;
+  DelayedBodies.erase(It);
+
+  TimeTraceScope Trace("ParseFunctionBody", FS->getPrototype()->getName());
+  backtrackToPosition(Pos);
+  auto Body = parseBlock();
+  FS->setBody(Body);
+  return Body;
+}
+
+Stmt *Parser::parseFuncBody(FuncStmt *FS) {
+  consumeToken();
+  if (Tok.isNot(tok::l_brace)) {
+    diagnose(Tok.getLoc(), diag::DiagID::expected_l_brace);
+    return nullptr;
+  }
+  auto Body = parseBlock();
+  if (Body && Tok.isNot(tok::eof)) {
+    diagnose(Tok.getLoc());
+    return nullptr;
+  }
+  FS->setBody(Body);
+  return Body;
 }
 
 ASTNode *Parser::parse() {
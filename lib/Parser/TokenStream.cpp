@@ -0,0 +1,120 @@
+//===--- TokenStream.cpp - Pre-lexed token buffer -------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Parse/TokenStream.h"
+#include "dusk/Basic/TimeTrace.h"
+#include "dusk/Parse/Lexer.h"
+#include <algorithm>
+#include <limits>
+
+using namespace dusk;
+
+static constexpr unsigned NumTokenKinds = 0
+#define TOKEN(TOK) + 1
+#include "dusk/Basic/TokenDefinitions.def"
+    ;
+
+static_assert(NumTokenKinds <= UINT8_MAX + 1,
+              "Token kind must fit into a single byte.");
+
+TokenStream::TokenStream(const llvm::SourceMgr &SM, unsigned BufferID,
+                         bool Async)
+    : NumReady(0), IsDone(false), NumDiags(0), NumEmitted(0) {
+  auto B = SM.getMemoryBuffer(BufferID);
+  assert(B->getBufferSize() < std::numeric_limits<uint32_t>::max() &&
+         "Buffer too large to be pre-lexed.");
+  BufferStart = B->getBufferStart();
+
+  // Every token except EOF spans at least one character, which bounds
+  // the number of chunks we may ever need.
+  auto MaxTokens = B->getBufferSize() + 1;
+  Chunks.reset(new std::unique_ptr<Chunk>[MaxTokens / ChunkSize + 1]);
+
+  // Create the lexer on the calling thread, so that the worker does not touch
+  // the source manager, which might be modified concurrently.
+  auto L = std::make_unique<Lexer>(SM, BufferID);
+  if (Async)
+    Worker = std::thread(&TokenStream::lexBuffer, this, std::move(L));
+  else
+    lexBuffer(std::move(L));
+}
+
+TokenStream::~TokenStream() {
+  if (Worker.joinable())
+    Worker.join();
+}
+
+size_t TokenStream::size() const {
+  if (!IsDone.load(std::memory_order_acquire)) {
+    std::unique_lock<std::mutex> Guard(ReadyLock);
+    ReadyCond.wait(Guard, [this] { return IsDone.load(); });
+  }
+  return NumReady.load(std::memory_order_acquire);
+}
+
+size_t TokenStream::waitFor(size_t Idx) const {
+  std::unique_lock<std::mutex> Guard(ReadyLock);
+  ReadyCond.wait(Guard,
+                 [this, Idx] { return Idx < NumReady.load() || IsDone.load(); });
+  return std::min(Idx, NumReady.load() - 1);
+}
+
+void TokenStream::emitDiagnostics(DiagnosticEngine &Engine, SMLoc Loc) {
+  std::lock_guard<std::mutex> Guard(ReadyLock);
+  for (; NumEmitted != Diags.size(); NumEmitted++) {
+    auto &D = Diags[NumEmitted];
+    if (Loc.getPointer() < D.first.getPointer())
+      break;
+    Lexer::emitDiagnostic(Engine, D.first, D.second);
+  }
+}
+
+void TokenStream::publish(
+    size_t N, bool Done, std::vector<std::pair<SMLoc, diag::DiagID>> &Pending) {
+  {
+    std::lock_guard<std::mutex> Guard(ReadyLock);
+    Diags.insert(Diags.end(), Pending.begin(), Pending.end());
+    NumDiags.store(Diags.size(), std::memory_order_release);
+    NumReady.store(N, std::memory_order_release);
+    IsDone.store(Done, std::memory_order_release);
+  }
+  Pending.clear();
+  ReadyCond.notify_all();
+}
+
+void TokenStream::lexBuffer(std::unique_ptr<Lexer> L) {
+  TimeTraceScope Trace("Lex");
+  // The lexer has already lexed the first token in its constructor, so its
+  // diagnostics went nowhere. Start over with diagnostics being recorded.
+  std::vector<std::pair<SMLoc, diag::DiagID>> Pending;
+  L->deferDiagnostics(&Pending);
+  L->setState(SMLoc::getFromPointer(BufferStart));
+
+  Token T;
+  size_t N = 0;
+  Chunk *C = nullptr;
+  do {
+    auto I = N % ChunkSize;
+    if (I == 0) {
+      // Publish the full chunk before starting a new one.
+      if (N != 0)
+        publish(N, false, Pending);
+      // Leave the chunk uninitialized, it's filled right away.
+      Chunks[N / ChunkSize].reset(new Chunk);
+      C = Chunks[N / ChunkSize].get();
+    }
+
+    L->lex(T);
+    C->Kinds[I] = static_cast<uint8_t>(T.getKind());
+    C->Offsets[I] = T.getText().data() - BufferStart;
+    C->Lengths[I] = T.getLength();
+    N++;
+  } while (T.isNot(tok::eof));
+  publish(N, true, Pending);
+}
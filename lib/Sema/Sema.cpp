@@ -16,13 +16,18 @@
 #include "dusk/AST/Type.h"
 #include "dusk/AST/TypeRepr.h"
 #include "dusk/AST/Diagnostics.h"
+#include "dusk/AST/ModuleLoader.h"
 #include "dusk/AST/NameLookup.h"
+#include "dusk/Basic/TimeTrace.h"
 
 #include "dusk/Strings.h"
 
 #include "dusk/Runtime/RuntimeFuncs.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/ThreadPool.h"
+#include <memory>
+#include <vector>
 
 #include "TypeChecker.h"
 
@@ -80,27 +85,145 @@ public:
 
 } // anonymous namespace
 
-Sema::Sema(ASTContext &C, DiagnosticEngine &D) : Ctx(C), Diag(D) {}
+Sema::Sema(ASTContext &C, DiagnosticEngine &D, unsigned NumThreads)
+    : Ctx(C), Diag(D), NumThreads(NumThreads) {}
 
 void Sema::perform() {
+  TimeTraceScope Trace("Sema");
   declareFuncs();
   typeCheck();
 }
 
+void Sema::importModules() {
+  for (auto N : Ctx.getRootModule()->getContents()) {
+    auto D = dynamic_cast<ImportDecl *>(N);
+    if (!D)
+      continue;
+
+    ExternalNameSource *Source = nullptr;
+    if (Loader)
+      Source = Loader->loadModule(D, Diag);
+    else
+      Diag.diagnose(D->getNameLoc(), diag::unknown_module);
+
+    if (Source)
+      DeclCtx.addExternalSource(Source);
+    else
+      Ctx.setError();
+  }
+}
+
 void Sema::declareFuncs() {
+  TimeTraceScope Trace("ForwardDeclaration");
+  // Imported declarations are visible in the whole module.
+  importModules();
   FwdDeclarator D(*this, DeclCtx, Diag);
   Ctx.getRootModule()->walk(D);
 }
 
+void Sema::performDeclarations() {
+  declareFuncs();
+  for (auto N : Ctx.getRootModule()->getContents()) {
+    typeCheckTopLevel(N, Diag);
+    if (auto FS = dynamic_cast<FuncStmt *>(N))
+      FuncGlobals[FS] = DeclCtx.getNumGlobals();
+  }
+}
+
+void Sema::typeCheckFuncBody(FuncStmt *FS) {
+  assert(FuncGlobals.count(FS) && "Prototype was not type checked.");
+  NameLookup Lookup(DeclCtx, FuncGlobals.lookup(FS));
+  TypeChecker(*this, Lookup, Ctx, Diag).typeCheckFuncBody(FS);
+}
+
+void Sema::typeCheckTopLevel(ASTNode *N, DiagnosticEngine &D) {
+  TypeChecker TC(*this, DeclCtx, Ctx, D);
+  if (auto Dcl = dynamic_cast<Decl *>(N)) {
+    TC.typeCheckDecl(Dcl);
+  } else if (auto E = dynamic_cast<Expr *>(N)) {
+    TC.diagnose(E->getLocStart(), diag::unexpected_global_expresssion);
+  } else if (auto S = dynamic_cast<Stmt *>(N)) {
+    if (auto FS = dynamic_cast<FuncStmt *>(S))
+      TC.typeCheckFuncPrototype(FS);
+    else
+      TC.typeCheckStmt(S);
+  } else {
+    llvm_unreachable("Unexpected node type.");
+  }
+}
+
 void Sema::typeCheck() {
+  TimeTraceScope Trace("TypeCheck");
+  // Functions are reported only by the item-wise checking.
+  if (NumThreads > 1 || OnFuncChecked)
+    return typeCheckConcurrently();
   TypeChecker(*this, DeclCtx, Ctx, Diag).typeCheckDecl(Ctx.getRootModule());
 }
 
+namespace {
+
+/// A single top-level node of the module being type checked.
+struct TopLevelItem {
+  ASTNode *Node;
+
+  /// Number of global values visible to the node.
+  unsigned NumGlobals;
+
+  /// Diagnostics of the node, reported once all nodes are checked.
+  DiagnosticEngine Diag;
+  DiagnosticBuffer Buffer;
+
+  TopLevelItem(ASTNode *N, dusk::SourceManager &SM)
+      : Node(N), NumGlobals(0), Diag(SM) {
+    Diag.addConsumer(&Buffer);
+  }
+};
+
+} // anonymous namespace
+
+void Sema::typeCheckConcurrently() {
+  // Global values and prototypes must be checked in order, since they
+  // depend on declarations preceding them. Bodies of functions only see
+  // globals declared before them and can be checked independently.
+  std::vector<std::unique_ptr<TopLevelItem>> Items;
+  for (auto N : Ctx.getRootModule()->getContents()) {
+    Items.push_back(std::make_unique<TopLevelItem>(N, Diag.getSourceManager()));
+    auto &I = *Items.back();
+    typeCheckTopLevel(N, I.Diag);
+    if (dynamic_cast<FuncStmt *>(N))
+      I.NumGlobals = DeclCtx.getNumGlobals();
+  }
+
+  // Initializers of global constants are solved by now. Function bodies
+  // only read the solved values they substitute for references.
+  Ctx.setConcurrent(true);
+  {
+    llvm::ThreadPool Pool(NumThreads);
+    for (auto &I : Items) {
+      auto FS = dynamic_cast<FuncStmt *>(I->Node);
+      if (!FS)
+        continue;
+      Pool.async([this, FS, &Item = *I] {
+        NameLookup Lookup(DeclCtx, Item.NumGlobals);
+        TypeChecker(*this, Lookup, Ctx, Item.Diag).typeCheckFuncBody(FS);
+        if (OnFuncChecked && !Ctx.isError())
+          OnFuncChecked(FS);
+      });
+    }
+    Pool.wait();
+  }
+  Ctx.setConcurrent(false);
+
+  // Report diagnostics in source order.
+  for (auto &I : Items)
+    I->Buffer.flush(Diag);
+}
+
 static Type *typeReprResolve(Sema &S, ASTContext &C, IdentTypeRepr *TyRepr) {
   if (TyRepr->getIdent() == BUILTIN_TYPE_NAME_INT)
-    return new (C) IntType();
+    return C.getIntType();
   else if (TyRepr->getIdent() == BUILTIN_TYPE_NAME_VOID)
-    return new (C) VoidType();
+    return C.getVoidType();
   else
     return nullptr;
 }
@@ -109,12 +232,12 @@ static Type *typeReprResolve(Sema &S, ASTContext &C, ArrayTypeRepr *TyRepr) {
   auto BaseTy = S.typeReprResolve(TyRepr->getBaseTyRepr());
   auto Size = static_cast<SubscriptStmt *>(TyRepr->getSize());
   auto SizeVal = static_cast<NumberLiteralExpr *>(Size->getValue())->getValue();
-  return new (C) ArrayType(BaseTy, SizeVal);
+  return C.getArrayType(BaseTy, SizeVal);
 }
 
 static Type *typeReprResolve(Sema &S, ASTContext &C, InOutTypeRepr *TyRepr) {
   auto BaseTy = S.typeReprResolve(TyRepr->getBaseTyRepr());
-  return new (C) InOutType(BaseTy);
+  return C.getInOutType(BaseTy);
 }
 
 Type *Sema::typeReprResolve(TypeRepr *TR) {
@@ -134,17 +257,17 @@ Type *Sema::typeReprResolve(FuncDecl *FD) {
   for (auto Arg : FD->getArgs()->getVars())
     Args.push_back(typeReprResolve(Arg->getTypeRepr()));
 
-  auto ArgsT = new (Ctx) PatternType(std::move(Args));
+  auto ArgsT = Ctx.getPatternType(Args);
 
   // Resolve return type
   Type *RetT = nullptr;
   if (!FD->hasTypeRepr()) {
-    RetT = new (Ctx) VoidType();
+    RetT = Ctx.getVoidType();
   } else {
     RetT = typeReprResolve(FD->getTypeRepr());
   }
 
-  return new (Ctx) FunctionType(ArgsT, RetT);
+  return Ctx.getFunctionType(ArgsT, RetT);
 }
 
 Type *Sema::typeReprResolve(ArrayLiteralExpr *E) {
@@ -153,7 +276,7 @@ Type *Sema::typeReprResolve(ArrayLiteralExpr *E) {
     return nullptr;
 
   auto RefT = Ty->getItems()[0];
-  auto ATy = new (Ctx) ArrayType(RefT, E->getValues()->count());
+  auto ATy = Ctx.getArrayType(RefT, E->getValues()->count());
   for (size_t i = 1; i < Ty->getItems().size(); i++) {
     if (!RefT->isClassOf(Ty->getItems()[i])) {
       Diag.diagnose(E->getLocStart(), diag::array_element_mismatch);
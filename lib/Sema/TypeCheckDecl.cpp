@@ -115,7 +115,13 @@ private:
     if (!ArgsTy || !RetTy)
       return;
 
-    D->setType(new (TC.Ctx) FunctionType(ArgsTy, RetTy));
+    D->setType(TC.Ctx.getFunctionType(ArgsTy, RetTy));
+  }
+
+  void visitImportDecl(ImportDecl *D) {
+    // Top-level imports are resolved before type checking.
+    if (TC.Lookup.getDepth() != 0)
+      TC.diagnose(D->getLocStart(), diag::import_not_global);
   }
 
   void visitModuleDecl(ModuleDecl *D) {
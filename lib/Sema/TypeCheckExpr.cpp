@@ -78,8 +78,11 @@ public:
       E = solveSubscriptExpr(static_cast<SubscriptExpr *>(E));
       break;
     }
-    // Set each expression to solved at the end of traversal.
-    E->setSolved(true);
+    // Set each expression to solved at the end of traversal. Substituted
+    // values are already solved and must not be written, see
+    // solveIdentifierExpr.
+    if (!E->getSolved())
+      E->setSolved(true);
     return E;
   }
 
@@ -87,12 +90,19 @@ private:
   // MARK: - Solvers
 
   Expr *solveIdentifierExpr(IdentifierExpr *E) {
-    // Check if we have a variable with the name.
-    if (auto D = dynamic_cast<ValDecl *>(TC.Lookup.getVal(E->getName()))) {
+    // Check if the identifier refers to a variable.
+    if (auto D = dynamic_cast<ValDecl *>(E->getDecl())) {
       // We can only substitute immutable values.
       if (!D->isLet())
         return E;
 
+      // Values are shared by all references, including ones in function
+      // bodies checked concurrently. Only values already solved along with
+      // their declaration are substituted, so that they are never modified.
+      // Parameters have no value at all.
+      else if (!D->getValue() || !D->getValue()->getSolved())
+        return E;
+
       else if (auto Val = dynamic_cast<NumberLiteralExpr *>(D->getValue()))
         return Val;
       else if (auto Val = dynamic_cast<ArrayLiteralExpr *>(D->getValue()))
@@ -210,8 +220,10 @@ private:
   // MARK: - Visitors
 
   Expr *visitNumberLiteralExpr(NumberLiteralExpr *E) {
-    // Number literal is always an integer type.
-    E->setType(TC.Ctx.getIntType());
+    // Number literal is always an integer type. Values of constants
+    // substituted into function bodies are already typed and shared.
+    if (!E->getType())
+      E->setType(TC.Ctx.getIntType());
     return E;
   }
 
@@ -232,13 +244,14 @@ private:
       if (!TC.typeCheckEquals(BaseTy, T))
         return E;
 
-    auto ArrTy = new (TC.Ctx) ArrayType(BaseTy, E->getValues()->count());
+    auto ArrTy = TC.Ctx.getArrayType(BaseTy, E->getValues()->count());
     E->setType(ArrTy);
     return E;
   }
 
   Expr *visitIdentifierExpr(IdentifierExpr *E) {
-    if (auto D = TC.Lookup.getVal(E->getName())) {
+    if (auto D = TC.Lookup.getVal(E->getIdentifier())) {
+      E->setDecl(D);
       if (auto Ty = D->getType()) {
         if (auto InOut = dynamic_cast<InOutType *>(Ty))
           E->setType(InOut->getBaseType());
@@ -246,7 +259,8 @@ private:
           E->setType(D->getType());
       }
 
-    } else if (auto Fn = TC.Lookup.getFunc(E->getName())) {
+    } else if (auto Fn = TC.Lookup.getFunc(E->getIdentifier())) {
+      E->setDecl(Fn);
       if (Fn->getType())
         E->setType(Fn->getType());
 
@@ -266,7 +280,7 @@ private:
     
     } else if (BaseTy) {
       if (BaseTy->isRefType()) {
-        Base->setType(new (TC.Ctx) InOutType(BaseTy));
+        Base->setType(TC.Ctx.getInOutType(BaseTy));
       } else {
         TC.diagnose(Base->getLocStart(), diag::inout_expression_non_ref_type);
       }
@@ -336,6 +350,10 @@ private:
     E->setCallee(typeCheckExpr(E->getCallee()));
     TC.typeCheckPattern(E->getArgs());
 
+    // Bind the call to the declaration of the callee.
+    if (auto Callee = dynamic_cast<IdentifierExpr *>(E->getCallee()))
+      E->setCalleeDecl(dynamic_cast<FuncDecl *>(Callee->getDecl()));
+
     // Calle must be function type.
     auto FnTy = dynamic_cast<FunctionType *>(E->getCallee()->getType());
     auto ArgsTy = E->getArgs()->getType();
@@ -42,7 +42,7 @@ private:
       if (!Tys.back())
         return;
     }
-    P->setType(new (TC.Ctx) PatternType(std::move(Tys)));
+    P->setType(TC.Ctx.getPatternType(Tys));
   }
 
   void visitVarPattern(VarPattern *P) {
@@ -53,7 +53,7 @@ private:
       if (!Tys.back())
         return;
     }
-    P->setType(new (TC.Ctx) PatternType(std::move(Tys)));
+    P->setType(TC.Ctx.getPatternType(Tys));
   }
 
 public:
@@ -13,6 +13,7 @@
 #include "dusk/AST/Scope.h"
 #include "dusk/AST/NameLookup.h"
 #include "dusk/AST/ASTVisitor.h"
+#include "dusk/Basic/TimeTrace.h"
 
 #include "TypeChecker.h"
 
@@ -99,6 +100,7 @@ private:
   }
 
   void visitFuncStmt(FuncStmt *S) {
+    TimeTraceScope Trace("TypeCheckFunction", S->getPrototype()->getName());
     PushScopeRAII Push(TC.ASTScope, Scope::FnScope, S);
     TC.Lookup.push();
     TC.typeCheckDecl(S->getPrototype());
@@ -147,3 +149,21 @@ public:
 void TypeChecker::typeCheckStmt(Stmt *S) {
   StmtChecker(*this).typeCheckStmt(S);
 }
+
+void TypeChecker::typeCheckFuncPrototype(FuncStmt *S) {
+  PushScopeRAII Push(ASTScope, Scope::FnScope, S);
+  Lookup.push();
+  typeCheckDecl(S->getPrototype());
+  Lookup.pop();
+}
+
+void TypeChecker::typeCheckFuncBody(FuncStmt *S) {
+  TimeTraceScope Trace("TypeCheckFunction", S->getPrototype()->getName());
+  PushScopeRAII Push(ASTScope, Scope::FnScope, S);
+  Lookup.push();
+  // Parameters are already checked, only make them visible to the body.
+  for (auto P : S->getPrototype()->getFuncDecl()->getArgs()->getVars())
+    Lookup.declareVar(P);
+  typeCheckStmt(S->getBody());
+  Lookup.pop();
+}
@@ -68,7 +68,7 @@ private:
       TC.diagnose(TR->getSize()->getLocStart(), diag::variable_array_size);
       return;
     }
-    auto Ty = new (TC.Ctx) ArrayType(BaseTy, Size->getValue());
+    auto Ty = TC.Ctx.getArrayType(BaseTy, Size->getValue());
     TR->setType(Ty);
   }
   
@@ -81,7 +81,7 @@ private:
     if (dynamic_cast<ArrayType *>(BaseTy) == nullptr)
       return TC.diagnose(TR->getLocStart(), diag::inout_parameter_non_ref_type);
     
-    TR->setType(new (TC.Ctx) InOutType(BaseTy));
+    TR->setType(TC.Ctx.getInOutType(BaseTy));
   }
 
 public:
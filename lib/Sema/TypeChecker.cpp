@@ -38,7 +38,7 @@ public:
   
   Expr *postWalkExpr(Expr *E) {
     if (auto Ident = dynamic_cast<IdentifierExpr *>(E))
-      if (auto D = static_cast<ValDecl *>(TC.Lookup.getVal(Ident->getName())))
+      if (auto D = dynamic_cast<ValDecl *>(Ident->getDecl()))
         if (D->isLet())
           TC.diagnose(E->getLocStart(), diag::cannot_reassign_let_value);
     return E;
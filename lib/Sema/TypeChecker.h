@@ -58,6 +58,15 @@ public:
   void typeCheckStmt(Stmt *S);
   void typeCheckPattern(Pattern *P);
   void typeCheckType(TypeRepr *TR);
+
+  /// Type checks prototype of the function \c S without its body.
+  void typeCheckFuncPrototype(FuncStmt *S);
+
+  /// \brief Type checks body of the function \c S.
+  ///
+  /// The prototype must have been already checked by
+  /// \c typeCheckFuncPrototype.
+  void typeCheckFuncBody(FuncStmt *S);
 };
 
 } // namespace sema
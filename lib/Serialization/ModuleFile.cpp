@@ -0,0 +1,222 @@
+//===--- ModuleFile.cpp ---------------------------------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ModuleFile.h"
+#include "dusk/AST/ASTContext.h"
+#include "dusk/AST/Decl.h"
+#include "dusk/AST/Expr.h"
+#include "dusk/AST/Pattern.h"
+#include "dusk/AST/Type.h"
+#include "llvm/ADT/SmallVector.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+using namespace dusk;
+using namespace serialization;
+
+ModuleFile::ModuleFile(ASTContext &C, std::unique_ptr<llvm::MemoryBuffer> B)
+    : Ctx(C), Buffer(std::move(B)), Decls(nullptr), Types(nullptr) {
+  Header = reinterpret_cast<const ModuleHeader *>(Buffer->getBufferStart());
+}
+
+std::unique_ptr<ModuleFile> ModuleFile::load(ASTContext &C, StringRef Path) {
+  // Interfaces are never modified in place, so the file may be mapped.
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*FileSize=*/-1,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer)
+    return nullptr;
+
+  std::unique_ptr<ModuleFile> MF(new ModuleFile(C, std::move(*Buffer)));
+  if (!MF->validate())
+    return nullptr;
+  return MF;
+}
+
+bool ModuleFile::validate() {
+  auto Size = Buffer->getBufferSize();
+  if (Size < sizeof(ModuleHeader) ||
+      std::memcmp(Header->Signature, ModuleSignature,
+                  sizeof(ModuleSignature)) != 0 ||
+      Header->Version != ModuleFormatVersion)
+    return false;
+
+  // Computed in 64 bits, so that malformed sizes cannot overflow.
+  auto inBounds = [Size](uint64_t Offset, uint64_t Bytes) {
+    return Offset <= Size && Bytes <= Size - Offset;
+  };
+  if (!inBounds(Header->DeclsOffset,
+                uint64_t(Header->NumDecls) * sizeof(DeclRecord)) ||
+      !inBounds(Header->TypesOffset,
+                uint64_t(Header->NumTypeWords) * sizeof(ulittle32_t)) ||
+      !inBounds(Header->StringsOffset, Header->StringsSize))
+    return false;
+
+  auto Start = Buffer->getBufferStart();
+  Decls = reinterpret_cast<const DeclRecord *>(Start + Header->DeclsOffset);
+  Types = reinterpret_cast<const ulittle32_t *>(Start + Header->TypesOffset);
+  Strings = StringRef(Start + Header->StringsOffset, Header->StringsSize);
+  return true;
+}
+
+StringRef ModuleFile::getString(const StringRecord &R) const {
+  if (R.Offset > Strings.size() || R.Size > Strings.size() - R.Offset)
+    return StringRef();
+  return Strings.substr(R.Offset, R.Size);
+}
+
+StringRef ModuleFile::getObjectFile() const {
+  return getString(Header->ObjectFile);
+}
+
+const DeclRecord *ModuleFile::findRecord(StringRef Name) const {
+  auto End = Decls + Header->NumDecls;
+  auto It = std::lower_bound(Decls, End, Name,
+                             [this](const DeclRecord &R, StringRef N) {
+                               return getString(R.Name) < N;
+                             });
+  if (It == End || getString(It->Name) != Name)
+    return nullptr;
+  return It;
+}
+
+Decl *ModuleFile::lookupFunc(Identifier Name) {
+  return lookup(Name, DeclRecordKind::Func);
+}
+
+Decl *ModuleFile::lookupVal(Identifier Name) {
+  return lookup(Name, DeclRecordKind::Let);
+}
+
+Decl *ModuleFile::lookup(Identifier Name, DeclRecordKind K) {
+  auto R = findRecord(Name);
+  if (!R || R->Kind != static_cast<uint32_t>(K))
+    return nullptr;
+
+  std::lock_guard<std::mutex> Guard(Lock);
+  auto It = Materialized.find(Name);
+  if (It != Materialized.end())
+    return It->second;
+
+  auto D = K == DeclRecordKind::Func ? materializeFunc(Name, *R)
+                                     : materializeLet(Name, *R);
+  Materialized[Name] = D;
+  return D;
+}
+
+Type *ModuleFile::readType(uint32_t Offset) {
+  auto NumWords = Header->NumTypeWords;
+  // Operands of a type always precede it, which rules out cycles.
+  auto operand = [&](uint32_t Idx) -> Type * {
+    if (Offset + Idx >= NumWords || Types[Offset + Idx] >= Offset)
+      return nullptr;
+    return readType(Types[Offset + Idx]);
+  };
+
+  if (Offset >= NumWords)
+    return nullptr;
+  switch (static_cast<TypeCode>(uint32_t(Types[Offset]))) {
+  case TypeCode::Int:
+    return Ctx.getIntType();
+  case TypeCode::Void:
+    return Ctx.getVoidType();
+
+  case TypeCode::Array: {
+    auto Base = operand(1);
+    if (!Base || Offset + 2 >= NumWords)
+      return nullptr;
+    return Ctx.getArrayType(Base, Types[Offset + 2]);
+  }
+
+  case TypeCode::InOut:
+    if (auto Base = operand(1))
+      return Ctx.getInOutType(Base);
+    return nullptr;
+
+  case TypeCode::Function: {
+    auto Args = operand(1);
+    auto Ret = operand(2);
+    if (!Args || !Ret)
+      return nullptr;
+    return Ctx.getFunctionType(Args, Ret);
+  }
+
+  case TypeCode::Pattern: {
+    if (Offset + 1 >= NumWords)
+      return nullptr;
+    uint32_t N = Types[Offset + 1];
+    if (N > NumWords - Offset - 2)
+      return nullptr;
+    SmallVector<Type *, 8> Items;
+    for (uint32_t i = 0; i < N; i++) {
+      auto Item = operand(i + 2);
+      if (!Item)
+        return nullptr;
+      Items.push_back(Item);
+    }
+    return Ctx.getPatternType(Items);
+  }
+  }
+  return nullptr;
+}
+
+template <typename T, typename... Args> T *ModuleFile::create(Args &&... As) {
+  // Declarations may be looked up while a function body is being parsed into
+  // its own arena, but they are shared by the whole module.
+  auto Mem = Ctx.AllocatePermanent(sizeof(T), alignof(T));
+  return new (Mem) T(std::forward<Args>(As)...);
+}
+
+Decl *ModuleFile::materializeFunc(Identifier Name, const DeclRecord &R) {
+  auto FnTy = dynamic_cast<FunctionType *>(readType(R.Type));
+  if (!FnTy)
+    return nullptr;
+  auto ArgsTy = dynamic_cast<PatternType *>(FnTy->getArgsType());
+  if (!ArgsTy)
+    return nullptr;
+
+  SmallVector<StringRef, 8> Names;
+  auto Params = getString(R.Params);
+  if (!Params.empty())
+    Params.split(Names, ',');
+  if (Names.size() != ArgsTy->getItems().size())
+    return nullptr;
+
+  SmallVector<Decl *, 128> Args;
+  for (size_t i = 0, e = Names.size(); i < e; i++) {
+    auto Ty = ArgsTy->getItems()[i];
+    auto Spec = dynamic_cast<InOutType *>(Ty) ? ValDecl::Specifier::InOut
+                                              : ValDecl::Specifier::Default;
+    auto P = create<ParamDecl>(Spec, Ctx.getIdentifier(Names[i]), SMLoc());
+    P->setType(Ty);
+    P->setImported();
+    Args.push_back(P);
+  }
+
+  auto Pattern = create<VarPattern>(std::move(Args), SMLoc(), SMLoc());
+  Pattern->setType(ArgsTy);
+  auto D = create<FuncDecl>(Name, SMLoc(), SMLoc(), Pattern);
+  D->setType(FnTy);
+  D->setImported();
+  return D;
+}
+
+Decl *ModuleFile::materializeLet(Identifier Name, const DeclRecord &R) {
+  auto Ty = readType(R.Type);
+  if (!Ty || Ty->getKind() != TypeKind::Int)
+    return nullptr;
+
+  auto Val = create<NumberLiteralExpr>(int64_t(R.Value), SMRange());
+  Val->setType(Ty);
+  auto D = create<VarDecl>(ValDecl::Specifier::Let, Name, SMLoc(), SMLoc(),
+                           Val);
+  D->setType(Ty);
+  D->setImported();
+  return D;
+}
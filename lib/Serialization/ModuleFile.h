@@ -0,0 +1,91 @@
+//===--- ModuleFile.h - Loaded module interface -----------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_SERIALIZATION_MODULE_FILE_H
+#define DUSK_SERIALIZATION_MODULE_FILE_H
+
+#include "dusk/Basic/LLVM.h"
+#include "dusk/AST/NameLookup.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include <memory>
+#include <mutex>
+
+#include "ModuleFormat.h"
+
+namespace dusk {
+class ASTContext;
+class Decl;
+class Type;
+
+/// \brief Module interface mapped into memory.
+///
+/// Declarations of the module are materialized into the AST of the importing
+/// module lazily, when they are looked up for the first time.
+class ModuleFile : public ExternalNameSource {
+  ASTContext &Ctx;
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+
+  const serialization::ModuleHeader *Header;
+  const serialization::DeclRecord *Decls;
+  const serialization::ulittle32_t *Types;
+  StringRef Strings;
+
+  /// Already materialized declarations.
+  llvm::DenseMap<Identifier, Decl *> Materialized;
+
+  /// Guards materialization, since lookups may be called concurrently.
+  std::mutex Lock;
+
+  ModuleFile(ASTContext &C, std::unique_ptr<llvm::MemoryBuffer> B);
+
+public:
+  /// \brief Opens module interface \c Path.
+  ///
+  /// \return The module file, or \c nullptr if the file could not be read or
+  ///   is not a valid module interface.
+  static std::unique_ptr<ModuleFile> load(ASTContext &C, StringRef Path);
+
+  /// Returns path of the object file defining the module.
+  StringRef getObjectFile() const;
+
+  Decl *lookupFunc(Identifier Name) override;
+  Decl *lookupVal(Identifier Name) override;
+
+private:
+  /// Locates tables of the module, returns \c true if all of them lie
+  /// within the buffer.
+  bool validate();
+
+  /// Returns the record of declaration \c Name, or \c nullptr if there is
+  /// none.
+  const serialization::DeclRecord *findRecord(StringRef Name) const;
+
+  /// Returns the declaration of given kind named \c Name, materializing it
+  /// if needed.
+  Decl *lookup(Identifier Name, serialization::DeclRecordKind K);
+
+  StringRef getString(const serialization::StringRecord &R) const;
+
+  /// Decodes type at word offset \c Offset, or returns \c nullptr if
+  /// the type is malformed.
+  Type *readType(uint32_t Offset);
+
+  Decl *materializeFunc(Identifier Name, const serialization::DeclRecord &R);
+  Decl *materializeLet(Identifier Name, const serialization::DeclRecord &R);
+
+  /// Allocates a node, which lives as long as the context, regardless of
+  /// the arena currently serving allocations of nodes.
+  template <typename T, typename... Args> T *create(Args &&... As);
+};
+
+} // namespace dusk
+
+#endif /* DUSK_SERIALIZATION_MODULE_FILE_H */
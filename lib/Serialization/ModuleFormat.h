@@ -0,0 +1,119 @@
+//===--- ModuleFormat.h - Binary module interface format --------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+//
+// A module interface (.duskmodule) describes public declarations of
+// a compiled module. The file is designed to be mapped into memory and used
+// in place, nothing is decoded until a declaration is looked up.
+//
+// The file consists of:
+//
+//   - A fixed size \c ModuleHeader.
+//   - A table of \c DeclRecord entries sorted by name, which is searched
+//     by binary search.
+//   - A table of types encoded as sequences of 32-bit words, declarations
+//     refer to types by their word offset. Every type refers only to types
+//     preceding it.
+//   - A string table holding names of declarations and parameters and path
+//     of the object file of the module.
+//
+// All integers are little endian and unaligned.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_SERIALIZATION_MODULE_FORMAT_H
+#define DUSK_SERIALIZATION_MODULE_FORMAT_H
+
+#include "llvm/Support/Endian.h"
+#include <cstdint>
+
+namespace dusk {
+namespace serialization {
+
+using llvm::support::little64_t;
+using llvm::support::ulittle32_t;
+
+/// Signature at the start of every module interface.
+const char ModuleSignature[8] = {'D', 'U', 'S', 'K', 'M', 'O', 'D', '\0'};
+
+/// Version of the format, incremented on every incompatible change.
+const uint32_t ModuleFormatVersion = 1;
+
+/// Reference into the string table.
+struct StringRecord {
+  ulittle32_t Offset;
+  ulittle32_t Size;
+};
+
+struct ModuleHeader {
+  char Signature[8];
+  ulittle32_t Version;
+
+  /// Number of entries of the declaration table.
+  ulittle32_t NumDecls;
+
+  /// Offset of the declaration table.
+  ulittle32_t DeclsOffset;
+
+  /// Offset and number of words of the type table.
+  ulittle32_t TypesOffset;
+  ulittle32_t NumTypeWords;
+
+  /// Offset and size of the string table.
+  ulittle32_t StringsOffset;
+  ulittle32_t StringsSize;
+
+  /// Path of the object file defining the module.
+  StringRecord ObjectFile;
+};
+
+/// Kind of a declaration record.
+enum class DeclRecordKind : uint32_t {
+  /// A function, \c Params holds comma separated names of its parameters.
+  Func,
+
+  /// A global constant of integer type, \c Value holds its value.
+  Let
+};
+
+struct DeclRecord {
+  StringRecord Name;
+  ulittle32_t Kind;
+
+  /// Word offset of the type of the declaration in the type table.
+  ulittle32_t Type;
+
+  StringRecord Params;
+  little64_t Value;
+};
+
+/// Code of a type in the type table, followed by its operands.
+enum class TypeCode : uint32_t {
+  /// No operands.
+  Int,
+
+  /// No operands.
+  Void,
+
+  /// Operands: base type, number of elements.
+  Array,
+
+  /// Operands: base type.
+  InOut,
+
+  /// Operands: type of arguments, return type.
+  Function,
+
+  /// Operands: number of items N, followed by N item types.
+  Pattern
+};
+
+} // namespace serialization
+} // namespace dusk
+
+#endif /* DUSK_SERIALIZATION_MODULE_FORMAT_H */
@@ -0,0 +1,208 @@
+//===--- Serialization.cpp ------------------------------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Serialization/Serialization.h"
+#include "dusk/AST/Decl.h"
+#include "dusk/AST/Expr.h"
+#include "dusk/AST/Pattern.h"
+#include "dusk/AST/Stmt.h"
+#include "dusk/AST/Type.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ModuleFormat.h"
+
+using namespace dusk;
+using namespace serialization;
+
+namespace {
+
+/// Builds tables of a module interface in memory.
+class ModuleWriter {
+  std::vector<DeclRecord> Decls;
+  std::vector<ulittle32_t> Types;
+  std::string Strings;
+
+  /// Word offsets of already encoded types.
+  llvm::DenseMap<Type *, uint32_t> TypeOffsets;
+
+public:
+  /// Adds prototype of function \c D.
+  void addFunc(FuncDecl *D) {
+    std::string Params;
+    for (auto P : D->getArgs()->getVars()) {
+      if (!Params.empty())
+        Params += ',';
+      Params += P->getName();
+    }
+    Decls.push_back(makeRecord(D, DeclRecordKind::Func, Params, 0));
+  }
+
+  /// Adds global constant \c D of value \c Value.
+  void addLet(Decl *D, int64_t Value) {
+    Decls.push_back(makeRecord(D, DeclRecordKind::Let, "", Value));
+  }
+
+  /// Writes the interface into \c OS.
+  void write(raw_ostream &OS, StringRef ObjectFile) {
+    // Records are looked up by binary search.
+    std::sort(Decls.begin(), Decls.end(),
+              [this](const DeclRecord &L, const DeclRecord &R) {
+                return getString(L.Name) < getString(R.Name);
+              });
+
+    ModuleHeader H;
+    std::memcpy(H.Signature, ModuleSignature, sizeof(H.Signature));
+    H.Version = ModuleFormatVersion;
+    H.ObjectFile = addString(ObjectFile);
+    H.NumDecls = Decls.size();
+    H.DeclsOffset = sizeof(ModuleHeader);
+    H.TypesOffset = H.DeclsOffset + Decls.size() * sizeof(DeclRecord);
+    H.NumTypeWords = Types.size();
+    H.StringsOffset = H.TypesOffset + Types.size() * sizeof(ulittle32_t);
+    H.StringsSize = Strings.size();
+
+    OS.write(reinterpret_cast<const char *>(&H), sizeof(H));
+    OS.write(reinterpret_cast<const char *>(Decls.data()),
+             Decls.size() * sizeof(DeclRecord));
+    OS.write(reinterpret_cast<const char *>(Types.data()),
+             Types.size() * sizeof(ulittle32_t));
+    OS << Strings;
+  }
+
+private:
+  DeclRecord makeRecord(Decl *D, DeclRecordKind K, StringRef Params,
+                        int64_t Value) {
+    DeclRecord R;
+    R.Name = addString(D->getName());
+    R.Kind = static_cast<uint32_t>(K);
+    R.Type = addType(D->getType());
+    R.Params = addString(Params);
+    R.Value = Value;
+    return R;
+  }
+
+  StringRecord addString(StringRef Str) {
+    StringRecord R;
+    R.Offset = Strings.size();
+    R.Size = Str.size();
+    Strings += Str;
+    return R;
+  }
+
+  StringRef getString(const StringRecord &R) const {
+    return StringRef(Strings).substr(R.Offset, R.Size);
+  }
+
+  /// Encodes type \c Ty and returns its word offset.
+  uint32_t addType(Type *Ty) {
+    auto It = TypeOffsets.find(Ty);
+    if (It != TypeOffsets.end())
+      return It->second;
+
+    // Operands are encoded before the type itself.
+    SmallVector<uint32_t, 8> Words;
+    switch (Ty->getKind()) {
+    case TypeKind::Int:
+      Words.push_back(static_cast<uint32_t>(TypeCode::Int));
+      break;
+    case TypeKind::Void:
+      Words.push_back(static_cast<uint32_t>(TypeCode::Void));
+      break;
+    case TypeKind::Array: {
+      auto ATy = Ty->getArrayType();
+      auto Base = addType(ATy->getBaseType());
+      Words.append({static_cast<uint32_t>(TypeCode::Array), Base,
+                    static_cast<uint32_t>(ATy->getSize())});
+      break;
+    }
+    case TypeKind::InOut: {
+      auto Base = addType(Ty->getInOutType()->getBaseType());
+      Words.append({static_cast<uint32_t>(TypeCode::InOut), Base});
+      break;
+    }
+    case TypeKind::Function: {
+      auto FTy = Ty->getFunctionType();
+      auto Args = addType(FTy->getArgsType());
+      auto Ret = addType(FTy->getRetType());
+      Words.append({static_cast<uint32_t>(TypeCode::Function), Args, Ret});
+      break;
+    }
+    case TypeKind::Pattern: {
+      auto PTy = Ty->getPatternType();
+      SmallVector<uint32_t, 8> Items;
+      for (auto I : PTy->getItems())
+        Items.push_back(addType(I));
+      Words.append({static_cast<uint32_t>(TypeCode::Pattern),
+                    static_cast<uint32_t>(Items.size())});
+      Words.append(Items.begin(), Items.end());
+      break;
+    }
+    }
+
+    uint32_t Offset = Types.size();
+    for (auto W : Words) {
+      ulittle32_t Word;
+      Word = W;
+      Types.push_back(Word);
+    }
+    TypeOffsets[Ty] = Offset;
+    return Offset;
+  }
+};
+
+} // anonymous namespace
+
+bool dusk::serializeModule(ModuleDecl *M, StringRef Path, StringRef ObjectFile,
+                           raw_ostream &OS) {
+  ModuleWriter Writer;
+  for (auto N : M->getContents()) {
+    if (auto FS = dynamic_cast<FuncStmt *>(N)) {
+      auto FD = static_cast<FuncDecl *>(FS->getPrototype());
+      if (FD->getName() != "main" && FD->getType())
+        Writer.addFunc(FD);
+    } else if (auto D = dynamic_cast<VarDecl *>(N)) {
+      // Only integer constants have a value known at compile time.
+      auto Val = dynamic_cast<NumberLiteralExpr *>(D->getValue());
+      if (D->isLet() && Val && D->getType() &&
+          D->getType()->getKind() == TypeKind::Int)
+        Writer.addLet(D, Val->getValue());
+    }
+  }
+
+  // Importers find the object file regardless of their working directory.
+  SmallString<128> Object(ObjectFile);
+  llvm::sys::fs::make_absolute(Object);
+
+  // Interface is written under a temporary name and renamed into place,
+  // since other compilers may have the previous one mapped into memory.
+  auto Temp = llvm::sys::fs::TempFile::create(Path + "-%%%%%%%%.tmp");
+  if (!Temp) {
+    OS << "Could not create module interface '" << Path
+       << "': " << toString(Temp.takeError()) << "\n";
+    return false;
+  }
+  {
+    llvm::raw_fd_ostream File(Temp->FD, /*shouldClose=*/false);
+    Writer.write(File, Object);
+  }
+  if (auto Err = Temp->keep(Path)) {
+    OS << "Could not write module interface '" << Path
+       << "': " << toString(std::move(Err)) << "\n";
+    llvm::consumeError(Temp->discard());
+    return false;
+  }
+  return true;
+}
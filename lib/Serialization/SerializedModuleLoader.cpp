@@ -0,0 +1,62 @@
+//===--- SerializedModuleLoader.cpp ---------------------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Serialization/SerializedModuleLoader.h"
+#include "dusk/AST/Decl.h"
+#include "dusk/AST/Diagnostics.h"
+#include "dusk/Serialization/Serialization.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+
+#include "ModuleFile.h"
+
+using namespace dusk;
+
+SerializedModuleLoader::SerializedModuleLoader(ASTContext &C,
+                                               std::vector<std::string> Paths)
+    : Ctx(C), SearchPaths(std::move(Paths)) {}
+
+SerializedModuleLoader::~SerializedModuleLoader() = default;
+
+ExternalNameSource *SerializedModuleLoader::loadModule(ImportDecl *D,
+                                                       DiagnosticEngine &Diag) {
+  std::lock_guard<std::mutex> Guard(Lock);
+  auto Name = D->getName().str();
+  auto It = Modules.find(Name);
+  if (It != Modules.end())
+    return It->second.get();
+
+  for (auto &Dir : SearchPaths) {
+    SmallString<128> Path(Dir);
+    llvm::sys::path::append(Path, Name);
+    llvm::sys::path::replace_extension(Path, ModuleInterfaceExtension);
+    if (!llvm::sys::fs::exists(Path))
+      continue;
+
+    auto MF = ModuleFile::load(Ctx, Path);
+    if (!MF) {
+      Diag.diagnose(D->getNameLoc(), diag::invalid_module_file);
+      return nullptr;
+    }
+    auto Source = MF.get();
+    Modules[Name] = std::move(MF);
+    return Source;
+  }
+
+  Diag.diagnose(D->getNameLoc(), diag::unknown_module);
+  return nullptr;
+}
+
+std::vector<std::string> SerializedModuleLoader::getObjectFiles() const {
+  std::vector<std::string> Files;
+  for (auto &M : Modules)
+    Files.push_back(M.second->getObjectFile().str());
+  return Files;
+}
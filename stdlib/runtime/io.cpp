@@ -9,6 +9,8 @@
 
 #include "io.h"
 
+#include <cstdio>
+
 void println(int64_t Value) {
   fprintf(stdout, "%lld\n", Value);
   return;
@@ -10,7 +10,7 @@
 #ifndef DUSK_STDLIB_RUNTIME_IO
 #define DUSK_STDLIB_RUNTIME_IO
 
-#include <iostream>
+#include <cstdint>
 
 #ifdef _WIN32
 #define DLLEXPORT __declspec(dllexport)
@@ -9,7 +9,7 @@
 
 #include "iter.h"
 
-#include <iostream>
+#include <cstdlib>
 
 int64_t __iter_range(int64_t Start, int64_t End) {
   auto Diff = (Start > 0 && End < 0) || (Start < 0 && End > 0)
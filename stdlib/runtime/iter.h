@@ -10,7 +10,7 @@
 #ifndef DUSK_STDLIB_RUNTIME_ITER
 #define DUSK_STDLIB_RUNTIME_ITER
 
-#include <iostream>
+#include <cstdint>
 
 #ifdef _WIN32
 #define DLLEXPORT __declspec(dllexport)
@@ -0,0 +1,306 @@
+//===--- main.cpp - Dusk frontend benchmarks --------------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Basic/LLVM.h"
+#include "dusk/AST/ASTContext.h"
+#include "dusk/AST/Diagnostics.h"
+#include "dusk/Basic/SourceManager.h"
+#include "dusk/Frontend/CompilerInvocation.h"
+#include "dusk/Frontend/SourceFile.h"
+#include "dusk/Parse/Lexer.h"
+#include "dusk/Parse/Parser.h"
+#include "dusk/Parse/TokenStream.h"
+#include "dusk/Runtime/RuntimeFuncs.h"
+#include "dusk/Sema/Sema.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dusk;
+using namespace llvm;
+
+enum class Phase { Lex, Keywords, Tokens, Identifiers, Parse, Sema };
+
+cl::opt<std::string> InFile(cl::Positional, cl::Required,
+                            cl::desc("<input file>"));
+
+cl::opt<Phase> BenchPhase(
+    "phase", cl::desc("Choose measured phase of the frontend"),
+    cl::values(clEnumValN(Phase::Lex, "lex", "Lex the input (default)"),
+               clEnumValN(Phase::Keywords, "keywords",
+                          "Classify identifiers and keywords of the input"),
+               clEnumValN(Phase::Tokens, "tokens",
+                          "Fill and read a token stream of the input"),
+               clEnumValN(Phase::Identifiers, "identifiers",
+                          "Intern and look up identifiers of the input"),
+               clEnumValN(Phase::Parse, "parse", "Parse the input"),
+               clEnumValN(Phase::Sema, "sema", "Type check the input")),
+    cl::init(Phase::Lex));
+
+cl::opt<unsigned> Runs("runs", cl::desc("Number of measured runs"),
+                       cl::value_desc("<N>"), cl::init(10));
+
+cl::opt<LexingMode> LexMode(
+    "lex-mode", cl::desc("Choose how the input is lexed for the parser"),
+    cl::values(clEnumValN(LexingMode::OnDemand, "on-demand",
+                          "Lex tokens as the parser consumes them"),
+               clEnumValN(LexingMode::Buffered, "buffered",
+                          "Lex the whole input before parsing"),
+               clEnumValN(LexingMode::Threaded, "threaded",
+                          "Lex the input on a separate thread")),
+    cl::init(LexingMode::OnDemand));
+
+cl::opt<unsigned> SemaJobs("sema-jobs",
+                           cl::desc("Number of threads type checking function "
+                                    "bodies of a single file"),
+                           cl::value_desc("<N>"), cl::init(1));
+
+using Clock = std::chrono::steady_clock;
+
+/// Returns average time in milliseconds of \c Runs calls of \c Fn, after
+/// a single warm-up call.
+template <typename Fn> static double measure(Fn &&F) {
+  F();
+  auto Start = Clock::now();
+  for (unsigned I = 0; I < Runs; I++)
+    F();
+  std::chrono::duration<double, std::milli> Elapsed = Clock::now() - Start;
+  return Elapsed.count() / Runs;
+}
+
+/// Prints time of processing the whole input and its throughput.
+static void report(StringRef Name, double Time, size_t Size) {
+  outs() << format("%-12s %10.3f ms %10.1f MB/s\n", Name.str().c_str(), Time,
+                   Size / (Time * 1e3));
+}
+
+/// Prints time of a single operation out of \c N.
+static void reportEach(StringRef Name, double Time, size_t N) {
+  outs() << format("%-12s %10.3f ms %10.2f ns each\n", Name.str().c_str(),
+                   Time, Time * 1e6 / N);
+}
+
+/// Prints every diagnostic, so that an invalid input is not measured.
+class DiagPrinter : public DiagnosticConsumer {
+public:
+  void consume(SMDiagnostic &Diagnostic) override {
+    Diagnostic.print("dusk-bench", errs());
+  }
+};
+
+// MARK: - Lexer
+
+static std::vector<Token> lexAll(SourceManager &SM, unsigned ID) {
+  std::vector<Token> Tokens;
+  Lexer L(SM, ID);
+  Token T;
+  do {
+    L.lex(T);
+    Tokens.push_back(T);
+  } while (T.isNot(tok::eof));
+  return Tokens;
+}
+
+static void benchLex(SourceManager &SM, unsigned ID, size_t Size) {
+  size_t NumTokens = 0;
+  auto Time = measure([&] {
+    Lexer L(SM, ID);
+    Token T;
+    NumTokens = 0;
+    do {
+      L.lex(T);
+      NumTokens++;
+    } while (T.isNot(tok::eof));
+  });
+  report("lex", Time, Size);
+  outs() << NumTokens << " tokens\n";
+}
+
+static void benchKeywords(SourceManager &SM, unsigned ID) {
+  std::vector<StringRef> Words;
+  for (auto &T : lexAll(SM, ID))
+    if (T.is(tok::identifier) || T.isKeyword())
+      Words.push_back(T.getText());
+
+  // Sum of the kinds keeps the lookups from being optimized out.
+  volatile unsigned Sink = 0;
+  auto Time = measure([&] {
+    unsigned Sum = 0;
+    for (auto W : Words)
+      Sum += unsigned(Lexer::kindOfIdentifier(W));
+    Sink = Sum;
+  });
+  (void)Sink;
+  reportEach("keywords", Time, Words.size());
+  outs() << Words.size() << " identifiers and keywords\n";
+}
+
+// MARK: - Identifiers
+
+static void benchIdentifiers(SourceManager &SM, unsigned ID) {
+  std::vector<StringRef> Names;
+  for (auto &T : lexAll(SM, ID))
+    if (T.is(tok::identifier))
+      Names.push_back(T.getText());
+
+  auto Intern = measure([&] {
+    ASTContext Ctx;
+    for (auto N : Names)
+      Ctx.getIdentifier(N);
+  });
+  reportEach("intern", Intern, Names.size());
+
+  // Tables of declarations keyed by spelling and by interned identifier.
+  ASTContext Ctx;
+  std::vector<Identifier> Idents;
+  StringMap<unsigned> ByName;
+  DenseMap<Identifier, unsigned> ByIdent;
+  for (auto N : Names) {
+    Idents.push_back(Ctx.getIdentifier(N));
+    ByName.try_emplace(N, ByName.size());
+    ByIdent.try_emplace(Idents.back(), ByIdent.size());
+  }
+
+  volatile unsigned Sink = 0;
+  auto NameLookup = measure([&] {
+    unsigned Sum = 0;
+    for (auto N : Names)
+      Sum += ByName.find(N)->second;
+    Sink = Sum;
+  });
+  auto IdentLookup = measure([&] {
+    unsigned Sum = 0;
+    for (auto I : Idents)
+      Sum += ByIdent.find(I)->second;
+    Sink = Sum;
+  });
+  (void)Sink;
+  reportEach("StringMap", NameLookup, Names.size());
+  reportEach("DenseMap", IdentLookup, Names.size());
+  outs() << Names.size() << " identifiers, " << ByName.size() << " unique\n";
+}
+
+// MARK: - Parser
+
+static void benchTokens(SourceManager &SM, unsigned ID, size_t Size) {
+  size_t NumTokens = 0;
+  auto Fill = measure([&] {
+    TokenStream S(SM, ID, /*Threaded=*/false);
+    NumTokens = S.size();
+  });
+  report("fill", Fill, Size);
+
+  TokenStream S(SM, ID, /*Threaded=*/false);
+  volatile size_t Sink = 0;
+  auto Read = measure([&] {
+    size_t Sum = 0;
+    for (size_t I = 0; I < NumTokens; I++)
+      Sum += S[I].getText().size();
+    Sink = Sum;
+  });
+  (void)Sink;
+  reportEach("read", Read, NumTokens);
+  outs() << NumTokens << " tokens\n";
+}
+
+/// Parses the input into a new context. Returns \c nullptr on error.
+static std::unique_ptr<ASTContext> parse(SourceManager &SM, SourceFile &SF,
+                                         DiagnosticEngine &Diag) {
+  auto Ctx = std::make_unique<ASTContext>();
+  std::unique_ptr<TokenStream> Tokens;
+  if (LexMode != LexingMode::OnDemand)
+    Tokens = std::make_unique<TokenStream>(SM, SF.bufferID(),
+                                           LexMode == LexingMode::Threaded);
+  Parser P(*Ctx, SM, SF, Diag, SF.bufferID(), Tokens.get());
+  Ctx->setRootModule(P.parseModule());
+  if (Ctx->isError())
+    return nullptr;
+  return Ctx;
+}
+
+static int benchParse(SourceManager &SM, SourceFile &SF,
+                      DiagnosticEngine &Diag, size_t Size) {
+  bool IsError = false;
+  auto Time = measure([&] { IsError |= !parse(SM, SF, Diag); });
+  if (IsError)
+    return 1;
+  report("parse", Time, Size);
+  return 0;
+}
+
+// MARK: - Sema
+
+static int benchSema(SourceManager &SM, SourceFile &SF,
+                     DiagnosticEngine &Diag, size_t Size) {
+  // Only type checking is measured, every run checks a freshly parsed AST.
+  double Total = 0;
+  for (unsigned I = 0; I <= Runs; I++) {
+    auto Ctx = parse(SM, SF, Diag);
+    if (!Ctx)
+      return 1;
+    auto Start = Clock::now();
+    getFuncs(*Ctx);
+    sema::Sema S(*Ctx, Diag, SemaJobs);
+    S.perform();
+    std::chrono::duration<double, std::milli> Elapsed = Clock::now() - Start;
+    if (Ctx->isError())
+      return 1;
+    if (I != 0)
+      Total += Elapsed.count();
+  }
+  report("sema", Total / Runs, Size);
+  return 0;
+}
+
+int main(int argc, const char *argv[]) {
+  cl::ParseCommandLineOptions(argc, argv, "Dusk frontend benchmarks\n");
+
+  auto Buffer = MemoryBuffer::getFile(InFile);
+  if (!Buffer) {
+    errs() << "dusk-bench: error: cannot open '" << InFile
+           << "': " << Buffer.getError().message() << "\n";
+    return 1;
+  }
+  auto Size = (*Buffer)->getBufferSize();
+  auto BufferPtr = Buffer->get();
+
+  SourceManager SM;
+  auto ID = SM.AddNewSourceBuffer(std::move(*Buffer), SMLoc());
+  SourceFile SF(ID, BufferPtr, InFile);
+  DiagnosticEngine Diag(SM);
+  DiagPrinter Printer;
+  Diag.addConsumer(&Printer);
+
+  switch (BenchPhase) {
+  case Phase::Lex:
+    benchLex(SM, ID, Size);
+    return 0;
+  case Phase::Keywords:
+    benchKeywords(SM, ID);
+    return 0;
+  case Phase::Tokens:
+    benchTokens(SM, ID, Size);
+    return 0;
+  case Phase::Identifiers:
+    benchIdentifiers(SM, ID);
+    return 0;
+  case Phase::Parse:
+    return benchParse(SM, SF, Diag, Size);
+  case Phase::Sema:
+    return benchSema(SM, SF, Diag, Size);
+  }
+  llvm_unreachable("Unknown phase.");
+}
@@ -0,0 +1,403 @@
+//===--- main.cpp - Dusk language server ------------------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "dusk/Basic/LLVM.h"
+#include "dusk/Frontend/IncrementalDocument.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace dusk;
+using namespace llvm;
+
+cl::list<std::string> ImportPaths("I", cl::Prefix,
+                                  cl::desc("Add directory to the search path "
+                                           "of imported modules"),
+                                  cl::value_desc("<directory>"));
+
+cl::opt<std::string> RecordFile("record",
+                                cl::desc("Append all document changes "
+                                         "received from the client to a file"),
+                                cl::value_desc("<filename>"));
+
+cl::opt<std::string> ReplayFile("replay",
+                                cl::desc("Replay recorded document changes "
+                                         "and print latency of diagnostics "
+                                         "instead of serving a client"),
+                                cl::value_desc("<filename>"));
+
+namespace {
+
+/// Error code of JSON-RPC for an unknown method.
+const int64_t MethodNotFound = -32601;
+
+/// Converts a \c file URI into a path.
+std::string uriToPath(StringRef URI) {
+  if (!URI.consume_front("file://"))
+    return URI.str();
+
+  std::string Path;
+  for (size_t i = 0; i < URI.size(); i++) {
+    unsigned Char;
+    if (URI[i] == '%' && i + 2 < URI.size() &&
+        !URI.substr(i + 1, 2).getAsInteger(16, Char)) {
+      Path += char(Char);
+      i += 2;
+    } else {
+      Path += URI[i];
+    }
+  }
+  return Path;
+}
+
+/// \brief Language server, which keeps open documents parsed and type
+/// checked and publishes their diagnostics after every change.
+class LanguageServer {
+  /// Open documents keyed by their URI.
+  StringMap<std::unique_ptr<IncrementalDocument>> Docs;
+
+  /// Stream of messages to the client.
+  raw_ostream &OS;
+
+  /// Log of document changes, if they are recorded.
+  std::unique_ptr<raw_fd_ostream> Record;
+
+  bool IsShutdown = false;
+
+public:
+  /// Number of updates, which checked only edited function bodies.
+  unsigned NumIncremental = 0;
+
+  /// Number of updates, which rebuilt a whole document.
+  unsigned NumRebuilds = 0;
+
+  LanguageServer(raw_ostream &OS) : OS(OS) {}
+
+  /// Starts recording of document changes into \c Path.
+  bool startRecording(StringRef Path) {
+    std::error_code EC;
+    Record = std::make_unique<raw_fd_ostream>(Path, EC, sys::fs::F_Append);
+    if (EC) {
+      errs() << "dusk-lsp: error: cannot open '" << Path
+             << "': " << EC.message() << "\n";
+      return false;
+    }
+    return true;
+  }
+
+  /// \brief Handles a single message of the client.
+  ///
+  /// \return \c false if the server should exit, \c true otherwise.
+  bool handle(const json::Value &Msg);
+
+  /// Returns exit code of the server after the exit notification.
+  int getExitCode() const { return IsShutdown ? 0 : 1; }
+
+private:
+  void reply(const json::Value &ID, json::Value Result);
+  void replyError(const json::Value &ID, int64_t Code, StringRef Message);
+  void notify(StringRef Method, json::Value Params);
+  void send(json::Value Msg);
+
+  void didOpen(const json::Object &Params);
+  void didChange(const json::Object &Params);
+  void didClose(const json::Object &Params);
+
+  /// Brings document \c URI up to date and publishes its diagnostics.
+  void publishDiagnostics(StringRef URI, IncrementalDocument &Doc);
+};
+
+} // anonymous namespace
+
+bool LanguageServer::handle(const json::Value &Msg) {
+  auto Obj = Msg.getAsObject();
+  if (!Obj)
+    return true;
+  auto Method = Obj->getString("method");
+  if (!Method)
+    // Responses to requests of the server are not expected.
+    return true;
+  auto IDPtr = Obj->get("id");
+  json::Value ID = IDPtr ? *IDPtr : nullptr;
+
+  json::Object Empty;
+  auto Params = Obj->getObject("params");
+  if (!Params)
+    Params = &Empty;
+
+  if (Record && Method->startswith("textDocument/did")) {
+    *Record << Msg << "\n";
+    Record->flush();
+  }
+
+  if (*Method == "initialize") {
+    // Changes are sent incrementally, as ranges of the previous text.
+    json::Object Sync{{"openClose", true}, {"change", 2}};
+    reply(ID, json::Object{
+                  {"capabilities", json::Object{{"textDocumentSync",
+                                                 std::move(Sync)}}},
+                  {"serverInfo", json::Object{{"name", "dusk-lsp"}}}});
+  } else if (*Method == "shutdown") {
+    IsShutdown = true;
+    reply(ID, nullptr);
+  } else if (*Method == "exit") {
+    return false;
+  } else if (*Method == "textDocument/didOpen") {
+    didOpen(*Params);
+  } else if (*Method == "textDocument/didChange") {
+    didChange(*Params);
+  } else if (*Method == "textDocument/didClose") {
+    didClose(*Params);
+  } else if (IDPtr) {
+    replyError(ID, MethodNotFound, "Unknown method '" + Method->str() + "'");
+  }
+  // Other notifications, e.g. 'initialized', are ignored.
+  return true;
+}
+
+void LanguageServer::didOpen(const json::Object &Params) {
+  auto TD = Params.getObject("textDocument");
+  if (!TD)
+    return;
+  auto URI = TD->getString("uri");
+  auto Text = TD->getString("text");
+  if (!URI || !Text)
+    return;
+
+  auto &Doc = Docs[*URI];
+  Doc = std::make_unique<IncrementalDocument>(uriToPath(*URI), *Text,
+                                              ImportPaths);
+  publishDiagnostics(*URI, *Doc);
+}
+
+void LanguageServer::didChange(const json::Object &Params) {
+  auto TD = Params.getObject("textDocument");
+  auto Changes = Params.getArray("contentChanges");
+  if (!TD || !Changes)
+    return;
+  auto URI = TD->getString("uri");
+  if (!URI)
+    return;
+  auto It = Docs.find(*URI);
+  if (It == Docs.end())
+    return;
+
+  auto &Doc = *It->second;
+  auto getOffset = [&Doc](const json::Object *Pos) -> size_t {
+    auto Line = Pos ? Pos->getInteger("line") : None;
+    auto Char = Pos ? Pos->getInteger("character") : None;
+    return Doc.getOffset(Line ? *Line : 0, Char ? *Char : 0);
+  };
+
+  // Changes are applied in order, each to the text left by the previous one.
+  for (auto &C : *Changes) {
+    auto Change = C.getAsObject();
+    if (!Change)
+      continue;
+    auto Text = Change->getString("text");
+    if (!Text)
+      continue;
+    auto Range = Change->getObject("range");
+    if (!Range) {
+      Doc.setText(*Text);
+      continue;
+    }
+    auto Begin = getOffset(Range->getObject("start"));
+    auto End = std::max(Begin, getOffset(Range->getObject("end")));
+    Doc.edit(Begin, End - Begin, *Text);
+  }
+  publishDiagnostics(*URI, Doc);
+}
+
+void LanguageServer::didClose(const json::Object &Params) {
+  auto TD = Params.getObject("textDocument");
+  auto URI = TD ? TD->getString("uri") : None;
+  if (!URI)
+    return;
+  Docs.erase(*URI);
+  notify("textDocument/publishDiagnostics",
+         json::Object{{"uri", *URI}, {"diagnostics", json::Array()}});
+}
+
+void LanguageServer::publishDiagnostics(StringRef URI,
+                                        IncrementalDocument &Doc) {
+  if (Doc.update())
+    NumRebuilds++;
+  else
+    NumIncremental++;
+
+  json::Array Diags;
+  for (auto &D : Doc.getDiagnostics()) {
+    int Severity = 1;
+    if (D.Kind == SourceMgr::DK_Warning)
+      Severity = 2;
+    else if (D.Kind == SourceMgr::DK_Note)
+      Severity = 3;
+
+    auto Pos = [](unsigned Line, unsigned Column) {
+      return json::Object{{"line", Line}, {"character", Column}};
+    };
+    Diags.push_back(json::Object{
+        {"range", json::Object{{"start", Pos(D.Line, D.Column)},
+                               {"end", Pos(D.Line, D.Column + D.Length)}}},
+        {"severity", Severity},
+        {"source", "dusk"},
+        {"message", D.Message}});
+  }
+  notify("textDocument/publishDiagnostics",
+         json::Object{{"uri", URI}, {"diagnostics", std::move(Diags)}});
+}
+
+void LanguageServer::reply(const json::Value &ID, json::Value Result) {
+  send(json::Object{{"id", ID}, {"result", std::move(Result)}});
+}
+
+void LanguageServer::replyError(const json::Value &ID, int64_t Code,
+                                StringRef Message) {
+  send(json::Object{
+      {"id", ID},
+      {"error", json::Object{{"code", Code}, {"message", Message}}}});
+}
+
+void LanguageServer::notify(StringRef Method, json::Value Params) {
+  send(json::Object{{"method", Method}, {"params", std::move(Params)}});
+}
+
+void LanguageServer::send(json::Value Msg) {
+  Msg.getAsObject()->try_emplace("jsonrpc", "2.0");
+  std::string Content;
+  raw_string_ostream(Content) << Msg;
+  OS << "Content-Length: " << Content.size() << "\r\n\r\n" << Content;
+  OS.flush();
+}
+
+// MARK: - Serving a client
+
+/// Reads a single message framed by the base protocol from the standard input.
+///
+/// \return \c false at the end of the input.
+static bool readMessage(std::string &Content) {
+  size_t Length = 0;
+  std::string Line;
+  while (std::getline(std::cin, Line)) {
+    StringRef Header = StringRef(Line).rtrim("\r");
+    if (Header.empty()) {
+      if (Length == 0)
+        continue;
+      Content.resize(Length);
+      return bool(std::cin.read(&Content[0], Length));
+    }
+    if (Header.consume_front("Content-Length:"))
+      Header.trim().getAsInteger(10, Length);
+  }
+  return false;
+}
+
+static int serve(LanguageServer &Server) {
+  std::ios::sync_with_stdio(false);
+  std::string Content;
+  while (readMessage(Content)) {
+    auto Msg = json::parse(Content);
+    if (!Msg) {
+      errs() << "dusk-lsp: error: " << toString(Msg.takeError()) << "\n";
+      continue;
+    }
+    if (!Server.handle(*Msg))
+      return Server.getExitCode();
+  }
+  // The client disappeared without asking the server to exit.
+  return 1;
+}
+
+// MARK: - Latency benchmark
+
+static int replay(StringRef Path) {
+  auto Buffer = MemoryBuffer::getFile(Path);
+  if (!Buffer) {
+    errs() << "dusk-lsp: error: cannot open '" << Path
+           << "': " << Buffer.getError().message() << "\n";
+    return 1;
+  }
+
+  // Diagnostics are formatted, but not sent anywhere.
+  LanguageServer Server(nulls());
+  using Clock = std::chrono::steady_clock;
+  std::vector<double> Latencies;
+  double OpenTime = 0;
+  unsigned NumOpens = 0;
+
+  SmallVector<StringRef, 0> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', -1, /*KeepEmpty=*/false);
+  for (auto Line : Lines) {
+    auto Msg = json::parse(Line);
+    if (!Msg) {
+      errs() << "dusk-lsp: error: " << toString(Msg.takeError()) << "\n";
+      return 1;
+    }
+    auto Obj = Msg->getAsObject();
+    auto Method = Obj ? Obj->getString("method") : None;
+
+    auto Start = Clock::now();
+    Server.handle(*Msg);
+    std::chrono::duration<double, std::milli> Elapsed = Clock::now() - Start;
+
+    if (Method && *Method == "textDocument/didChange")
+      Latencies.push_back(Elapsed.count());
+    else if (Method && *Method == "textDocument/didOpen") {
+      OpenTime += Elapsed.count();
+      NumOpens++;
+    }
+  }
+
+  auto &OS = outs();
+  OS << "documents opened: " << NumOpens << " ("
+     << format("%.2f", OpenTime) << " ms)\n";
+  OS << "changes replayed: " << Latencies.size() << " ("
+     << Server.NumIncremental << " incremental, "
+     << Server.NumRebuilds - NumOpens << " rebuilds)\n";
+  if (Latencies.empty())
+    return 0;
+
+  std::sort(Latencies.begin(), Latencies.end());
+  double Sum = 0;
+  for (auto L : Latencies)
+    Sum += L;
+  auto percentile = [&](double P) {
+    return Latencies[size_t(P * (Latencies.size() - 1))];
+  };
+  OS << format("latency (ms): mean %.3f, p50 %.3f, p90 %.3f, p99 %.3f, "
+               "max %.3f\n",
+               Sum / Latencies.size(), percentile(0.5), percentile(0.9),
+               percentile(0.99), Latencies.back());
+  return 0;
+}
+
+int main(int argc, const char *argv[]) {
+  cl::ParseCommandLineOptions(argc, argv, "Dusk language server\n");
+
+  if (!ReplayFile.empty())
+    return replay(ReplayFile);
+
+  LanguageServer Server(outs());
+  if (!RecordFile.empty() && !Server.startRecording(RecordFile))
+    return 1;
+  return serve(Server);
+}
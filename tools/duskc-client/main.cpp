@@ -0,0 +1,97 @@
+//===--- main.cpp - Client of the Dusk compile server -----------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+//
+// Forwards its command line, working directory and standard streams to
+// a running `duskc --server` and exits with the status of the compilation.
+// If no server is running, `duskc` is executed instead.
+//
+// The client is started for every compilation, therefore it deliberately
+// links neither LLVM nor the dusk library.
+//
+//===----------------------------------------------------------------------===//
+
+#include "ServerProtocol.h"
+
+#include <climits>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace dusk::server;
+
+/// Connects to the server listening on \c Path, returns the socket or \c -1.
+static int connectToServer(const std::string &Path) {
+  sockaddr_un Addr;
+  if (!makeSocketAddress(Path, Addr))
+    return -1;
+  int Sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (Sock < 0)
+    return -1;
+  if (connect(Sock, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) != 0) {
+    close(Sock);
+    return -1;
+  }
+  return Sock;
+}
+
+/// Replaces the client with \c duskc next to it, or with one found in
+/// \c PATH. Returns only on failure.
+static int execCompiler(char *argv[]) {
+  char Self[PATH_MAX];
+  auto Size = readlink("/proc/self/exe", Self, sizeof(Self) - 1);
+  if (Size > 0) {
+    std::string Path(Self, Size);
+    Path = Path.substr(0, Path.rfind('/') + 1) + "duskc";
+    execv(Path.c_str(), argv);
+  }
+  execvp("duskc", argv);
+  std::perror("duskc-client: error: cannot execute duskc");
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<char *> Args(argv, argv + argc);
+  char Compiler[] = "duskc";
+  Args[0] = Compiler;
+  Args.push_back(nullptr);
+
+  int Sock = connectToServer(getDefaultSocketPath());
+  if (Sock < 0)
+    return execCompiler(Args.data());
+
+  // Working directory followed by the arguments, each terminated by '\0'.
+  char Cwd[PATH_MAX];
+  if (!getcwd(Cwd, sizeof(Cwd))) {
+    std::perror("duskc-client: error: cannot get working directory");
+    return 1;
+  }
+  std::string Payload(Cwd);
+  Payload += '\0';
+  for (int i = 0; i < argc; i++) {
+    Payload += argv[i];
+    Payload += '\0';
+  }
+  if (Payload.size() > MaxRequestSize) {
+    close(Sock);
+    return execCompiler(Args.data());
+  }
+
+  RequestHeader H{RequestMagic, ProtocolVersion, uint32_t(Payload.size())};
+  const int FDs[NumForwardedFDs] = {STDIN_FILENO, STDOUT_FILENO,
+                                    STDERR_FILENO};
+  int32_t Status;
+  if (!sendHeader(Sock, H, FDs) ||
+      !writeAll(Sock, Payload.data(), Payload.size()) ||
+      !readAll(Sock, &Status, sizeof(Status))) {
+    std::fprintf(stderr, "duskc-client: error: lost connection to the "
+                         "compile server\n");
+    return 1;
+  }
+  return Status;
+}
@@ -0,0 +1,275 @@
+//===--- Server.cpp - Persistent compile server ---------------------------===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#include "Server.h"
+#include "ServerProtocol.h"
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdio>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <string>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+
+using namespace dusk;
+using namespace dusk::server;
+
+/// Seconds, for which a connected client may delay its request.
+static const int RequestTimeout = 5;
+
+/// Signals are forwarded into the main loop through a pipe.
+static int SignalPipe[2] = {-1, -1};
+
+static void handleSignal(int Sig) {
+  auto SavedErrno = errno;
+  char C = static_cast<char>(Sig);
+  (void)write(SignalPipe[1], &C, 1);
+  errno = SavedErrno;
+}
+
+static void setSignalHandler(int Sig, void (*Handler)(int)) {
+  struct sigaction Action;
+  std::memset(&Action, 0, sizeof(Action));
+  Action.sa_handler = Handler;
+  Action.sa_flags = SA_RESTART;
+  sigemptyset(&Action.sa_mask);
+  sigaction(Sig, &Action, nullptr);
+}
+
+/// Returns \c true if a server already accepts connections at \c Addr.
+static bool isServerRunning(const sockaddr_un &Addr) {
+  int Sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (Sock < 0)
+    return false;
+  auto IsRunning =
+      connect(Sock, reinterpret_cast<const sockaddr *>(&Addr), sizeof(Addr)) ==
+      0;
+  close(Sock);
+  return IsRunning;
+}
+
+/// Sends exit status \c Status to the client and closes the connection.
+static void finishRequest(int Client, int32_t Status) {
+  writeAll(Client, &Status, sizeof(Status));
+  close(Client);
+}
+
+namespace {
+
+/// State of the server shared by the request handling.
+class Server {
+  int Listen;
+  DriverFn Driver;
+
+  /// Connections of clients, whose request is being compiled, by the pid of
+  /// the compiling process.
+  llvm::DenseMap<pid_t, int> Clients;
+
+public:
+  Server(int Listen, DriverFn Driver)
+      : Listen(Listen), Driver(std::move(Driver)) {}
+
+  /// Accepts a single connection and starts compilation of its request.
+  void acceptRequest();
+
+  /// Reports exit status of all finished compilations to their clients.
+  /// Blocks until all compilations finish, if \c Wait is \c true.
+  void reapChildren(bool Wait);
+
+private:
+  /// \brief Reads the request of \c Client and compiles it in a forked
+  /// process, never returns.
+  ///
+  /// A malformed request shuts the connection down, the client then reports
+  /// a lost connection.
+  [[noreturn]] void handleRequest(int Client);
+
+  /// Compiles a request with standard streams \c FDs, never returns.
+  [[noreturn]] void compile(int (&FDs)[NumForwardedFDs],
+                            const std::string &Payload);
+};
+
+} // anonymous namespace
+
+void Server::acceptRequest() {
+  int Client = accept4(Listen, nullptr, nullptr, SOCK_CLOEXEC);
+  if (Client < 0)
+    return;
+
+  // The request is read by the forked process, a slow or stalled client
+  // never delays requests of others. Buffered output must not be written
+  // by both processes.
+  llvm::outs().flush();
+  llvm::errs().flush();
+  std::fflush(nullptr);
+  auto Pid = fork();
+  if (Pid == 0)
+    handleRequest(Client);
+
+  if (Pid < 0)
+    finishRequest(Client, 1);
+  else
+    Clients[Pid] = Client;
+}
+
+void Server::handleRequest(int Client) {
+  close(Listen);
+  close(SignalPipe[0]);
+  close(SignalPipe[1]);
+  for (auto Sig : {SIGCHLD, SIGINT, SIGTERM, SIGPIPE})
+    setSignalHandler(Sig, SIG_DFL);
+
+  // A client, which never sends its request, must not keep the process
+  // around forever.
+  timeval Timeout{RequestTimeout, 0};
+  setsockopt(Client, SOL_SOCKET, SO_RCVTIMEO, &Timeout, sizeof(Timeout));
+
+  // Size of the payload is bounded before anything is allocated for it.
+  RequestHeader H;
+  int FDs[NumForwardedFDs];
+  if (!receiveHeader(Client, H, FDs) || H.Size > MaxRequestSize) {
+    shutdown(Client, SHUT_RDWR);
+    _exit(1);
+  }
+  std::string Payload(H.Size, '\0');
+  if (!readAll(Client, &Payload[0], H.Size)) {
+    shutdown(Client, SHUT_RDWR);
+    _exit(1);
+  }
+
+  // Exit status is reported to the client by the server.
+  close(Client);
+  compile(FDs, Payload);
+}
+
+void Server::compile(int (&FDs)[NumForwardedFDs], const std::string &Payload) {
+  for (unsigned i = 0; i < NumForwardedFDs; i++)
+    dup2(FDs[i], i);
+  for (auto FD : FDs)
+    if (FD >= int(NumForwardedFDs))
+      close(FD);
+
+  // Payload is the working directory followed by the arguments.
+  llvm::SmallVector<const char *, 32> Args;
+  for (size_t i = 0; i < Payload.size(); i += std::strlen(&Payload[i]) + 1)
+    Args.push_back(&Payload[i]);
+  if (Args.size() < 2 || chdir(Args[0]) != 0) {
+    llvm::errs() << "duskc: error: malformed request of the client\n";
+    _exit(1);
+  }
+
+  // Diagnostics name the compiler rather than the client.
+  Args[1] = "duskc";
+  auto Code = Driver(Args.size() - 1, Args.data() + 1);
+  llvm::outs().flush();
+  llvm::errs().flush();
+  std::fflush(nullptr);
+  // Destructors of the server state inherited by the process must not run.
+  _exit(Code);
+}
+
+void Server::reapChildren(bool Wait) {
+  int Status;
+  pid_t Pid;
+  while (!Clients.empty() &&
+         (Pid = waitpid(-1, &Status, Wait ? 0 : WNOHANG)) != 0) {
+    if (Pid < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+    auto It = Clients.find(Pid);
+    if (It == Clients.end())
+      continue;
+
+    int32_t Code = 1;
+    if (WIFEXITED(Status))
+      Code = WEXITSTATUS(Status);
+    else if (WIFSIGNALED(Status))
+      Code = 128 + WTERMSIG(Status);
+    finishRequest(It->second, Code);
+    Clients.erase(It);
+  }
+}
+
+int dusk::runServer(StringRef SocketPath, std::function<void()> WarmUp,
+                    DriverFn Driver) {
+  auto &OS = llvm::errs();
+  sockaddr_un Addr;
+  if (!makeSocketAddress(SocketPath.str(), Addr)) {
+    OS << "duskc: error: socket path '" << SocketPath << "' is too long\n";
+    return 1;
+  }
+  if (isServerRunning(Addr)) {
+    OS << "duskc: error: a server is already listening on '" << SocketPath
+       << "'\n";
+    return 1;
+  }
+
+  // Requests are accepted only once everything is initialized, until then
+  // clients compile on their own.
+  WarmUp();
+
+  int Listen = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (Listen < 0 || pipe2(SignalPipe, O_CLOEXEC | O_NONBLOCK) != 0) {
+    OS << "duskc: error: " << std::strerror(errno) << "\n";
+    return 1;
+  }
+
+  // Socket of a server, which did not exit cleanly, is replaced. The socket
+  // is accessible only to the user, since clients pass it their files.
+  unlink(Addr.sun_path);
+  auto Mask = umask(0077);
+  auto IsBound =
+      bind(Listen, reinterpret_cast<sockaddr *>(&Addr), sizeof(Addr)) == 0;
+  umask(Mask);
+  if (!IsBound || listen(Listen, SOMAXCONN) != 0) {
+    OS << "duskc: error: cannot listen on '" << SocketPath
+       << "': " << std::strerror(errno) << "\n";
+    return 1;
+  }
+
+  for (auto Sig : {SIGCHLD, SIGINT, SIGTERM})
+    setSignalHandler(Sig, handleSignal);
+  // Clients may disappear before they receive their exit status.
+  setSignalHandler(SIGPIPE, SIG_IGN);
+
+  OS << "duskc: server listening on '" << SocketPath << "'\n";
+  Server S(Listen, std::move(Driver));
+  bool IsRunning = true;
+  while (IsRunning) {
+    pollfd FDs[] = {{Listen, POLLIN, 0}, {SignalPipe[0], POLLIN, 0}};
+    if (poll(FDs, 2, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      break;
+    }
+
+    if (FDs[1].revents & POLLIN) {
+      char Sig;
+      while (read(SignalPipe[0], &Sig, 1) == 1)
+        if (Sig != SIGCHLD)
+          IsRunning = false;
+      S.reapChildren(/*Wait=*/false);
+    }
+    if (IsRunning && (FDs[0].revents & POLLIN))
+      S.acceptRequest();
+  }
+
+  close(Listen);
+  unlink(Addr.sun_path);
+  // Compilations in progress are finished and reported to their clients.
+  S.reapChildren(/*Wait=*/true);
+  return 0;
+}
@@ -0,0 +1,38 @@
+//===--- Server.h - Persistent compile server -------------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_SERVER_H
+#define DUSK_SERVER_H
+
+#include "dusk/Basic/LLVM.h"
+#include "llvm/ADT/StringRef.h"
+#include <functional>
+
+namespace dusk {
+
+/// Runs the compiler driver with given command line, returns its exit code.
+using DriverFn = std::function<int(int Argc, const char **Argv)>;
+
+/// \brief Serves compilations requested by \c duskc-client on a Unix socket
+/// \c SocketPath until terminated by \c SIGINT or \c SIGTERM.
+///
+/// \c WarmUp is invoked once before the server starts accepting requests.
+/// Each request is then compiled by \c Driver in a process forked from
+/// the server, which inherits all of the state initialized by the warm-up,
+/// i.e. registered targets, target machines and initialized passes, while
+/// command line options and the AST of the request stay isolated. Standard
+/// input and outputs of the process are those of the client.
+///
+/// \return Exit code of the server.
+int runServer(StringRef SocketPath, std::function<void()> WarmUp,
+              DriverFn Driver);
+
+} // namespace dusk
+
+#endif /* DUSK_SERVER_H */
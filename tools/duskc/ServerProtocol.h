@@ -0,0 +1,181 @@
+//===--- ServerProtocol.h - Compile server protocol -------------*- C++ -*-===//
+//
+//                                 dusk-lang
+// This source file is part of a dusk-lang project, which is a semestral
+// assignement for BI-PJP course at Czech Technical University in Prague.
+// The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+//
+//===----------------------------------------------------------------------===//
+//
+// Protocol between `duskc --server` and `duskc-client`. The client must not
+// load LLVM, therefore this header depends only on the C++ and POSIX
+// libraries.
+//
+// A request consists of a RequestHeader carrying standard input, output and
+// error of the client as SCM_RIGHTS, followed by RequestHeader::Size bytes of
+// a working directory and command line arguments, each terminated by '\0'.
+// The server responds with a single int32_t exit status of the compilation.
+//
+//===----------------------------------------------------------------------===//
+
+#ifndef DUSK_SERVER_PROTOCOL_H
+#define DUSK_SERVER_PROTOCOL_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace dusk {
+namespace server {
+
+const uint32_t RequestMagic = 0x6b737564; // 'dusk'
+const uint32_t ProtocolVersion = 1;
+
+/// Number of file descriptors passed with a request.
+const unsigned NumForwardedFDs = 3;
+
+/// Upper bound of size of a request, protects the server from bogus clients.
+const uint32_t MaxRequestSize = 1 << 20;
+
+struct RequestHeader {
+  uint32_t Magic;
+  uint32_t Version;
+  uint32_t Size;
+};
+
+/// \brief Returns path of the socket of the server.
+///
+/// The socket is created in \c $XDG_RUNTIME_DIR, or in \c /tmp if it is not
+/// set, and is private to the user. \c $DUSKC_SERVER_SOCKET overrides it.
+inline std::string getDefaultSocketPath() {
+  if (auto Path = std::getenv("DUSKC_SERVER_SOCKET"))
+    return Path;
+  std::string Dir = "/tmp";
+  if (auto RuntimeDir = std::getenv("XDG_RUNTIME_DIR"))
+    Dir = RuntimeDir;
+  return Dir + "/duskc-" + std::to_string(getuid()) + ".sock";
+}
+
+/// Fills \c Addr with \c Path, returns \c false if the path is too long.
+inline bool makeSocketAddress(const std::string &Path, sockaddr_un &Addr) {
+  std::memset(&Addr, 0, sizeof(Addr));
+  Addr.sun_family = AF_UNIX;
+  if (Path.size() >= sizeof(Addr.sun_path))
+    return false;
+  std::memcpy(Addr.sun_path, Path.c_str(), Path.size() + 1);
+  return true;
+}
+
+/// Writes exactly \c Size bytes, returns \c false on error.
+inline bool writeAll(int FD, const void *Data, size_t Size) {
+  auto P = static_cast<const char *>(Data);
+  while (Size > 0) {
+    auto N = write(FD, P, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    P += N;
+    Size -= N;
+  }
+  return true;
+}
+
+/// Reads exactly \c Size bytes, returns \c false on error or end of file.
+inline bool readAll(int FD, void *Data, size_t Size) {
+  auto P = static_cast<char *>(Data);
+  while (Size > 0) {
+    auto N = read(FD, P, Size);
+    if (N < 0 && errno == EINTR)
+      continue;
+    if (N <= 0)
+      return false;
+    P += N;
+    Size -= N;
+  }
+  return true;
+}
+
+/// Sends header \c H together with descriptors \c FDs over socket \c Sock.
+inline bool sendHeader(int Sock, const RequestHeader &H,
+                       const int (&FDs)[NumForwardedFDs]) {
+  iovec IO;
+  IO.iov_base = const_cast<RequestHeader *>(&H);
+  IO.iov_len = sizeof(H);
+
+  alignas(cmsghdr) char Control[CMSG_SPACE(sizeof(FDs))];
+  std::memset(Control, 0, sizeof(Control));
+  msghdr Msg;
+  std::memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IO;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control;
+  Msg.msg_controllen = sizeof(Control);
+
+  auto C = CMSG_FIRSTHDR(&Msg);
+  C->cmsg_level = SOL_SOCKET;
+  C->cmsg_type = SCM_RIGHTS;
+  C->cmsg_len = CMSG_LEN(sizeof(FDs));
+  std::memcpy(CMSG_DATA(C), FDs, sizeof(FDs));
+
+  ssize_t N;
+  do
+    N = sendmsg(Sock, &Msg, 0);
+  while (N < 0 && errno == EINTR);
+  return N == sizeof(H);
+}
+
+/// \brief Receives a header into \c H together with descriptors into \c FDs.
+///
+/// \return \c false if the message is not a request header with all of
+///   the descriptors. Descriptors received with a malformed request are
+///   closed. Size of the request is left to be checked by the caller.
+inline bool receiveHeader(int Sock, RequestHeader &H,
+                          int (&FDs)[NumForwardedFDs]) {
+  iovec IO;
+  IO.iov_base = &H;
+  IO.iov_len = sizeof(H);
+
+  alignas(cmsghdr) char Control[CMSG_SPACE(sizeof(FDs))];
+  msghdr Msg;
+  std::memset(&Msg, 0, sizeof(Msg));
+  Msg.msg_iov = &IO;
+  Msg.msg_iovlen = 1;
+  Msg.msg_control = Control;
+  Msg.msg_controllen = sizeof(Control);
+
+  ssize_t N;
+  do
+    N = recvmsg(Sock, &Msg, MSG_WAITALL);
+  while (N < 0 && errno == EINTR);
+  if (N < 0)
+    return false;
+
+  unsigned NumFDs = 0;
+  for (auto C = CMSG_FIRSTHDR(&Msg); C; C = CMSG_NXTHDR(&Msg, C)) {
+    if (C->cmsg_level != SOL_SOCKET || C->cmsg_type != SCM_RIGHTS)
+      continue;
+    NumFDs = (C->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    std::memcpy(FDs, CMSG_DATA(C),
+                std::min<size_t>(NumFDs, NumForwardedFDs) * sizeof(int));
+  }
+
+  if (N == sizeof(H) && NumFDs == NumForwardedFDs &&
+      H.Magic == RequestMagic && H.Version == ProtocolVersion)
+    return true;
+  for (unsigned i = 0; i < std::min(NumFDs, NumForwardedFDs); i++)
+    close(FDs[i]);
+  return false;
+}
+
+} // namespace server
+} // namespace dusk
+
+#endif /* DUSK_SERVER_PROTOCOL_H */
@@ -0,0 +1,61 @@
+#!/usr/bin/env bash
+#===--- bench-batch.sh - Compare batch mode with a process per file ------===#
+#
+#                                 dusk-lang
+# This source file is part of a dusk-lang project, which is a semestral
+# assignement for BI-PJP course at Czech Technical University in Prague.
+# The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+#
+#===----------------------------------------------------------------------===#
+#
+# Compiles a number of copies of the programs in examples/ into object files
+# by a single duskc process in batch mode and by one duskc process per file,
+# and prints the throughput of both in files per second.
+#
+#   tools/duskc/bench-batch.sh [path/to/duskc] [copies]
+#
+#===----------------------------------------------------------------------===#
+
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+DUSKC="${1:-$ROOT/bin/duskc}"
+COPIES="${2:-50}"
+CORES="$(getconf _NPROCESSORS_ONLN)"
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+for ((i = 0; i < COPIES; i++)); do
+  for SRC in "$ROOT"/examples/*.dusk; do
+    cp "$SRC" "$WORK/$(basename "$SRC" .dusk)$i.dusk"
+  done
+done
+FILES=("$WORK"/*.dusk)
+
+now() { date +%s%N; }
+
+# Prints throughput in files per second of running "$@".
+throughput() {
+  local Start End
+  Start=$(now)
+  "$@" > /dev/null
+  End=$(now)
+  awk -v T=$((End - Start)) -v N="${#FILES[@]}" \
+    'BEGIN { printf "%.1f", N / (T / 1e9) }'
+}
+
+# Compiles every file by its own duskc process, running up to $1 processes
+# at once.
+perFile() {
+  printf '%s\0' "${FILES[@]}" | xargs -0 -n 1 -P "$1" "$DUSKC" -c
+}
+
+echo "${#FILES[@]} files, $CORES cores"
+printf '%-28s %12s\n' mode "files/s"
+printf '%-28s %12s\n' "process per file, serial" "$(throughput perFile 1)"
+printf '%-28s %12s\n' "process per file, $CORES at once" \
+  "$(throughput perFile "$CORES")"
+printf '%-28s %12s\n' "batch, -j 1" \
+  "$(throughput "$DUSKC" -c -j 1 "${FILES[@]}")"
+printf '%-28s %12s\n' "batch, -j $CORES" \
+  "$(throughput "$DUSKC" -c -j "$CORES" "${FILES[@]}")"
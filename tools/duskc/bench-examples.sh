@@ -0,0 +1,89 @@
+#!/usr/bin/env bash
+#===--- bench-examples.sh - Compare execution modes of duskc -------------===#
+#
+#                                 dusk-lang
+# This source file is part of a dusk-lang project, which is a semestral
+# assignement for BI-PJP course at Czech Technical University in Prague.
+# The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+#
+#===----------------------------------------------------------------------===#
+#
+# Measures wall time of every program in examples/ executed by the bytecode
+# interpreter (--interpret), by the JIT (--run) and compiled ahead of time,
+# both including and excluding the compilation. Executables compiled with
+# -O0 to -O3 are measured separately. Times are averages in milliseconds
+# over a number of runs.
+#
+#   tools/duskc/bench-examples.sh [path/to/duskc] [runs]
+#
+#===----------------------------------------------------------------------===#
+
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+DUSKC="${1:-$ROOT/bin/duskc}"
+RUNS="${2:-10}"
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+# Standard input of programs reading numbers.
+input() {
+  case "$1" in
+    arrayTest)  printf '3\n4\n1\n2\n' ;;
+    factIter)   printf '20\n' ;;
+    factRec)    printf '20\n' ;;
+    factor)     printf '123456789\n' ;;
+    fibonacci)  printf '27\n' ;;
+    inOut)      printf '42\n' ;;
+    interpRec)  printf '10000\n' ;;
+    isPrime)    printf '2000\n' ;;
+    *)          ;;
+  esac
+}
+
+now() { date +%s%N; }
+
+# Prints average time of running "$@" with input of example $NAME.
+measure() {
+  local Start End
+  Start=$(now)
+  for ((i = 0; i < RUNS; i++)); do
+    input "$NAME" | "$@" > /dev/null || true
+  done
+  End=$(now)
+  awk -v T=$((End - Start)) -v N="$RUNS" 'BEGIN { printf "%.1f", T / N / 1e6 }'
+}
+
+printf '%-12s %12s %12s %14s %10s %10s %10s %10s\n' example interpret run \
+  "compile+exec" "exec -O0" "exec -O1" "exec -O2" "exec -O3"
+for SRC in "$ROOT"/examples/*.dusk; do
+  NAME="$(basename "$SRC" .dusk)"
+  EXE="$WORK/$NAME"
+
+  Interpret=$(measure "$DUSKC" --interpret "$SRC")
+  Run=$(measure "$DUSKC" --run "$SRC")
+  AOT=$(measure bash -c "\"$DUSKC\" \"$SRC\" -o \"$EXE\" && \"$EXE\"")
+  Exec=()
+  for Opt in -O0 -O1 -O2 -O3; do
+    "$DUSKC" "$SRC" "$Opt" -o "$EXE$Opt"
+    Exec+=("$(measure "$EXE$Opt")")
+  done
+
+  # Modes must agree on the output, programs may exit with any status.
+  Expected="$(input "$NAME" | "$EXE" || true)"
+  for Mode in --interpret --run; do
+    if [ "$(input "$NAME" | "$DUSKC" $Mode "$SRC" || true)" != "$Expected" ]; then
+      echo "$NAME: output of duskc $Mode differs" >&2
+      exit 1
+    fi
+  done
+  for Opt in -O1 -O2 -O3; do
+    if [ "$(input "$NAME" | "$EXE$Opt" || true)" != "$Expected" ]; then
+      echo "$NAME: output of executable compiled with $Opt differs" >&2
+      exit 1
+    fi
+  done
+
+  printf '%-12s %12s %12s %14s %10s %10s %10s %10s\n' "$NAME" "$Interpret" \
+    "$Run" "$AOT" "${Exec[@]}"
+done
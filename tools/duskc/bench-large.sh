@@ -0,0 +1,88 @@
+#!/usr/bin/env bash
+#===--- bench-large.sh - Measure compilation of a large program ----------===#
+#
+#                                 dusk-lang
+# This source file is part of a dusk-lang project, which is a semestral
+# assignement for BI-PJP course at Czech Technical University in Prague.
+# The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+#
+#===----------------------------------------------------------------------===#
+#
+# Compiles a program generated by gen-program.sh into an object file with
+# different options of duskc and prints average wall time in milliseconds
+# over a number of runs. Code generation is measured with 1 to 32 jobs, as
+# long as the machine has enough cores. Peak memory of the whole module and
+# of streaming compilation is measured by GNU time. Phased and pipelined
+# compilation are compared by total time and by time to the first emitted
+# object, which is taken from the -ftime-trace output.
+#
+#   tools/duskc/bench-large.sh [path/to/duskc] [functions] [runs]
+#
+#===----------------------------------------------------------------------===#
+
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+DUSKC="${1:-$ROOT/bin/duskc}"
+FUNCS="${2:-20000}"
+RUNS="${3:-3}"
+CORES="$(getconf _NPROCESSORS_ONLN)"
+WORK="$(mktemp -d)"
+trap 'rm -rf "$WORK"' EXIT
+
+SRC="$WORK/large.dusk"
+"$ROOT/tools/duskc/gen-program.sh" "$FUNCS" > "$SRC"
+
+now() { date +%s%N; }
+
+# Prints average time of compiling the program with options "$@".
+measure() {
+  local Start End
+  Start=$(now)
+  for ((i = 0; i < RUNS; i++)); do
+    "$DUSKC" -c "$SRC" "$@" > /dev/null
+  done
+  End=$(now)
+  awk -v T=$((End - Start)) -v N="$RUNS" 'BEGIN { printf "%.1f", T / N / 1e6 }'
+}
+
+echo "$(wc -l < "$SRC") lines, $FUNCS functions, $CORES cores"
+printf '%-32s %12s\n' options time
+for Opt in -O0 -O2; do
+  for Jobs in 1 2 4 8 16 32; do
+    [ "$Jobs" -le "$CORES" ] || break
+    printf '%-32s %12s\n' "$Opt -codegen-jobs $Jobs" \
+      "$(measure "$Opt" -codegen-jobs "$Jobs")"
+  done
+done
+
+# Prints peak resident set size in megabytes of compiling the program with
+# options "$@".
+peak() {
+  /usr/bin/time -f %M "$DUSKC" -c "$SRC" "$@" 2>&1 > /dev/null |
+    awk 'END { printf "%.1f", $1 / 1024 }'
+}
+
+printf '\n%-32s %12s %14s\n' options time "peak RSS (MB)"
+for Opt in -O0 "-O0 -streaming"; do
+  printf '%-32s %12s %14s\n' "$Opt" "$(measure $Opt)" "$(peak $Opt)"
+done
+
+# Prints time in milliseconds from the start of compiling the program with
+# options "$@" to the end of the first object emission.
+first_object() {
+  "$DUSKC" -c "$SRC" "$@" -ftime-trace -ftime-trace-file "$WORK/trace.json" \
+    -ftime-trace-granularity 0 > /dev/null
+  python3 -c '
+import json, sys
+Events = json.load(open(sys.argv[1]))["traceEvents"]
+print("%.1f" % (min(E["ts"] + E["dur"] for E in Events
+                    if E.get("name") == "EmitObject") / 1000))' \
+    "$WORK/trace.json"
+}
+
+Jobs=$((CORES < 4 ? CORES : 4))
+printf '\n%-32s %12s %14s\n' options time "first object"
+for Opt in "-O0 -codegen-jobs $Jobs" "-O0 -codegen-jobs $Jobs -pipeline"; do
+  printf '%-32s %12s %14s\n' "$Opt" "$(measure $Opt)" "$(first_object $Opt)"
+done
@@ -0,0 +1,55 @@
+#!/usr/bin/env bash
+#===--- bench-server.sh - Compare duskc with the compile server ----------===#
+#
+#                                 dusk-lang
+# This source file is part of a dusk-lang project, which is a semestral
+# assignement for BI-PJP course at Czech Technical University in Prague.
+# The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+#
+#===----------------------------------------------------------------------===#
+#
+# Starts a compile server on a private socket and measures latency of
+# compiling every program in examples/ into an object file by duskc and by
+# duskc-client. Times are averages in milliseconds over a number of runs.
+#
+#   tools/duskc/bench-server.sh [path/to/bin] [runs]
+#
+#===----------------------------------------------------------------------===#
+
+set -euo pipefail
+
+ROOT="$(cd "$(dirname "${BASH_SOURCE[0]}")/../.." && pwd)"
+BIN="${1:-$ROOT/bin}"
+RUNS="${2:-20}"
+WORK="$(mktemp -d)"
+export DUSKC_SERVER_SOCKET="$WORK/duskc.sock"
+
+"$BIN/duskc" --server 2> "$WORK/server.log" &
+SERVER=$!
+trap 'kill $SERVER; wait $SERVER; rm -rf "$WORK"' EXIT
+# Clients compile on their own until the server is warmed up.
+until grep -q listening "$WORK/server.log"; do
+  sleep 0.1
+done
+
+now() { date +%s%N; }
+
+# Prints average time of running "$@".
+measure() {
+  local Start End
+  Start=$(now)
+  for ((i = 0; i < RUNS; i++)); do
+    "$@" > /dev/null
+  done
+  End=$(now)
+  awk -v T=$((End - Start)) -v N="$RUNS" 'BEGIN { printf "%.1f", T / N / 1e6 }'
+}
+
+printf '%-12s %10s %10s\n' example duskc server
+for SRC in "$ROOT"/examples/*.dusk; do
+  NAME="$(basename "$SRC" .dusk)"
+  cp "$SRC" "$WORK"
+  Direct=$(measure "$BIN/duskc" -c "$WORK/$NAME.dusk")
+  Server=$(measure "$BIN/duskc-client" -c "$WORK/$NAME.dusk")
+  printf '%-12s %10s %10s\n' "$NAME" "$Direct" "$Server"
+done
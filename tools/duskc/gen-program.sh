@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+#===--- gen-program.sh - Generate a large dusk program -------------------===#
+#
+#                                 dusk-lang
+# This source file is part of a dusk-lang project, which is a semestral
+# assignement for BI-PJP course at Czech Technical University in Prague.
+# The software is provided "AS IS", WITHOUT WARRANTY OF ANY KIND.
+#
+#===----------------------------------------------------------------------===#
+#
+# Writes a valid dusk program of a given number of functions to the standard
+# output. Every function spans 18 lines with comments, locals, loops and
+# calls of the preceding function, therefore 56000 functions make a program
+# of about 1M lines.
+#
+#   tools/duskc/gen-program.sh [functions]
+#
+#===----------------------------------------------------------------------===#
+
+set -euo pipefail
+
+FUNCS="${1:-1000}"
+
+awk -v N="$FUNCS" 'BEGIN {
+  print "let scale = 3;"
+  print "var counter = 0;"
+  print ""
+  for (f = 0; f < N; f++) {
+    printf "// Accumulates a weighted sum over the range of function %d.\n", f
+    printf "func compute%d(alpha: Int, beta: Int) -> Int {\n", f
+    print  "    var total = alpha * scale;"
+    print  "    var index = 0;"
+    print  "    /* Sum of the weighted deltas. */"
+    print  "    while index < beta {"
+    print  "        let delta = index % 7 + alpha;"
+    print  "        total = total + delta * scale;"
+    print  "        index = index + 1;"
+    print  "    }"
+    print  "    if total > 1000 && beta != 0 {"
+    print  "        total = total - beta;"
+    print  "    }"
+    if (f > 0)
+      printf "    total = total + compute%d(alpha - 1, beta / 2);\n", f - 1
+    else
+      print  "    total = total + 1;"
+    print  "    counter = counter + 1;"
+    print  "    return total;"
+    print  "}"
+    print  ""
+  }
+  print "func main() {"
+  printf "    println(compute%d(1, 8));\n", N - 1
+  print "}"
+}'
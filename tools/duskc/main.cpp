@@ -8,12 +8,26 @@
 //===----------------------------------------------------------------------===//
 
 #include "dusk/Basic/LLVM.h"
+#include "dusk/Basic/TimeTrace.h"
+#include "dusk/Frontend/CompilationCache.h"
 #include "dusk/Frontend/CompilerInvocation.h"
 #include "dusk/Frontend/CompilerInstance.h"
+#include "dusk/Frontend/Linker.h"
+#include "dusk/Serialization/Serialization.h"
+#include "Server.h"
+#include "ServerProtocol.h"
+#include "llvm/ADT/ScopeExit.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include <atomic>
+#include <mutex>
 #include <string>
-#include <iostream>
 
 #include "dusk/AST/ASTContext.h"
 #include "dusk/AST/Type.h"
@@ -21,8 +35,8 @@
 using namespace dusk;
 using namespace llvm;
 
-cl::opt<std::string> InFile(cl::Positional, cl::Required,
-                            cl::desc("<input file>"), cl::init("-"));
+cl::list<std::string> InFiles(cl::Positional, cl::ZeroOrMore,
+                              cl::desc("<input files>"));
 
 cl::opt<std::string> OutFile("o", cl::desc("Specify output filename"),
                              cl::value_desc("<filename>"), cl::init("a.out"));
@@ -38,32 +52,433 @@ cl::opt<bool> OnlyCompile("c",
 cl::opt<bool> PrintIR("S",
                       cl::desc("Print outputed IR of compilation"));
 
-void initCompilerInstance(CompilerInstance &C) {
+cl::opt<bool> Run("run",
+                  cl::desc("Compile the program in memory and run it instead "
+                           "of creating an executable"));
+
+cl::opt<bool> Interpret("interpret",
+                        cl::desc("Interpret the program without compiling it, "
+                                 "which starts faster than -run"));
+
+cl::opt<LexingMode> LexMode(
+    "lex-mode", cl::desc("Choose how the input is lexed for the parser"),
+    cl::values(clEnumValN(LexingMode::OnDemand, "on-demand",
+                          "Lex tokens as the parser consumes them"),
+               clEnumValN(LexingMode::Buffered, "buffered",
+                          "Lex the whole input before parsing"),
+               clEnumValN(LexingMode::Threaded, "threaded",
+                          "Lex the input on a separate thread")),
+    cl::init(LexingMode::OnDemand));
+
+cl::opt<OptLevel> OptimizationLevel(
+    cl::desc("Choose optimization level"),
+    cl::values(clEnumValN(OptLevel::O0, "O0", "No optimizations (default)"),
+               clEnumValN(OptLevel::O1, "O1", "Enable basic optimizations"),
+               clEnumValN(OptLevel::O2, "O2", "Enable default optimizations"),
+               clEnumValN(OptLevel::O3, "O3", "Enable expensive optimizations"),
+               clEnumValN(OptLevel::Os, "Os", "Optimize for code size")),
+    cl::init(OptLevel::O0));
+
+cl::opt<std::string> MArch("march",
+                           cl::desc("Generate code for the given CPU, 'native' "
+                                    "selects the host CPU and its features"),
+                           cl::value_desc("<cpu-name>"));
+
+cl::opt<std::string> MCPU("mcpu",
+                          cl::desc("Target a specific CPU type, 'native' "
+                                   "selects the host CPU and its features"),
+                          cl::value_desc("<cpu-name>"));
+
+cl::list<std::string> MAttrs("mattr", cl::CommaSeparated,
+                             cl::desc("Enable (+) or disable (-) target "
+                                      "specific attributes"),
+                             cl::value_desc("<+a1,-a2,...>"));
+
+cl::list<std::string> ImportPaths("I", cl::Prefix,
+                                  cl::desc("Add directory to the search path "
+                                           "of imported modules"),
+                                  cl::value_desc("<directory>"));
+
+cl::opt<bool> EmitModule("emit-module",
+                         cl::desc("Write an interface of the module next to "
+                                  "the input file, which other programs can "
+                                  "import, requires -c"));
+
+cl::opt<std::string> CacheDir("cache-dir",
+                             cl::desc("Reuse object files of unchanged "
+                                      "programs cached in the directory"),
+                             cl::value_desc("<directory>"));
+
+cl::opt<unsigned> CacheSize("cache-size",
+                            cl::desc("Size limit of the cache in megabytes, "
+                                     "least recently used files are evicted "
+                                     "first (defaults to 512)"),
+                            cl::value_desc("<MB>"), cl::init(512));
+
+cl::opt<bool> Incremental("incremental",
+                          cl::desc("Cache each function separately and "
+                                   "recompile only changed functions, "
+                                   "requires -cache-dir"));
+
+cl::opt<bool> CacheStats("cache-stats",
+                         cl::desc("Print cache hits and misses on exit"));
+
+cl::opt<unsigned> Jobs("j",
+                       cl::desc("Number of input files compiled in parallel "
+                                "(defaults to the number of cores)"),
+                       cl::value_desc("<N>"), cl::init(0));
+
+cl::opt<unsigned> SemaJobs("sema-jobs",
+                           cl::desc("Number of threads type checking function "
+                                    "bodies of a single file"),
+                           cl::value_desc("<N>"), cl::init(1));
+
+cl::opt<unsigned> CodegenJobs("codegen-jobs",
+                              cl::desc("Number of threads generating code of "
+                                       "a single file"),
+                              cl::value_desc("<N>"), cl::init(1));
+
+cl::opt<bool> Pipeline("pipeline",
+                       cl::desc("Pass functions to IR and code generation as "
+                                "soon as they are type checked"));
+
+cl::opt<bool> Streaming("streaming",
+                        cl::desc("Parse, type check and emit one function "
+                                 "body at a time to bound memory use"));
+
+cl::opt<bool> TimeTrace("ftime-trace",
+                        cl::desc("Write a trace of time spent in phases of "
+                                 "the compiler in Chrome trace event format"));
+
+cl::opt<std::string> TimeTraceFile("ftime-trace-file",
+                                   cl::desc("Specify file the time trace is "
+                                            "written into (defaults to "
+                                            "<output>.json)"),
+                                   cl::value_desc("<filename>"));
+
+cl::opt<unsigned> TimeTraceGranularity("ftime-trace-granularity",
+                                       cl::desc("Minimum time of a phase "
+                                                "recorded in the time trace "
+                                                "in microseconds (defaults "
+                                                "to 500)"),
+                                       cl::value_desc("<us>"), cl::init(500));
+
+cl::opt<bool> TimeReport("ftime-report",
+                         cl::desc("Print total time spent in each phase of "
+                                  "the compiler"));
+
+cl::opt<bool> RunServer("server",
+                        cl::desc("Keep the compiler initialized and compile "
+                                 "programs requested by duskc-client"));
+
+cl::opt<std::string> ServerSocket("server-socket",
+                                  cl::desc("Unix socket the server listens "
+                                           "on (defaults to "
+                                           "$XDG_RUNTIME_DIR/duskc-<uid>.sock)"),
+                                  cl::value_desc("<path>"));
+
+/// Configures \c Compiler to compile \c InFile into \c Out according to
+/// the command line options. The object file is emitted into \c ObjFile,
+/// if provided.
+///
+/// \return \c true on success, \c false if the input file does not exist.
+static bool setupCompiler(CompilerInstance &Compiler, StringRef InFile,
+                          StringRef Out, raw_ostream &OS,
+                          StringRef ObjFile = StringRef()) {
   CompilerInvocation Inv;
-  Inv.setArgs(C.getSourceManager(), C.getDiags(), InFile, OutFile, IsQuiet,
-              PrintIR);
-  if (!Inv.getInputFile())
+  Inv.setArgs(Compiler.getSourceManager(), Compiler.getDiags(), InFile, Out,
+              IsQuiet, PrintIR);
+  Inv.setLexingMode(LexMode);
+  Inv.setSemaJobs(SemaJobs);
+  Inv.setCodegenJobs(CodegenJobs);
+  Inv.setPipelined(Pipeline);
+  Inv.setStreaming(Streaming);
+  Inv.setOptLevel(OptimizationLevel);
+  for (auto &A : MAttrs)
+    Inv.addTargetFeature(A);
+  if (!MArch.empty())
+    Inv.setTargetCPU(MArch);
+  if (!MCPU.empty())
+    Inv.setTargetCPU(MCPU);
+  if (!ObjFile.empty())
+    Inv.setObjectFile(ObjFile);
+  if (!CacheDir.empty())
+    Inv.setCache(CacheDir, uint64_t(CacheSize) * 1024 * 1024);
+  Inv.setIncremental(Incremental);
+  for (auto &P : ImportPaths)
+    Inv.addImportPath(P);
+  if (EmitModule) {
+    SmallString<128> Interface(InFile);
+    sys::path::replace_extension(Interface, ModuleInterfaceExtension);
+    Inv.setModuleInterfaceFile(Interface);
+  }
+  if (!Inv.getInputFile()) {
+    OS << "File '" << InFile << "' not found.\n";
+    return false;
+  }
+  Compiler.reset(std::move(Inv));
+  return true;
+}
+
+/// Compiles, and unless only compilation was requested, links a single
+/// program. Diagnostics are reported into \c OS.
+///
+/// \return \c true on success, \c false otherwise.
+static bool compile(StringRef InFile, StringRef Out, raw_ostream &OS) {
+  CompilerInstance Compiler(OS);
+  if (OnlyCompile) {
+    if (!setupCompiler(Compiler, InFile, Out, OS))
+      return false;
+    Compiler.performCompilation();
+    return !Compiler.getContext().isError();
+  }
+
+  // The object file is only an intermediate product of linking.
+  SmallString<128> ObjFile;
+  if (auto EC = sys::fs::createTemporaryFile("dusk", "o", ObjFile)) {
+    OS << "duskc: error: could not create object file: " << EC.message()
+       << "\n";
+    return false;
+  }
+  auto Cleanup = make_scope_exit([&] { sys::fs::remove(ObjFile); });
+  if (!setupCompiler(Compiler, InFile, Out, OS, ObjFile))
+    return false;
+  Compiler.performCompilation();
+  if (Compiler.getContext().isError())
+    return false;
+  auto ObjFiles = Compiler.getImportedObjectFiles();
+  ObjFiles.insert(ObjFiles.begin(), ObjFile.str().str());
+  return linkExecutable(ObjFiles, Out, OS);
+}
+
+/// Compiles \c InFile in memory and runs it.
+///
+/// \return Exit code of the program, or \c 1 if it could not be compiled.
+static int run(StringRef InFile) {
+  CompilerInstance Compiler(errs());
+  if (!setupCompiler(Compiler, InFile, OutFile, errs()))
+    return 1;
+  return Compiler.performRun();
+}
+
+/// Interprets \c InFile.
+///
+/// \return Exit code of the program, or \c 1 if it could not be interpreted.
+static int interpret(StringRef InFile) {
+  CompilerInstance Compiler(errs());
+  if (!setupCompiler(Compiler, InFile, OutFile, errs()))
+    return 1;
+  return Compiler.performInterpret();
+}
+
+/// Returns name of the executable for \c InFile in batch mode, which is
+/// the input file name without extension.
+static std::string getBatchOutputName(StringRef InFile) {
+  SmallString<128> Out(InFile);
+  sys::path::replace_extension(Out, "");
+  if (Out == InFile)
+    Out += ".out";
+  return Out.str().str();
+}
+
+/// Compiles all input files in parallel. Each program gets its own compiler
+/// instance, diagnostics of a file are buffered and reported at once after
+/// the file is compiled.
+static bool compileBatch() {
+  unsigned NumThreads = Jobs ? Jobs : llvm::hardware_concurrency();
+  ThreadPool Pool(NumThreads);
+  std::mutex OutputLock;
+  std::atomic<unsigned> NumFailed(0);
+
+  for (auto &InFile : InFiles) {
+    Pool.async([&, InFile] {
+      std::string Buffer;
+      raw_string_ostream OS(Buffer);
+      if (!compile(InFile, getBatchOutputName(InFile), OS)) {
+        OS << "duskc: error: compilation of '" << InFile << "' failed\n";
+        NumFailed++;
+      }
+      OS.flush();
+
+      std::lock_guard<std::mutex> Guard(OutputLock);
+      errs() << Buffer;
+    });
+  }
+  Pool.wait();
+
+  if (NumFailed)
+    errs() << "duskc: " << NumFailed << " of " << InFiles.size()
+           << " files failed to compile\n";
+  return NumFailed == 0;
+}
+
+/// Program compiled by the server before it accepts any request.
+static const char *WarmUpSource = R"(
+func fib(n: Int) -> Int {
+    var a = 0;
+    var b = 1;
+    for i in 0..n {
+        let t = a + b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+func main() {
+    var x: Int[4] = [1, 2, 3, 4];
+    println(fib(x[3]));
+}
+)";
+
+/// \brief Initializes the compiler in the server process.
+///
+/// Compiles a small program at every optimization level, so that targets are
+/// registered, target machines created and passes initialized once, before
+/// compilations are forked from the server.
+static void warmUp() {
+  int FD;
+  SmallString<128> Source, ObjFile;
+  if (sys::fs::createTemporaryFile("dusk-warmup", "dusk", FD, Source))
+    return;
+  auto RemoveSource = make_scope_exit([&] { sys::fs::remove(Source); });
+  {
+    raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    OS << WarmUpSource;
+  }
+  if (sys::fs::createTemporaryFile("dusk-warmup", "o", ObjFile))
     return;
-  C.reset(std::move(Inv));
+  auto RemoveObjFile = make_scope_exit([&] { sys::fs::remove(ObjFile); });
+
+  auto Level = OptimizationLevel.getValue();
+  for (auto L : {OptLevel::O0, OptLevel::O1, OptLevel::O2, OptLevel::O3,
+                 OptLevel::Os}) {
+    OptimizationLevel = L;
+    CompilerInstance Compiler(nulls());
+    if (setupCompiler(Compiler, Source, ObjFile, nulls(), ObjFile))
+      Compiler.performCompilation();
+  }
+  OptimizationLevel = Level;
 }
 
-int main(int argc, const char *argv[]) {
-  cl::ParseCommandLineOptions(argc, argv);
-  CompilerInstance Compiler;
-  initCompilerInstance(Compiler);
-  if (!Compiler.getInputFile()) {
-    std::cerr << "File '" + InFile + "' not found.";
+/// Performs compilation requested by already parsed command line options.
+///
+/// \return Exit code of the compiler.
+static int drive() {
+  if (InFiles.empty()) {
+    errs() << "duskc: error: no input files\n";
     return 1;
   }
-  Compiler.performCompilation();
-  
-  if (!OnlyCompile && !Compiler.getContext().isError()) {
-    auto Cmd = "clang++ "
-    + Compiler.getInputFile()->file() + ".o "
-    + "-L$DUSK_STDLIB_PATH -lstddusk -o" + OutFile;
-    system(Cmd.c_str());
-    return 0;
-  } else {
+
+  if (Run) {
+    if (InFiles.size() != 1) {
+      errs() << "duskc: error: --run requires a single input file\n";
+      return 1;
+    }
+    return run(InFiles.front());
+  }
+
+  if (Interpret) {
+    if (InFiles.size() != 1) {
+      errs() << "duskc: error: --interpret requires a single input file\n";
+      return 1;
+    }
+    return interpret(InFiles.front());
+  }
+
+  if (Incremental && CacheDir.empty()) {
+    errs() << "duskc: error: -incremental requires -cache-dir\n";
+    return 1;
+  }
+
+  if (EmitModule && !OnlyCompile) {
+    errs() << "duskc: error: -emit-module requires -c\n";
+    return 1;
+  }
+
+  if (InFiles.size() > 1 && OutFile.getNumOccurrences()) {
+    errs() << "duskc: error: cannot specify -o with multiple input files\n";
     return 1;
   }
+
+  bool IsSuccess;
+  if (InFiles.size() == 1)
+    IsSuccess = compile(InFiles.front(), OutFile, errs());
+  else
+    IsSuccess = compileBatch();
+
+  if (CacheStats) {
+    auto &Stats = CompilationCache::getStatistics();
+    errs() << "duskc: cache: " << Stats.Hits << " hits, " << Stats.Misses
+           << " misses, " << Stats.Stores << " stores\n";
+  }
+  return IsSuccess ? 0 : 1;
+}
+
+/// Writes the recorded time trace into the file requested on the command line.
+///
+/// \return \c true on success, \c false otherwise.
+static bool writeTimeTrace() {
+  auto Path = TimeTraceFile.empty() ? OutFile + ".json" : TimeTraceFile;
+  std::error_code EC;
+  raw_fd_ostream OS(Path, EC, sys::fs::F_None);
+  if (!EC) {
+    timeTraceWrite(OS);
+    OS.close();
+    EC = OS.error();
+  }
+  if (EC) {
+    errs() << "duskc: error: could not write time trace '" << Path
+           << "': " << EC.message() << "\n";
+    OS.clear_error();
+    return false;
+  }
+  return true;
+}
+
+/// Performs compilation requested by already parsed command line options and
+/// reports time spent in phases of the compiler, if requested.
+///
+/// \return Exit code of the compiler.
+static int driveAndReportTime() {
+  if (!TimeTrace && !TimeReport)
+    return drive();
+
+  timeTraceInitialize(TimeTraceGranularity);
+  auto Cleanup = make_scope_exit([] { timeTraceCleanup(); });
+  int Result;
+  {
+    TimeTraceScope Trace("duskc");
+    Result = drive();
+  }
+  if (TimeReport)
+    timeTracePrintReport(errs());
+  if (TimeTrace && !writeTimeTrace())
+    return 1;
+  return Result;
+}
+
+/// Compiles a request of a client inside the server.
+static int driveRequest(int argc, const char **argv) {
+  // Options of the server and of previous requests are forgotten.
+  cl::ResetAllOptionOccurrences();
+  if (!cl::ParseCommandLineOptions(argc, argv, "", &errs()))
+    return 1;
+  if (RunServer) {
+    errs() << "duskc: error: -server cannot be requested by a client\n";
+    return 1;
+  }
+  return driveAndReportTime();
+}
+
+int main(int argc, const char *argv[]) {
+  // Response files (@file) are expanded by the command line parser.
+  cl::ParseCommandLineOptions(argc, argv);
+
+  if (RunServer) {
+    auto Socket = ServerSocket.empty() ? server::getDefaultSocketPath()
+                                       : ServerSocket.getValue();
+    return runServer(Socket, warmUp, driveRequest);
+  }
+  return driveAndReportTime();
 }